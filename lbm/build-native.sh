@@ -0,0 +1,55 @@
+#!/bin/bash
+# Build script for the native (non-Emscripten) LBM tools
+# Requires a C++17 compiler (g++ or clang++)
+
+CXX=${CXX:-g++}
+
+echo "Building native LBM tools with $CXX..."
+echo ""
+
+for tool in lbm-bench lbm-verify lbm-validate lbm-server; do
+    $CXX $tool.cpp \
+      -o $tool \
+      -std=c++17 \
+      -O3 \
+      -pthread
+
+    if [ $? -ne 0 ]; then
+        echo ""
+        echo "Build failed!"
+        exit 1
+    fi
+done
+
+# Shared library with the C API (lbm-capi.h); solver internals stay hidden
+$CXX lbm-capi.cpp \
+  -o liblbm.so \
+  -std=c++17 \
+  -O3 \
+  -shared \
+  -fPIC \
+  -fvisibility=hidden \
+  -pthread
+
+if [ $? -ne 0 ]; then
+    echo ""
+    echo "Build failed!"
+    exit 1
+fi
+
+echo ""
+echo "Build successful!"
+echo "Generated files:"
+echo "  - lbm-bench"
+echo "  - lbm-verify"
+echo "  - lbm-validate"
+echo "  - lbm-server"
+echo "  - liblbm.so (C API, see lbm-capi.h)"
+echo ""
+echo "Run ./lbm-bench --help for options."
+echo "Run ./lbm-verify before enabling a new step() fast path."
+echo "Run ./lbm-validate to measure accuracy against reference flows."
+echo "Run ./lbm-server to stream a native simulation to the page (./lbm-server --selftest checks it)."
+echo "Energy figures need read access to /sys/class/powercap/intel-rapl:*/energy_uj"
+echo "(root, or: sudo chmod o+r /sys/class/powercap/intel-rapl:*/energy_uj)"
+echo ""
@@ -0,0 +1,39 @@
+#!/bin/bash
+# Build script for the Python module (pybind11)
+# Requires a C++17 compiler, Python 3 headers and pybind11 (pip install pybind11)
+
+CXX=${CXX:-g++}
+PYTHON=${PYTHON:-python3}
+
+INCLUDES=$($PYTHON -m pybind11 --includes)
+if [ $? -ne 0 ]; then
+    echo "pybind11 not found; install it with: $PYTHON -m pip install pybind11 numpy"
+    exit 1
+fi
+SUFFIX=$($PYTHON -c "import sysconfig; print(sysconfig.get_config_var('EXT_SUFFIX'))")
+
+echo "Building Python module with $CXX..."
+echo ""
+
+$CXX lbm-python.cpp \
+  -o lbm$SUFFIX \
+  -std=c++17 \
+  -O3 \
+  -shared \
+  -fPIC \
+  -pthread \
+  $INCLUDES
+
+if [ $? -ne 0 ]; then
+    echo ""
+    echo "Build failed!"
+    exit 1
+fi
+
+echo ""
+echo "Build successful!"
+echo "Generated files:"
+echo "  - lbm$SUFFIX"
+echo ""
+echo "Try: $PYTHON -c 'import lbm; s = lbm.LBMSolver(350, 175); s.step_n(100); print(s.ux.max())'"
+echo ""
@@ -1,41 +1,69 @@
 @echo off
 REM Build script for compiling LBM solver to WebAssembly
 REM Make sure Emscripten is installed and activated before running this
+REM
+REM Four variants are built; lbm-solver-wasm-wrapper.js loads the fastest one
+REM the browser supports that can hold the lattice:
+REM   lbm-solver-wasm.js          baseline (any WebAssembly browser)
+REM   lbm-solver-wasm-simd.js     WebAssembly SIMD kernels
+REM   lbm-solver-wasm-simd-mt.js  SIMD kernels + pthreads (needs a cross-origin
+REM                               isolated page: COOP/COEP headers)
+REM   lbm-solver-wasm-memory64.js SIMD kernels with 64-bit memory (up to 16 GB),
+REM                               only loaded for lattices the 256 MB builds
+REM                               cannot hold; needs a recent Emscripten
 
-echo Building LBM Solver WebAssembly module...
+set COMMON_FLAGS=-std=c++17 -O3 -s WASM=1 -s ALLOW_MEMORY_GROWTH=1 -s MODULARIZE=1 -s EXPORTED_RUNTIME_METHODS="[\"ccall\",\"cwrap\"]" --bind -s INITIAL_MEMORY=67108864 -s MAXIMUM_MEMORY=268435456
+
+echo Building LBM Solver WebAssembly modules...
 echo.
 
-emcc lbm-solver.cpp ^
-  -o lbm-solver-wasm.js ^
-  -std=c++17 ^
-  -O3 ^
-  -s WASM=1 ^
-  -s ALLOW_MEMORY_GROWTH=1 ^
-  -s MODULARIZE=1 ^
-  -s EXPORT_NAME="Module" ^
-  -s EXPORTED_RUNTIME_METHODS="[\"ccall\",\"cwrap\"]" ^
-  --bind ^
-  -s INITIAL_MEMORY=67108864 ^
-  -s MAXIMUM_MEMORY=268435456
-
-if %errorlevel% neq 0 (
-    echo.
-    echo Build failed! Make sure Emscripten is installed and activated.
-    echo Run: emsdk activate latest
-    echo Then: emsdk_env.bat
-    pause
-    exit /b %errorlevel%
-)
+echo Building lbm-solver-wasm.js...
+call emcc lbm-solver.cpp -o lbm-solver-wasm.js %COMMON_FLAGS% -s EXPORT_NAME="Module"
+if %errorlevel% neq 0 goto failed
+
+echo Building lbm-solver-wasm-simd.js...
+call emcc lbm-solver.cpp -o lbm-solver-wasm-simd.js %COMMON_FLAGS% -s EXPORT_NAME="LBMModuleSIMD" -msimd128
+if %errorlevel% neq 0 goto failed
+
+echo Building lbm-solver-wasm-simd-mt.js...
+call emcc lbm-solver.cpp -o lbm-solver-wasm-simd-mt.js %COMMON_FLAGS% -s EXPORT_NAME="LBMModuleSIMDThreads" -msimd128 -pthread -s PTHREAD_POOL_SIZE=navigator.hardwareConcurrency
+if %errorlevel% neq 0 goto failed
+
+REM Optional: older Emscripten releases cannot target memory64
+echo Building lbm-solver-wasm-memory64.js...
+call emcc lbm-solver.cpp -o lbm-solver-wasm-memory64.js %COMMON_FLAGS% -s EXPORT_NAME="LBMModuleMemory64" -msimd128 -s MEMORY64=1 -s MAXIMUM_MEMORY=17179869184
+if %errorlevel% neq 0 echo Warning: memory64 variant not built (this Emscripten cannot target it)
+
+REM Content hashes of the modules: the wrapper fetches each .wasm at a URL
+REM versioned by its hash and caches the compiled module under it
+echo Writing lbm-wasm-manifest.json...
+powershell -NoProfile -Command "$m = [ordered]@{}; Get-ChildItem lbm-solver-wasm*.wasm | ForEach-Object { $m[$_.Name] = (Get-FileHash $_.FullName -Algorithm SHA256).Hash.ToLower() }; $m | ConvertTo-Json | Set-Content lbm-wasm-manifest.json"
+if %errorlevel% neq 0 goto failed
 
 echo.
 echo Build successful!
 echo Generated files:
-echo   - lbm-solver-wasm.js
-echo   - lbm-solver-wasm.wasm
+echo   - lbm-solver-wasm.js, lbm-solver-wasm.wasm
+echo   - lbm-solver-wasm-simd.js, lbm-solver-wasm-simd.wasm
+echo   - lbm-solver-wasm-simd-mt.js, lbm-solver-wasm-simd-mt.wasm (+ worker files)
+echo   - lbm-solver-wasm-memory64.js, lbm-solver-wasm-memory64.wasm (if supported)
+echo   - lbm-wasm-manifest.json (module hashes; deploy it with the modules)
 echo.
 echo To use the WASM version:
-echo 1. Edit index.html and uncomment the WASM script lines
-echo 2. Comment out the JavaScript fallback line
+echo 1. Edit index.html and uncomment the WASM wrapper script line
+echo 2. Keep the JavaScript solver loaded as the fallback
 echo 3. Serve the files with a local web server (not file://)
+echo 4. For the threaded variant, serve with these headers:
+echo      Cross-Origin-Opener-Policy: same-origin
+echo      Cross-Origin-Embedder-Policy: require-corp
+echo.
+pause
+exit /b 0
+
+:failed
 echo.
+echo Build failed! Make sure Emscripten is installed and activated.
+echo Run: emsdk activate latest
+echo Then: emsdk_env.bat
 pause
+exit /b 1
@@ -1,38 +1,102 @@
 #!/bin/bash
 # Build script for compiling LBM solver to WebAssembly
 # Make sure Emscripten is installed and activated before running this
+#
+# Four variants are built; lbm-solver-wasm-wrapper.js loads the fastest one
+# the browser supports that can hold the lattice:
+#   lbm-solver-wasm.js          baseline (any WebAssembly browser)
+#   lbm-solver-wasm-simd.js     WebAssembly SIMD kernels
+#   lbm-solver-wasm-simd-mt.js  SIMD kernels + pthreads (needs a cross-origin
+#                               isolated page: COOP/COEP headers)
+#   lbm-solver-wasm-memory64.js SIMD kernels with 64-bit memory (up to 16 GB),
+#                               only loaded for lattices the 256 MB builds
+#                               cannot hold; needs a recent Emscripten and a
+#                               runtime with memory64 (Chrome 133+, Firefox 134+,
+#                               node --experimental-wasm-memory64)
 
-echo "Building LBM Solver WebAssembly module..."
+COMMON_FLAGS=(
+  -std=c++17
+  -O3
+  -s WASM=1
+  -s ALLOW_MEMORY_GROWTH=1
+  -s MODULARIZE=1
+  -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap"]'
+  --bind
+  -s INITIAL_MEMORY=67108864
+  -s MAXIMUM_MEMORY=268435456
+)
+
+build_variant() {
+    local output=$1
+    local exportName=$2
+    shift 2
+
+    echo "Building $output..."
+    emcc lbm-solver.cpp \
+      -o "$output" \
+      "${COMMON_FLAGS[@]}" \
+      -s EXPORT_NAME="$exportName" \
+      "$@"
+
+    if [ $? -ne 0 ]; then
+        echo ""
+        echo "Build failed! Make sure Emscripten is installed and activated."
+        echo "Run: source /path/to/emsdk/emsdk_env.sh"
+        exit 1
+    fi
+}
+
+echo "Building LBM Solver WebAssembly modules..."
 echo ""
 
-emcc lbm-solver.cpp \
-  -o lbm-solver-wasm.js \
-  -std=c++17 \
-  -O3 \
-  -s WASM=1 \
-  -s ALLOW_MEMORY_GROWTH=1 \
-  -s MODULARIZE=1 \
-  -s EXPORT_NAME="Module" \
-  -s EXPORTED_RUNTIME_METHODS='["ccall","cwrap"]' \
-  --bind \
-  -s INITIAL_MEMORY=67108864 \
-  -s MAXIMUM_MEMORY=268435456
+build_variant lbm-solver-wasm.js "Module"
+build_variant lbm-solver-wasm-simd.js "LBMModuleSIMD" -msimd128
+build_variant lbm-solver-wasm-simd-mt.js "LBMModuleSIMDThreads" -msimd128 \
+  -pthread -s PTHREAD_POOL_SIZE=navigator.hardwareConcurrency
 
+# Optional: older Emscripten releases cannot target memory64
+echo "Building lbm-solver-wasm-memory64.js..."
+emcc lbm-solver.cpp \
+  -o lbm-solver-wasm-memory64.js \
+  "${COMMON_FLAGS[@]}" \
+  -s EXPORT_NAME="LBMModuleMemory64" \
+  -msimd128 \
+  -s MEMORY64=1 \
+  -s MAXIMUM_MEMORY=17179869184
 if [ $? -ne 0 ]; then
-    echo ""
-    echo "Build failed! Make sure Emscripten is installed and activated."
-    echo "Run: source /path/to/emsdk/emsdk_env.sh"
-    exit 1
+    echo "Warning: memory64 variant not built (this Emscripten cannot target it);"
+    echo "lattices over the 256 MB limit will not load in the browser."
 fi
 
+# Content hashes of the modules: the wrapper fetches each .wasm at a URL
+# versioned by its hash and caches the compiled module under it
+echo "Writing lbm-wasm-manifest.json..."
+{
+  echo "{"
+  separator=""
+  for wasm in lbm-solver-wasm*.wasm; do
+    hash=$( (sha256sum "$wasm" 2>/dev/null || shasum -a 256 "$wasm") | cut -d' ' -f1)
+    printf '%s  "%s": "%s"' "$separator" "$wasm" "$hash"
+    separator=$',\n'
+  done
+  echo ""
+  echo "}"
+} > lbm-wasm-manifest.json
+
 echo ""
 echo "Build successful!"
 echo "Generated files:"
-echo "  - lbm-solver-wasm.js"
-echo "  - lbm-solver-wasm.wasm"
+echo "  - lbm-solver-wasm.js, lbm-solver-wasm.wasm"
+echo "  - lbm-solver-wasm-simd.js, lbm-solver-wasm-simd.wasm"
+echo "  - lbm-solver-wasm-simd-mt.js, lbm-solver-wasm-simd-mt.wasm (+ worker files)"
+echo "  - lbm-solver-wasm-memory64.js, lbm-solver-wasm-memory64.wasm (if supported)"
+echo "  - lbm-wasm-manifest.json (module hashes; deploy it with the modules)"
 echo ""
 echo "To use the WASM version:"
-echo "1. Edit index.html and uncomment the WASM script lines"
-echo "2. Comment out the JavaScript fallback line"
+echo "1. Edit index.html and uncomment the WASM wrapper script line"
+echo "2. Keep the JavaScript solver loaded as the fallback"
 echo "3. Serve the files with a local web server (not file://)"
+echo "4. For the threaded variant, serve with these headers:"
+echo "     Cross-Origin-Opener-Policy: same-origin"
+echo "     Cross-Origin-Embedder-Policy: require-corp"
 echo ""
@@ -0,0 +1,292 @@
+// Cache-line aligned, zero-initialised array used for the lattice planes
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#define LBM_ARENA_MMAP 1
+#include <sys/mman.h>
+#include <cstdio>
+#endif
+
+// Backing of large lattice blocks (native Linux only)
+enum class HugePages {
+    Off = 0,
+    Transparent = 1,  // madvise(MADV_HUGEPAGE): the kernel uses 2 MB pages where it can
+    Explicit = 2      // MAP_HUGETLB from the reserved pool (vm.nr_hugepages), else Transparent
+};
+
+// Process-wide allocator behind every AlignedBuffer, shared by all solvers in
+// the module. It counts lattice bytes, can cap them (allocation throws
+// std::bad_alloc before the heap grows past the cap) and can keep freed
+// blocks for reuse, so creating and destroying simulations of the same size
+// does not keep growing a WASM heap. Both limits are 0 (off) by default.
+//
+// On native Linux, blocks of mapThreshold bytes or more are mapped directly.
+// Their pages stay untouched until first written, so LBMSolver's parallel
+// initialisation places each page on the NUMA node of the thread that steps
+// it, and they can be backed by huge pages (setHugePages).
+class LatticeArena {
+public:
+    struct Stats {
+        size_t bytesInUse;
+        size_t peakBytes;
+        size_t cachedBytes;    // freed blocks held for reuse
+        size_t limit;
+        size_t hugePageBytes;  // mapped blocks backed (or advised) as huge pages
+    };
+
+    static constexpr size_t alignment = 64;
+    static constexpr size_t mapThreshold = 1 << 20;
+
+    // Never destroyed, so buffers in static objects can still release
+    static LatticeArena& instance() {
+        static LatticeArena* arena = new LatticeArena();
+        return *arena;
+    }
+
+    // *zeroed is set when the block comes fresh from the kernel (all zero,
+    // no page touched yet)
+    void* allocate(size_t bytes, bool* zeroed = nullptr) {
+        if (zeroed) *zeroed = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (size_t b = 0; b < cache.size(); b++) {
+                if (cache[b].bytes == bytes) {
+                    void* p = cache[b].ptr;
+                    cache.erase(cache.begin() + b);
+                    cachedBytes -= bytes;
+                    reserve(bytes);
+                    return p;
+                }
+            }
+            if (limit && inUse + bytes > limit) throw std::bad_alloc();
+            reserve(bytes);
+        }
+        void* p = nullptr;
+#ifdef LBM_ARENA_MMAP
+        if (bytes >= mapThreshold) {
+            p = map(bytes);
+            if (!p) {
+                std::lock_guard<std::mutex> lock(mutex);
+                inUse -= bytes;
+                throw std::bad_alloc();
+            }
+            if (zeroed) *zeroed = true;
+            return p;
+        }
+#endif
+        if (posix_memalign(&p, alignment, bytes) != 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            inUse -= bytes;
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    void release(void* p, size_t bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            inUse -= bytes;
+            if (cachedBytes + bytes <= cacheLimit) {
+                cache.push_back({p, bytes});
+                cachedBytes += bytes;
+                return;
+            }
+        }
+        freeBlock(p);
+    }
+
+    // Cap on bytes in use (0 = none); blocks already allocated are kept
+    void setLimit(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        limit = bytes;
+    }
+
+    // Freed bytes kept for reuse (0 = free immediately)
+    void setCacheLimit(size_t bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        cacheLimit = bytes;
+        while (cachedBytes > cacheLimit) {
+            cachedBytes -= cache.back().bytes;
+            freeBlockLocked(cache.back().ptr);
+            cache.pop_back();
+        }
+    }
+
+    // Applies to blocks mapped from now on
+    void setHugePages(HugePages mode) {
+        std::lock_guard<std::mutex> lock(mutex);
+        hugePages = mode;
+    }
+
+    Stats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return {inUse, peak, cachedBytes, limit, hugeBytes};
+    }
+
+private:
+    struct Block {
+        void* ptr;
+        size_t bytes;
+    };
+
+    struct Mapping {
+        void* ptr;
+        size_t length;
+        bool huge;
+    };
+
+    std::mutex mutex;
+    std::vector<Block> cache;
+    std::vector<Mapping> mappings;
+    HugePages hugePages = HugePages::Off;
+    size_t hugeBytes = 0;
+    size_t inUse = 0;
+    size_t peak = 0;
+    size_t cachedBytes = 0;
+    size_t limit = 0;
+    size_t cacheLimit = 0;
+
+    LatticeArena() = default;
+
+    void reserve(size_t bytes) {
+        inUse += bytes;
+        if (inUse > peak) peak = inUse;
+    }
+
+    void freeBlock(void* p) {
+        std::lock_guard<std::mutex> lock(mutex);
+        freeBlockLocked(p);
+    }
+
+    void freeBlockLocked(void* p) {
+#ifdef LBM_ARENA_MMAP
+        for (size_t m = 0; m < mappings.size(); m++) {
+            if (mappings[m].ptr == p) {
+                if (mappings[m].huge) hugeBytes -= mappings[m].length;
+                munmap(p, mappings[m].length);
+                mappings.erase(mappings.begin() + m);
+                return;
+            }
+        }
+#endif
+        free(p);
+    }
+
+#ifdef LBM_ARENA_MMAP
+    // Default huge page size from /proc/meminfo (2 MB on x86-64)
+    static size_t hugePageSize() {
+        static const size_t size = [] {
+            size_t kb = 2048;
+            if (FILE* f = fopen("/proc/meminfo", "r")) {
+                char line[128];
+                while (fgets(line, sizeof(line), f)) {
+                    if (sscanf(line, "Hugepagesize: %zu kB", &kb) == 1) break;
+                }
+                fclose(f);
+            }
+            return kb * 1024;
+        }();
+        return size;
+    }
+
+    // Anonymous mapping for a large block; nullptr if the kernel refuses
+    void* map(size_t bytes) {
+        HugePages mode;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            mode = hugePages;
+        }
+
+        void* p = MAP_FAILED;
+        size_t length = bytes;
+        bool huge = false;
+        if (mode == HugePages::Explicit) {
+            size_t page = hugePageSize();
+            length = (bytes + page - 1) / page * page;
+            p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            huge = p != MAP_FAILED;
+        }
+        if (p == MAP_FAILED) {
+            // No reserved huge pages left: fall back to transparent ones
+            length = bytes;
+            p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (p == MAP_FAILED) return nullptr;
+            if (mode != HugePages::Off) huge = madvise(p, length, MADV_HUGEPAGE) == 0;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        mappings.push_back({p, length, huge});
+        if (huge) hugeBytes += length;
+        return p;
+    }
+#endif
+};
+
+template <typename T>
+class AlignedBuffer {
+private:
+    T* ptr;
+    size_t count;
+
+public:
+    static constexpr size_t alignment = 64;
+
+    AlignedBuffer() : ptr(nullptr), count(0) {}
+
+    explicit AlignedBuffer(size_t n) : ptr(nullptr), count(n) {
+        if (n == 0) return;
+        // size_t is 32-bit in wasm32 builds, where large lattices would wrap
+        if (n > (SIZE_MAX - alignment) / sizeof(T)) throw std::bad_alloc();
+        bool zeroed;
+        void* p = LatticeArena::instance().allocate(bytes(), &zeroed);
+        // Fresh mappings are zero already; writing them here would place
+        // every page on this thread's NUMA node
+        if (!zeroed) std::memset(p, 0, bytes());
+        ptr = static_cast<T*>(p);
+    }
+
+    ~AlignedBuffer() {
+        if (ptr) LatticeArena::instance().release(ptr, bytes());
+    }
+
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept : ptr(other.ptr), count(other.count) {
+        other.ptr = nullptr;
+        other.count = 0;
+    }
+
+    AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+        std::swap(ptr, other.ptr);
+        std::swap(count, other.count);
+        return *this;
+    }
+
+    // Allocated size, whole cache lines
+    size_t bytes() const { return (count * sizeof(T) + alignment - 1) / alignment * alignment; }
+
+    // What a buffer of n elements takes from the arena; 64-bit so wasm32
+    // builds can size lattices they could not address
+    static uint64_t bytesFor(uint64_t n) { return (n * sizeof(T) + alignment - 1) / alignment * alignment; }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+
+    T& operator[](size_t i) { return ptr[i]; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+
+    void fill(const T& value) {
+        for (size_t i = 0; i < count; i++) ptr[i] = value;
+    }
+};
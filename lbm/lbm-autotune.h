@@ -0,0 +1,225 @@
+// Start-up auto-tuner for LBMSolver::step()
+// Micro-benchmarks SIMD level, thread count, tile width, traversal order,
+// kernel variant and non-temporal stores
+// on a scratch solver of the same size, applies the fastest configuration and
+// remembers it in a cache file keyed by CPU model and lattice size.
+#pragma once
+
+#include "lbm-solver.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+
+struct TuningResult {
+    StepConfig config;
+    double mlups = 0.0;
+    bool fromCache = false;
+    int candidatesTried = 0;
+};
+
+class AutoTuner {
+private:
+    std::string cachePath;
+
+    struct CacheEntry {
+        std::string cpu;
+        int width, height;
+        StepConfig config;
+        double mlups;
+    };
+
+    static double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    std::vector<CacheEntry> loadCache() const {
+        std::vector<CacheEntry> entries;
+        std::ifstream in(cachePath);
+        std::string line;
+        while (std::getline(in, line)) {
+            // cpu <TAB> width <TAB> height <TAB> threads <TAB> tile <TAB> traversal <TAB> kernel
+            //     <TAB> simd <TAB> non-temporal <TAB> mlups
+            std::istringstream fields(line);
+            CacheEntry e;
+            if (!std::getline(fields, e.cpu, '\t')) continue;
+            int traversal, kernel, simd, nonTemporal;
+            if (!(fields >> e.width >> e.height >> e.config.threads >> e.config.tileWidth
+                         >> traversal >> kernel >> simd >> nonTemporal >> e.mlups)) continue;
+            e.config.traversal = static_cast<Traversal>(traversal);
+            e.config.kernel = static_cast<KernelVariant>(kernel);
+            e.config.simd = static_cast<SimdLevel>(simd);
+            e.config.nonTemporal = nonTemporal != 0;
+            entries.push_back(e);
+        }
+        return entries;
+    }
+
+    void saveCache(const std::vector<CacheEntry>& entries) const {
+        // Create missing parent directories
+        for (size_t slash = cachePath.find('/', 1); slash != std::string::npos;
+             slash = cachePath.find('/', slash + 1)) {
+            mkdir(cachePath.substr(0, slash).c_str(), 0755);
+        }
+        std::ofstream out(cachePath, std::ios::trunc);
+        for (const CacheEntry& e : entries) {
+            out << e.cpu << '\t' << e.width << '\t' << e.height << '\t'
+                << e.config.threads << '\t' << e.config.tileWidth << '\t'
+                << static_cast<int>(e.config.traversal) << '\t'
+                << static_cast<int>(e.config.kernel) << '\t'
+                << static_cast<int>(e.config.simd) << '\t' << (e.config.nonTemporal ? 1 : 0) << '\t'
+                << e.mlups << '\n';
+        }
+    }
+
+    // Seconds per step of a configuration, measured for at least minSeconds
+    static double measure(LBMSolver& scratch, const StepConfig& c, double minSeconds) {
+        scratch.setStepConfig(c);
+        scratch.step();  // warm caches and wake the pool
+
+        int steps = 0;
+        double start = now();
+        double elapsed = 0.0;
+        do {
+            scratch.step();
+            steps++;
+            elapsed = now() - start;
+        } while (elapsed < minSeconds);
+        return elapsed / steps;
+    }
+
+public:
+    explicit AutoTuner(const std::string& path = defaultCachePath()) : cachePath(path) {}
+
+    static std::string defaultCachePath() {
+        const char* xdg = getenv("XDG_CACHE_HOME");
+        if (xdg && *xdg) return std::string(xdg) + "/lbm-solver/tuning.tsv";
+        const char* home = getenv("HOME");
+        if (home && *home) return std::string(home) + "/.cache/lbm-solver/tuning.tsv";
+        return "lbm-tuning.tsv";
+    }
+
+    // CPU model plus hardware thread count, e.g. "AMD EPYC 7763 64-Core Processor x128"
+    static std::string cpuModel() {
+        std::string model = "unknown";
+        std::ifstream in("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(in, line)) {
+            if (line.rfind("model name", 0) == 0) {
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) model = line.substr(colon + 2);
+                break;
+            }
+        }
+        for (char& ch : model) {
+            if (ch == '\t') ch = ' ';
+        }
+        return model + " x" + std::to_string(LBMSolver::getHardwareThreads());
+    }
+
+    // Return the tuned configuration for the solver's lattice size and apply it.
+    // Uses the cache when an entry exists unless force is set; otherwise tunes
+    // for at most budgetSeconds and stores the winner.
+    TuningResult tune(LBMSolver& solver, double budgetSeconds = 2.0, bool force = false) {
+        TuningResult result;
+        std::string cpu = cpuModel();
+        int width = solver.getWidth();
+        int height = solver.getHeight();
+
+        std::vector<CacheEntry> entries = loadCache();
+        if (!force) {
+            for (const CacheEntry& e : entries) {
+                if (e.cpu == cpu && e.width == width && e.height == height) {
+                    result.config = e.config;
+                    result.mlups = e.mlups;
+                    result.fromCache = true;
+                    solver.setStepConfig(result.config);
+                    return result;
+                }
+            }
+        }
+
+        LBMSolver scratch(width, height);
+        scratch.setGeometry(solver.getGeometry());
+
+        double deadline = now() + budgetSeconds;
+        double sliceSeconds = budgetSeconds / 40.0;
+
+        StepConfig best;
+        best.threads = LBMSolver::getHardwareThreads();
+        best.simd = LBMSolver::getBestSimdLevel();
+        double bestTime = measure(scratch, best, sliceSeconds);
+        result.candidatesTried = 1;
+
+        auto tryCandidate = [&](const StepConfig& c) {
+            if (now() > deadline) return;
+            double t = measure(scratch, c, sliceSeconds);
+            result.candidatesTried++;
+            if (t < bestTime) {
+                bestTime = t;
+                best = c;
+            }
+        };
+
+        // Coordinate descent, most influential knob first: SIMD level
+        // (kernel/traversal for the scalar path), tile width, thread count,
+        // then non-temporal stores
+        StepConfig base = best;
+        for (int level = static_cast<int>(SimdLevel::SIMD128); level >= 0; level--) {
+            StepConfig c = base;
+            c.simd = static_cast<SimdLevel>(level);
+            if (c.simd != base.simd && lbm_kernels::simdSupported(c.simd)) tryCandidate(c);
+        }
+
+        if (best.simd == SimdLevel::Scalar) {
+            for (int kernel = 0; kernel < 2; kernel++) {
+                for (int traversal = 0; traversal < 2; traversal++) {
+                    StepConfig c = best;
+                    c.kernel = static_cast<KernelVariant>(kernel);
+                    c.traversal = static_cast<Traversal>(traversal);
+                    if (c.kernel != best.kernel || c.traversal != best.traversal) tryCandidate(c);
+                }
+            }
+        }
+
+        base = best;
+        for (int tile : {8, 16, 32, 64, 128}) {
+            if (tile >= width) break;
+            StepConfig c = base;
+            c.tileWidth = tile;
+            tryCandidate(c);
+        }
+
+        base = best;
+        for (int threads = 1; threads < LBMSolver::getHardwareThreads(); threads *= 2) {
+            StepConfig c = base;
+            c.threads = threads;
+            tryCandidate(c);
+        }
+
+        if (best.simd != SimdLevel::Scalar) {
+            StepConfig c = best;
+            c.nonTemporal = true;
+            tryCandidate(c);
+        }
+
+        result.config = best;
+        result.mlups = static_cast<double>(width) * height * 1e-6 / bestTime;
+        solver.setStepConfig(best);
+
+        // Replace any previous entry for this machine and size
+        std::vector<CacheEntry> kept;
+        for (const CacheEntry& e : entries) {
+            if (!(e.cpu == cpu && e.width == width && e.height == height)) kept.push_back(e);
+        }
+        kept.push_back({cpu, width, height, best, result.mlups});
+        saveCache(kept);
+
+        return result;
+    }
+};
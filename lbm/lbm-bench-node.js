@@ -0,0 +1,214 @@
+#!/usr/bin/env node
+// Headless benchmark for the WebAssembly LBM solver
+// Loads an Emscripten build in Node.js, times step() and every field export
+// at several lattice sizes and optionally writes the results as JSON, in the
+// same shape as lbm-bench's --json output so WASM and native runs can be
+// compared (and regressions caught) without a browser.
+//
+// Usage: node lbm-bench-node.js [--module lbm-solver-wasm.js,lbm-solver-wasm-simd.js]
+//                               [--sizes 350x175,700x350] [--threads 1,2,4]
+//                               [--simd auto|scalar|simd128] [--steps 500] [--warmup 100]
+//                               [--export-reps 20] [--json results.json]
+//                               [--baseline previous.json] [--max-regression 10]
+//
+// The memory64 build needs a Node.js with 64-bit memories
+// (node --experimental-wasm-memory64 on Node.js 20-23):
+//   node --experimental-wasm-memory64 lbm-bench-node.js \
+//     --module lbm-solver-wasm-memory64.js --sizes 8192x4096 --steps 20 --warmup 2 --export-reps 0
+
+const fs = require('fs');
+const path = require('path');
+const { performance } = require('perf_hooks');
+
+// Field exports timed after stepping; ones missing from older builds are skipped
+const EXPORTS = ['getVelocityMagnitude', 'getVorticity', 'getPressure', 'getUx', 'getUy',
+  'getObstacle', 'getGeometry'];
+
+const SIMD_LEVELS = { auto: -1, scalar: 0, 'sse4.2': 1, avx2: 2, avx512: 3, simd128: 4 };
+
+function usage() {
+  console.error('Usage: node lbm-bench-node.js [--module FILE,...] [--sizes WxH,...] [--threads N,...]\n' +
+    '       [--simd auto|scalar|simd128] [--steps N] [--warmup N] [--export-reps N]\n' +
+    '       [--json FILE] [--baseline FILE] [--max-regression PERCENT]');
+  process.exit(1);
+}
+
+function parseArgs(argv) {
+  const options = {
+    modules: ['lbm-solver-wasm.js'],
+    sizes: '350x175,700x350,1400x700',
+    threads: [1],
+    simd: 'auto',
+    steps: 500,
+    warmup: 100,
+    exportReps: 20,
+    json: null,
+    baseline: null,
+    maxRegression: null
+  };
+
+  for (let a = 2; a < argv.length; a++) {
+    const arg = argv[a];
+    const value = argv[a + 1];
+    if (value === undefined) usage();
+    if (arg === '--module') options.modules = value.split(',');
+    else if (arg === '--sizes') options.sizes = value;
+    else if (arg === '--threads') options.threads = value.split(',').map(Number);
+    else if (arg === '--simd' && value in SIMD_LEVELS) options.simd = value;
+    else if (arg === '--steps') options.steps = parseInt(value, 10);
+    else if (arg === '--warmup') options.warmup = parseInt(value, 10);
+    else if (arg === '--export-reps') options.exportReps = parseInt(value, 10);
+    else if (arg === '--json') options.json = value;
+    else if (arg === '--baseline') options.baseline = value;
+    else if (arg === '--max-regression') options.maxRegression = parseFloat(value);
+    else usage();
+    a++;
+  }
+
+  options.sizes = options.sizes.split(',').map((s) => {
+    const [width, height] = s.split('x').map(Number);
+    if (!(width > 0 && height > 0)) usage();
+    return { width, height };
+  });
+  return options;
+}
+
+// Instantiate a MODULARIZE=1 build; the factory is module.exports under Node
+async function loadModule(file) {
+  const resolved = path.resolve(__dirname, file);
+  const factory = require(resolved);
+  return factory({ locateFile: (p) => path.join(path.dirname(resolved), p) });
+}
+
+// Apply threads/SIMD when the build has setStepConfig(), otherwise report the
+// fixed single-threaded scalar path of older builds
+function configure(M, solver, threads, simd) {
+  if (typeof solver.setStepConfig !== 'function') {
+    return { threads: 1, simd: 'scalar', configurable: false };
+  }
+  solver.setStepConfig({
+    threads,
+    tileWidth: 0,
+    traversal: M.Traversal.values[0],
+    kernel: M.KernelVariant.values[0],
+    simd: M.SimdLevel.values[SIMD_LEVELS[simd]],
+    nonTemporal: false,
+    pinning: M.ThreadPinning && M.ThreadPinning.Off
+  });
+  const applied = solver.getStepConfig();
+  const level = Object.keys(SIMD_LEVELS).find((name) => SIMD_LEVELS[name] === applied.simd.value);
+  return { threads: applied.threads, simd: level, configurable: true };
+}
+
+function runConfig(M, file, size, threads, options) {
+  const solver = new M.LBMSolver(size.width, size.height);
+  const applied = configure(M, solver, threads, options.simd);
+
+  for (let s = 0; s < options.warmup; s++) solver.step();
+
+  const start = performance.now();
+  for (let s = 0; s < options.steps; s++) solver.step();
+  const seconds = (performance.now() - start) / 1000;
+
+  // Milliseconds per call; these copy the lattice into JS arrays every frame
+  // (--export-reps 0 skips them, e.g. for multi-GB memory64 lattices)
+  const exports = {};
+  for (const name of options.exportReps > 0 ? EXPORTS : []) {
+    if (typeof solver[name] !== 'function') continue;
+    solver[name]();
+    const exportStart = performance.now();
+    for (let r = 0; r < options.exportReps; r++) solver[name]();
+    exports[name] = (performance.now() - exportStart) / options.exportReps;
+  }
+
+  solver.delete();
+
+  const mlu = size.width * size.height * options.steps * 1e-6;
+  return {
+    module: path.basename(file),
+    width: size.width,
+    height: size.height,
+    threads: applied.threads,
+    simd: applied.simd,
+    steps: options.steps,
+    seconds,
+    mlups: mlu / seconds,
+    export_ms: exports
+  };
+}
+
+// Compare against an earlier run of this script or of lbm-bench --json,
+// matching on lattice size and thread count. Returns false if any result
+// fell more than maxRegression percent below the baseline.
+function compareBaseline(results, baselinePath, maxRegression) {
+  const baseline = JSON.parse(fs.readFileSync(baselinePath, 'utf8')).results || [];
+  let ok = true;
+
+  console.log('\nCompared with ' + baselinePath + ':');
+  for (const r of results) {
+    const match = baseline.find((b) => b.width === r.width && b.height === r.height &&
+      (b.threads === undefined || b.threads === r.threads));
+    if (!match) continue;
+    const change = (r.mlups / match.mlups - 1) * 100;
+    const regressed = maxRegression !== null && change < -maxRegression;
+    if (regressed) ok = false;
+    console.log('  ' + r.module + ' ' + r.width + 'x' + r.height + ' threads=' + r.threads + ': ' +
+      r.mlups.toFixed(2) + ' vs ' + match.mlups.toFixed(2) + ' MLUPS (' +
+      (change >= 0 ? '+' : '') + change.toFixed(1) + '%)' + (regressed ? '  REGRESSION' : ''));
+  }
+  return ok;
+}
+
+async function main() {
+  const options = parseArgs(process.argv);
+  const results = [];
+
+  console.log('Node ' + process.version + ', ' + require('os').cpus()[0].model);
+
+  for (const file of options.modules) {
+    let M;
+    try {
+      M = await loadModule(file);
+    } catch (e) {
+      console.error('Cannot load ' + file + ': ' + e.message);
+      process.exitCode = 1;
+      continue;
+    }
+
+    console.log('\n' + file);
+    console.log('lattice      threads simd       steps   time (s)      MLUPS   exports (ms/call)');
+
+    // Builds without setStepConfig() cannot change the thread count
+    const threadCounts = typeof M.LBMSolver.prototype.setStepConfig === 'function'
+      ? options.threads : [1];
+
+    for (const size of options.sizes) {
+      for (const threads of threadCounts) {
+        const r = runConfig(M, file, size, threads, options);
+        results.push(r);
+        const exportSummary = Object.entries(r.export_ms)
+          .map(([name, ms]) => name.replace(/^get/, '') + '=' + ms.toFixed(2)).join(' ');
+        console.log((r.width + 'x' + r.height).padEnd(12) + ' ' + String(r.threads).padStart(7) + ' ' +
+          r.simd.padEnd(8) + ' ' + String(r.steps).padStart(7) + ' ' + r.seconds.toFixed(3).padStart(10) + ' ' +
+          r.mlups.toFixed(2).padStart(10) + '   ' + exportSummary);
+      }
+    }
+  }
+
+  if (options.json) {
+    const out = { node: process.version, results };
+    fs.writeFileSync(options.json, JSON.stringify(out, null, 2) + '\n');
+  }
+
+  if (options.baseline && !compareBaseline(results, options.baseline, options.maxRegression)) {
+    process.exitCode = 1;
+  }
+
+  // Pthread builds keep their worker pool alive
+  process.exit(process.exitCode || 0);
+}
+
+// lbm-replay-node.js loads modules the same way
+module.exports = { loadModule };
+
+if (require.main === module) main();
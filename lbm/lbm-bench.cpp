@@ -0,0 +1,580 @@
+// Native benchmark for LBMSolver::step()
+// Reports throughput (MLUPS) and, where the RAPL counters are readable,
+// package energy per million lattice updates for each configuration.
+//
+// Build: ./build-native.sh
+// Usage: ./lbm-bench [--sizes 350x175,700x350] [--threads 1,2,4] [--tile 32]
+//                    [--kernel twopass|fused] [--traversal columns|rows]
+//                    [--simd auto|scalar|sse4.2|avx2|avx512] [--nt] [--watchdog] [--strain]
+//                    [--activity THRESHOLD] [--pin off|compact|spread] [--huge-pages off|thp|explicit]
+//                    [--autotune SECONDS] [--steps 500] [--warmup 100]
+//                    [--idle 1.0] [--json results.json]
+//        ./lbm-bench --stability [--sizes 200x100,400x200] [--steps 4000]
+//        ./lbm-bench --out-of-core DIR [--slab 256] [--temporal 8] [--sizes 20000x10000]
+//        ./lbm-bench --compressed 12,16,24 [--sizes 700x350] [--steps 2000]
+//        ./lbm-bench --fixed 16,32 [--sizes 700x350] [--threads 1,4] [--steps 2000]
+
+#include "lbm-solver.h"
+#include "lbm-autotune.h"
+#include "lbm-compressed.h"
+#include "lbm-energy.h"
+#include "lbm-fixed.h"
+#include "lbm-outofcore.h"
+#include "lbm-planner.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BenchConfig {
+    int width;
+    int height;
+    StepConfig step;
+    bool watchdog = false;  // per-step health checks and checkpoints
+    bool strain = false;    // strain-rate output from the collision pass
+    double activity = 0.0;  // activity-tracking threshold, 0 = every block stepped
+};
+
+struct BenchResult {
+    BenchConfig config;
+    int steps;
+    double seconds;
+    double mlups;
+    double joules;       // < 0 when RAPL is not accessible
+    double joulesPerMLU;
+    double watts;
+    double skippedFraction;  // column updates activity tracking skipped while timed
+};
+
+static std::vector<int> parseInts(const char* arg) {
+    std::vector<int> values;
+    std::string list = arg;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        int v = atoi(list.substr(pos, comma - pos).c_str());
+        if (v > 0) values.push_back(v);
+        pos = comma + 1;
+    }
+    return values;
+}
+
+static SimdLevel parseSimd(const char* name) {
+    for (int level = static_cast<int>(SimdLevel::Auto); level <= static_cast<int>(SimdLevel::SIMD128); level++) {
+        if (!strcmp(name, lbm_kernels::simdLevelName(static_cast<SimdLevel>(level)))) {
+            return static_cast<SimdLevel>(level);
+        }
+    }
+    fprintf(stderr, "Unknown SIMD level '%s', using auto\n", name);
+    return SimdLevel::Auto;
+}
+
+static const char* kernelName(KernelVariant k) {
+    return k == KernelVariant::Fused ? "fused" : "twopass";
+}
+
+static const char* traversalName(Traversal t) {
+    return t == Traversal::Rows ? "rows" : "columns";
+}
+
+// Measure the smallest stable viscosity per inlet velocity for each size and
+// print the table in the form lbm_planner::stabilityTable() expects
+static int runStability(const std::vector<BenchConfig>& sizes, const StepConfig& step, int steps) {
+    static const double velocities[] = {0.02, 0.04, 0.06, 0.08, 0.10, 0.12, 0.14, 0.16, 0.17};
+    std::vector<double> limits(sizeof(velocities) / sizeof(velocities[0]), 0.0);
+
+    printf("Stability limits (circle, at least %d steps; smallest stable viscosity)\n", steps);
+    printf("%-12s %8s %12s %10s\n", "lattice", "u0", "min nu", "time (s)");
+    for (const BenchConfig& size : sizes) {
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", size.width, size.height);
+        for (size_t v = 0; v < limits.size(); v++) {
+            auto start = std::chrono::steady_clock::now();
+            // At least the inlet ramp plus two passes of the free stream
+            int runSteps = std::max(steps, 500 + static_cast<int>(2.0 * size.width / velocities[v]));
+            double nu = lbm_planner::measureStabilityLimit(size.width, size.height, "circle", velocities[v],
+                                                           runSteps, step);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("%-12s %8.3f %12.6f %10.1f\n", name, velocities[v], nu, seconds);
+            fflush(stdout);
+            limits[v] = std::max(limits[v], nu);
+        }
+    }
+
+    // Bisection noise can put neighbouring velocities out of order; the
+    // planner needs limits that never fall as the velocity rises
+    for (size_t v = 1; v < limits.size(); v++) limits[v] = std::max(limits[v], limits[v - 1]);
+
+    printf("\nLargest limit over all sizes and lower velocities:\n");
+    for (size_t v = 0; v < limits.size(); v++) {
+        printf("        {%.2f, %.6f},\n", velocities[v], limits[v]);
+    }
+    return 0;
+}
+
+// Throughput of the out-of-core solver with its lattice files in dir. Runs
+// whole passes, so steps is rounded up to a multiple of the temporal depth.
+static int runOutOfCore(const std::vector<BenchConfig>& sizes, const char* dir, OutOfCoreConfig config, int steps) {
+    printf("Out-of-core lattice files in %s, slab %d columns, %d steps per pass\n", dir, config.slabWidth,
+           config.temporalSteps);
+    printf("%-14s %10s %8s %10s %10s %12s %12s\n", "lattice", "files (GB)", "steps", "time (s)", "MLUPS",
+           "read (MB/s)", "write (MB/s)");
+    for (const BenchConfig& size : sizes) {
+        LBMOutOfCore solver(size.width, size.height, dir, config);
+        int passes = (steps + config.temporalSteps - 1) / config.temporalSteps;
+        auto start = std::chrono::steady_clock::now();
+        solver.step(passes * config.temporalSteps);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        OutOfCoreStats io = solver.getStats();
+        char name[32];
+        snprintf(name, sizeof(name), "%dx%d", size.width, size.height);
+        printf("%-14s %10.2f %8d %10.3f %10.2f %12.1f %12.1f\n", name, 2.0 * solver.getFileBytes() / 1e9,
+               solver.getStepCount(), seconds,
+               static_cast<double>(size.width) * size.height * solver.getStepCount() / seconds / 1e6,
+               io.bytesRead / seconds / 1e6, io.bytesWritten / seconds / 1e6);
+        fflush(stdout);
+    }
+    return 0;
+}
+
+// Throughput and memory of the block-compressed solver at each rate, and how
+// far its velocity field drifts from an uncompressed run of the same steps
+static int runCompressed(const std::vector<BenchConfig>& sizes, const std::vector<int>& rates, SimdLevel simd,
+                         int steps) {
+    printf("%-14s %5s %12s %10s %10s %10s %12s %12s\n", "lattice", "rate", "lattice (MB)", "bytes/cell",
+           "MLUPS", "in-core", "max |du|", "rel. L2 du");
+    for (const BenchConfig& size : sizes) {
+        StepConfig config;
+        config.kernel = KernelVariant::Fused;
+        config.simd = simd;
+        LBMSolver reference(size.width, size.height, config);
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; s++) reference.step();
+        double referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double cells = static_cast<double>(size.width) * size.height;
+
+        for (int rate : rates) {
+            LBMCompressedSolver solver(size.width, size.height, rate, simd);
+            start = std::chrono::steady_clock::now();
+            for (int s = 0; s < steps; s++) solver.step();
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            std::vector<double> rho, ux, uy;
+            solver.decodeMoments(rho, ux, uy);
+            double maxError = 0.0, error2 = 0.0, norm2 = 0.0;
+            for (int j = 0; j < size.height; j++) {
+                for (int i = 0; i < size.width; i++) {
+                    if (reference.solid(i, j)) continue;
+                    size_t c = static_cast<size_t>(j) * size.width + i;
+                    double dx = ux[c] - reference.velocityX(i, j);
+                    double dy = uy[c] - reference.velocityY(i, j);
+                    double d2 = dx * dx + dy * dy;
+                    maxError = std::max(maxError, std::sqrt(d2));
+                    error2 += d2;
+                    norm2 += reference.velocityX(i, j) * reference.velocityX(i, j) +
+                             reference.velocityY(i, j) * reference.velocityY(i, j);
+                }
+            }
+
+            char name[32];
+            snprintf(name, sizeof(name), "%dx%d", size.width, size.height);
+            printf("%-14s %5d %12.2f %10.2f %10.2f %10.2f %12.3g %12.3g\n", name, solver.getRate(),
+                   solver.getCompressedBytes() / 1e6, solver.getCompressedBytes() / cells,
+                   cells * steps / seconds / 1e6, cells * steps / referenceSeconds / 1e6, maxError,
+                   std::sqrt(error2 / std::max(norm2, 1e-300)));
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
+
+template <typename T>
+static void runFixedSolver(const BenchConfig& size, const LBMSolver& reference, double referenceSeconds,
+                           SimdLevel simd, int threads, int steps) {
+    LBMFixedSolver<T> solver(size.width, size.height);
+    solver.setSimdLevel(simd);
+    solver.setThreads(threads);
+    auto start = std::chrono::steady_clock::now();
+    for (int s = 0; s < steps; s++) solver.step();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    double maxError = 0.0;
+    for (int i = 0; i < size.width; i++) {
+        for (int j = 0; j < size.height; j++) {
+            if (reference.solid(i, j)) continue;
+            double dx = solver.velocityX(i, j) - reference.velocityX(i, j);
+            double dy = solver.velocityY(i, j) - reference.velocityY(i, j);
+            maxError = std::max(maxError, std::sqrt(dx * dx + dy * dy));
+        }
+    }
+
+    double cells = static_cast<double>(size.width) * size.height;
+    char name[32];
+    snprintf(name, sizeof(name), "%dx%d", size.width, size.height);
+    printf("%-14s %5d %-7s %7d %12.2f %10.2f %10.2f %12.3g  %016llx\n", name, static_cast<int>(8 * sizeof(T)),
+           lbm_kernels::simdLevelName(solver.getSimdLevel()), solver.getThreads(), solver.getLatticeBytes() / 1e6,
+           cells * steps / seconds / 1e6, cells * steps / referenceSeconds / 1e6, maxError,
+           static_cast<unsigned long long>(solver.checksum()));
+    fflush(stdout);
+}
+
+// Throughput of the fixed-point solvers, their velocity error against a
+// double-precision run of the same steps, and the lattice checksum (the same
+// for every SIMD level, thread count and machine)
+static int runFixed(const std::vector<BenchConfig>& sizes, const std::vector<int>& bits,
+                    const std::vector<int>& threadCounts, SimdLevel simd, int steps) {
+    printf("%-14s %5s %-7s %7s %12s %10s %10s %12s  %s\n", "lattice", "bits", "simd", "threads", "lattice (MB)",
+           "MLUPS", "double", "max |du|", "checksum");
+    for (const BenchConfig& size : sizes) {
+        StepConfig config;
+        config.kernel = KernelVariant::Fused;
+        config.simd = simd;
+        LBMSolver reference(size.width, size.height, config);
+        auto start = std::chrono::steady_clock::now();
+        for (int s = 0; s < steps; s++) reference.step();
+        double referenceSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (int b : bits) {
+            for (int threads : threadCounts) {
+                if (b == 16) {
+                    runFixedSolver<int16_t>(size, reference, referenceSeconds, simd, threads, steps);
+                } else if (b == 32) {
+                    runFixedSolver<int32_t>(size, reference, referenceSeconds, simd, threads, steps);
+                } else {
+                    fprintf(stderr, "Ignoring fixed-point width %d (expected 16 or 32)\n", b);
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+static std::vector<BenchConfig> parseSizes(const char* arg) {
+    std::vector<BenchConfig> configs;
+    std::string list = arg;
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t comma = list.find(',', pos);
+        if (comma == std::string::npos) comma = list.size();
+        std::string item = list.substr(pos, comma - pos);
+        BenchConfig c;
+        if (sscanf(item.c_str(), "%dx%d", &c.width, &c.height) == 2 && c.width > 2 && c.height > 2) {
+            configs.push_back(c);
+        } else {
+            fprintf(stderr, "Ignoring invalid size '%s' (expected WIDTHxHEIGHT)\n", item.c_str());
+        }
+        pos = comma + 1;
+    }
+    return configs;
+}
+
+static double seconds(std::chrono::steady_clock::time_point a, std::chrono::steady_clock::time_point b) {
+    return std::chrono::duration<double>(b - a).count();
+}
+
+static const char* pinningName(ThreadPinning p) {
+    return p == ThreadPinning::Compact ? "compact" : p == ThreadPinning::Spread ? "spread" : "off";
+}
+
+static BenchResult runConfig(const BenchConfig& config, int steps, int warmup, RaplMeter& meter) {
+    // Threaded from the start, so the lattice is first touched by its stepping threads
+    LBMSolver solver(config.width, config.height, config.step);
+    if (config.watchdog) {
+        WatchdogConfig wd;
+        wd.enabled = true;
+        solver.setWatchdog(wd);
+    }
+    solver.setStrainRateOutput(config.strain);
+    if (config.activity > 0.0) {
+        ActivityConfig activity;
+        activity.enabled = true;
+        activity.threshold = config.activity;
+        solver.setActivity(activity);
+    }
+
+    for (int s = 0; s < warmup; s++) solver.step();
+    double skippedBefore = solver.getActivityStats().skippedFraction;
+
+    // Sample the counters every ~0.25 s so long runs cannot wrap them unnoticed
+    const double sampleInterval = 0.25;
+
+    meter.begin();
+    auto start = std::chrono::steady_clock::now();
+    auto lastSample = start;
+    for (int s = 0; s < steps; s++) {
+        solver.step();
+        auto now = std::chrono::steady_clock::now();
+        if (seconds(lastSample, now) > sampleInterval) {
+            meter.sample();
+            lastSample = now;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    meter.sample();
+
+    BenchResult r;
+    r.config = config;
+    r.steps = steps;
+    r.seconds = seconds(start, end);
+    double mlu = static_cast<double>(config.width) * config.height * steps * 1e-6;
+    r.mlups = mlu / r.seconds;
+    // The stats cover the warmup too
+    r.skippedFraction = (solver.getActivityStats().skippedFraction * (warmup + steps) - skippedBefore * warmup) / steps;
+    if (meter.available()) {
+        r.joules = meter.joules();
+        r.joulesPerMLU = r.joules / mlu;
+        r.watts = r.joules / r.seconds;
+    } else {
+        r.joules = r.joulesPerMLU = r.watts = -1.0;
+    }
+    return r;
+}
+
+static void writeJSON(const char* path, const std::vector<BenchResult>& results, double idleWatts) {
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return;
+    }
+    if (idleWatts >= 0.0) {
+        fprintf(out, "{\n  \"idle_watts\": %.3f,\n  \"results\": [\n", idleWatts);
+    } else {
+        fprintf(out, "{\n  \"idle_watts\": null,\n  \"results\": [\n");
+    }
+    for (size_t n = 0; n < results.size(); n++) {
+        const BenchResult& r = results[n];
+        fprintf(out, "    {\"width\": %d, \"height\": %d, \"threads\": %d, \"tile_width\": %d, "
+                     "\"kernel\": \"%s\", \"traversal\": \"%s\", \"simd\": \"%s\", \"non_temporal\": %s, ",
+                r.config.width, r.config.height, r.config.step.threads, r.config.step.tileWidth,
+                kernelName(r.config.step.kernel), traversalName(r.config.step.traversal),
+                lbm_kernels::simdLevelName(r.config.step.simd), r.config.step.nonTemporal ? "true" : "false");
+        fprintf(out, "\"pinning\": \"%s\", ", pinningName(r.config.step.pinning));
+        fprintf(out, "\"watchdog\": %s, ", r.config.watchdog ? "true" : "false");
+        fprintf(out, "\"strain\": %s, ", r.config.strain ? "true" : "false");
+        if (r.config.activity > 0.0) {
+            fprintf(out, "\"activity\": %g, \"skipped_fraction\": %.4f, ", r.config.activity, r.skippedFraction);
+        } else {
+            fprintf(out, "\"activity\": null, \"skipped_fraction\": 0, ");
+        }
+        fprintf(out, "\"steps\": %d, \"seconds\": %.6f, \"mlups\": %.3f, ", r.steps, r.seconds, r.mlups);
+        if (r.joules >= 0.0) {
+            fprintf(out, "\"joules\": %.3f, \"joules_per_mlu\": %.6f, \"watts\": %.3f}",
+                    r.joules, r.joulesPerMLU, r.watts);
+        } else {
+            fprintf(out, "\"joules\": null, \"joules_per_mlu\": null, \"watts\": null}");
+        }
+        fprintf(out, "%s\n", n + 1 < results.size() ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+    fclose(out);
+}
+
+int main(int argc, char** argv) {
+    std::vector<BenchConfig> sizes = parseSizes("350x175,700x350,1400x700");
+    std::vector<int> threadCounts = {1};
+    StepConfig step;
+    double tuneSeconds = 0.0;
+    int steps = 500;
+    int warmup = 100;
+    double idleSeconds = 0.0;
+    bool watchdog = false;
+    bool strain = false;
+    double activity = 0.0;
+    bool stability = false;
+    bool sizesGiven = false;
+    bool stepsGiven = false;
+    const char* jsonPath = nullptr;
+    const char* outOfCoreDir = nullptr;
+    OutOfCoreConfig outOfCore;
+    std::vector<int> compressedRates;
+    std::vector<int> fixedBits;
+    HugePages hugePages = HugePages::Off;
+
+    for (int a = 1; a < argc; a++) {
+        if (!strcmp(argv[a], "--sizes") && a + 1 < argc) {
+            sizes = parseSizes(argv[++a]);
+            sizesGiven = true;
+        } else if (!strcmp(argv[a], "--threads") && a + 1 < argc) {
+            threadCounts = parseInts(argv[++a]);
+        } else if (!strcmp(argv[a], "--tile") && a + 1 < argc) {
+            step.tileWidth = atoi(argv[++a]);
+        } else if (!strcmp(argv[a], "--kernel") && a + 1 < argc) {
+            a++;
+            step.kernel = !strcmp(argv[a], "fused") ? KernelVariant::Fused : KernelVariant::TwoPass;
+        } else if (!strcmp(argv[a], "--traversal") && a + 1 < argc) {
+            a++;
+            step.traversal = !strcmp(argv[a], "rows") ? Traversal::Rows : Traversal::Columns;
+        } else if (!strcmp(argv[a], "--simd") && a + 1 < argc) {
+            step.simd = parseSimd(argv[++a]);
+        } else if (!strcmp(argv[a], "--nt")) {
+            step.nonTemporal = true;
+        } else if (!strcmp(argv[a], "--pin") && a + 1 < argc) {
+            a++;
+            step.pinning = !strcmp(argv[a], "compact") ? ThreadPinning::Compact
+                           : !strcmp(argv[a], "spread") ? ThreadPinning::Spread
+                                                        : ThreadPinning::Off;
+        } else if (!strcmp(argv[a], "--huge-pages") && a + 1 < argc) {
+            a++;
+            hugePages = !strcmp(argv[a], "thp") ? HugePages::Transparent
+                        : !strcmp(argv[a], "explicit") ? HugePages::Explicit
+                                                       : HugePages::Off;
+        } else if (!strcmp(argv[a], "--watchdog")) {
+            watchdog = true;
+        } else if (!strcmp(argv[a], "--strain")) {
+            strain = true;
+        } else if (!strcmp(argv[a], "--activity") && a + 1 < argc) {
+            activity = std::max(0.0, atof(argv[++a]));
+        } else if (!strcmp(argv[a], "--stability")) {
+            stability = true;
+        } else if (!strcmp(argv[a], "--out-of-core") && a + 1 < argc) {
+            outOfCoreDir = argv[++a];
+        } else if (!strcmp(argv[a], "--slab") && a + 1 < argc) {
+            outOfCore.slabWidth = atoi(argv[++a]);
+        } else if (!strcmp(argv[a], "--temporal") && a + 1 < argc) {
+            outOfCore.temporalSteps = std::max(1, atoi(argv[++a]));
+        } else if (!strcmp(argv[a], "--compressed") && a + 1 < argc) {
+            compressedRates = parseInts(argv[++a]);
+        } else if (!strcmp(argv[a], "--fixed") && a + 1 < argc) {
+            fixedBits = parseInts(argv[++a]);
+        } else if (!strcmp(argv[a], "--autotune") && a + 1 < argc) {
+            tuneSeconds = atof(argv[++a]);
+        } else if (!strcmp(argv[a], "--steps") && a + 1 < argc) {
+            steps = atoi(argv[++a]);
+            stepsGiven = true;
+        } else if (!strcmp(argv[a], "--warmup") && a + 1 < argc) {
+            warmup = atoi(argv[++a]);
+        } else if (!strcmp(argv[a], "--idle") && a + 1 < argc) {
+            idleSeconds = atof(argv[++a]);
+        } else if (!strcmp(argv[a], "--json") && a + 1 < argc) {
+            jsonPath = argv[++a];
+        } else {
+            fprintf(stderr, "Usage: %s [--sizes WxH,...] [--threads N,...] [--tile N] [--kernel twopass|fused]\n"
+                            "       [--traversal columns|rows] [--simd auto|scalar|sse4.2|avx2|avx512] [--nt]\n"
+                            "       [--watchdog] [--strain] [--activity THRESHOLD] [--pin off|compact|spread]\n"
+                            "       [--huge-pages off|thp|explicit]\n"
+                            "       [--autotune SECONDS] [--steps N] [--warmup N]\n"
+                            "       [--idle SECONDS] [--json FILE]\n"
+                            "       %s --stability [--sizes WxH,...] [--steps N]\n"
+                            "       %s --out-of-core DIR [--slab N] [--temporal N] [--sizes WxH,...]\n"
+                            "          [--threads N] [--simd LEVEL] [--steps N]\n"
+                            "       %s --compressed RATE,... [--sizes WxH,...] [--simd LEVEL] [--steps N]\n"
+                            "       %s --fixed 16|32,... [--sizes WxH,...] [--threads N,...] [--simd LEVEL]\n"
+                            "          [--steps N]\n",
+                    argv[0], argv[0], argv[0], argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    LatticeArena::instance().setHugePages(hugePages);
+
+    if (stability) {
+        // Long enough for the wake to start shedding at the larger size
+        if (!sizesGiven) sizes = parseSizes("200x100,400x200");
+        if (!stepsGiven) steps = 4000;
+        step.threads = threadCounts.front();
+        return runStability(sizes, step, steps);
+    }
+
+    if (outOfCoreDir) {
+        outOfCore.threads = threadCounts.front();
+        outOfCore.simd = step.simd;
+        return runOutOfCore(sizes, outOfCoreDir, outOfCore, steps);
+    }
+
+    if (!compressedRates.empty()) return runCompressed(sizes, compressedRates, step.simd, steps);
+    if (!fixedBits.empty()) return runFixed(sizes, fixedBits, threadCounts, step.simd, steps);
+
+    // Expand sizes x thread counts, or one tuned configuration per size
+    std::vector<BenchConfig> configs;
+    for (BenchConfig size : sizes) {
+        size.watchdog = watchdog;
+        size.strain = strain;
+        size.activity = activity;
+        if (tuneSeconds > 0.0) {
+            LBMSolver solver(size.width, size.height);
+            AutoTuner tuner;
+            TuningResult tuned = tuner.tune(solver, tuneSeconds);
+            printf("Tuned %dx%d: threads=%d tile=%d kernel=%s traversal=%s simd=%s nt=%d (%s, %d candidates)\n",
+                   size.width, size.height, tuned.config.threads, tuned.config.tileWidth,
+                   kernelName(tuned.config.kernel), traversalName(tuned.config.traversal),
+                   lbm_kernels::simdLevelName(tuned.config.simd), tuned.config.nonTemporal ? 1 : 0,
+                   tuned.fromCache ? "cached" : "measured", tuned.candidatesTried);
+            size.step = tuned.config;
+            size.step.pinning = step.pinning;
+            configs.push_back(size);
+            continue;
+        }
+        for (int threads : threadCounts) {
+            size.step = step;
+            size.step.threads = threads;
+            // Record the level actually dispatched
+            size.step.simd = lbm_kernels::selectKernels(step.simd).level;
+            configs.push_back(size);
+        }
+    }
+
+    RaplMeter meter;
+    if (meter.available()) {
+        printf("RAPL domains:");
+        for (const std::string& name : meter.domainNames()) printf(" %s", name.c_str());
+        printf("\n");
+    } else {
+        printf("RAPL counters not accessible (need read access to /sys/class/powercap/intel-rapl:*/energy_uj); "
+               "reporting MLUPS only\n");
+    }
+
+    // Optional idle baseline so shared-machine background load can be subtracted
+    double idleWatts = -1.0;
+    if (meter.available() && idleSeconds > 0.0) {
+        meter.begin();
+        std::this_thread::sleep_for(std::chrono::duration<double>(idleSeconds));
+        meter.sample();
+        idleWatts = meter.joules() / idleSeconds;
+        printf("Idle package power: %.2f W\n", idleWatts);
+    }
+
+    printf("CPU: %s, widest SIMD level: %s\n", AutoTuner::cpuModel().c_str(),
+           lbm_kernels::simdLevelName(LBMSolver::getBestSimdLevel()));
+    const lbm_numa::Topology& topology = lbm_numa::systemTopology();
+    printf("NUMA nodes: %zu, CPUs: %d, pinning: %s, huge pages: %s\n", topology.nodes.size(), topology.cpuCount(),
+           pinningName(step.pinning),
+           hugePages == HugePages::Explicit ? "explicit" : hugePages == HugePages::Transparent ? "thp" : "off");
+
+    printf("\n%-12s %7s %5s %-8s %-8s %-7s %3s %8s %10s %10s %10s %10s %12s\n",
+           "lattice", "threads", "tile", "kernel", "order", "simd", "nt", "steps", "time (s)", "MLUPS",
+           "energy (J)", "power (W)", "J / MLU");
+
+    std::vector<BenchResult> results;
+    for (const BenchConfig& c : configs) {
+        BenchResult r = runConfig(c, steps, warmup, meter);
+        results.push_back(r);
+
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d", c.width, c.height);
+        printf("%-12s %7d %5d %-8s %-8s %-7s %3d ", size, c.step.threads, c.step.tileWidth,
+               kernelName(c.step.kernel), traversalName(c.step.traversal),
+               lbm_kernels::simdLevelName(c.step.simd), c.step.nonTemporal ? 1 : 0);
+        if (r.joules >= 0.0) {
+            printf("%8d %10.3f %10.2f %10.2f %10.2f %12.4f", r.steps, r.seconds,
+                   r.mlups, r.joules, r.watts, r.joulesPerMLU);
+            if (idleWatts >= 0.0) {
+                double mlu = static_cast<double>(c.width) * c.height * r.steps * 1e-6;
+                printf("  (above idle: %.4f)", (r.joules - idleWatts * r.seconds) / mlu);
+            }
+            printf("\n");
+        } else {
+            printf("%8d %10.3f %10.2f %10s %10s %12s\n", r.steps, r.seconds,
+                   r.mlups, "-", "-", "-");
+        }
+        if (c.activity > 0.0) printf("%-12s activity tracking skipped %.1f%% of column updates\n", "", 100.0 * r.skippedFraction);
+    }
+
+    if (jsonPath) writeJSON(jsonPath, results, idleWatts);
+    return 0;
+}
@@ -0,0 +1,255 @@
+// C API implementation (see lbm-capi.h)
+// Each handle owns one LBMSolver plus the custom geometry mask, which
+// reset() would otherwise clear. Every entry point catches C++ exceptions and
+// returns a status code instead.
+
+#include "lbm-capi.h"
+#include "lbm-solver.h"
+
+#include <cmath>
+#include <new>
+#include <vector>
+
+struct lbm_solver {
+    LBMSolver solver;
+    std::vector<uint8_t> mask;  // row-major; empty unless a custom body is set
+
+    lbm_solver(int w, int h) : solver(w, h) {}
+
+    void applyMask() {
+        if (mask.empty()) return;
+        int width = solver.getWidth();
+        for (int j = 0; j < solver.getHeight(); j++) {
+            for (int i = 0; i < width; i++) {
+                if (mask[static_cast<size_t>(j) * width + i]) solver.setSolid(i, j, true);
+            }
+        }
+    }
+
+    size_t cells() const { return static_cast<size_t>(solver.getWidth()) * solver.getHeight(); }
+};
+
+// Run f and translate exceptions into status codes
+template <typename F>
+static int guarded(F f) {
+    try {
+        return f();
+    } catch (const std::bad_alloc&) {
+        return LBM_ERROR_MEMORY;
+    } catch (...) {
+        return LBM_ERROR_INTERNAL;
+    }
+}
+
+extern "C" {
+
+int lbm_api_version(void) { return LBM_API_VERSION; }
+
+const char* lbm_status_string(int status) {
+    switch (status) {
+        case LBM_OK: return "ok";
+        case LBM_ERROR_ARGUMENT: return "invalid argument";
+        case LBM_ERROR_MEMORY: return "out of memory";
+        case LBM_ERROR_SIZE: return "buffer too small";
+        case LBM_ERROR_INTERNAL: return "internal error";
+        default: return "unknown status";
+    }
+}
+
+lbm_solver* lbm_create(int width, int height) {
+    if (width < 3 || height < 3) return nullptr;
+    try {
+        return new lbm_solver(width, height);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void lbm_destroy(lbm_solver* solver) { delete solver; }
+
+int lbm_get_size(const lbm_solver* solver, int* width, int* height) {
+    if (!solver || !width || !height) return LBM_ERROR_ARGUMENT;
+    *width = solver->solver.getWidth();
+    *height = solver->solver.getHeight();
+    return LBM_OK;
+}
+
+int lbm_set_viscosity(lbm_solver* solver, double viscosity) {
+    if (!solver || !(viscosity > 0.0) || !std::isfinite(viscosity)) return LBM_ERROR_ARGUMENT;
+    solver->solver.setViscosity(viscosity);
+    return LBM_OK;
+}
+
+int lbm_set_velocity(lbm_solver* solver, double velocity) {
+    if (!solver || !std::isfinite(velocity)) return LBM_ERROR_ARGUMENT;
+    solver->solver.setVelocity(velocity);
+    return LBM_OK;
+}
+
+int lbm_get_parameters(const lbm_solver* solver, double* viscosity, double* velocity) {
+    if (!solver || !viscosity || !velocity) return LBM_ERROR_ARGUMENT;
+    *viscosity = solver->solver.getViscosity();
+    *velocity = solver->solver.getVelocity();
+    return LBM_OK;
+}
+
+int lbm_set_geometry(lbm_solver* solver, const char* name) {
+    if (!solver || !name) return LBM_ERROR_ARGUMENT;
+    return guarded([&] {
+        solver->mask.clear();
+        solver->solver.setGeometry(name);
+        return LBM_OK;
+    });
+}
+
+int lbm_set_geometry_mask(lbm_solver* solver, const uint8_t* mask, size_t count) {
+    if (!solver || !mask) return LBM_ERROR_ARGUMENT;
+    if (count < solver->cells()) return LBM_ERROR_SIZE;
+    return guarded([&] {
+        solver->mask.assign(mask, mask + solver->cells());
+        solver->solver.setGeometry("none");
+        solver->applyMask();
+        return LBM_OK;
+    });
+}
+
+int lbm_set_execution(lbm_solver* solver, int threads, int simd, int tile_width) {
+    if (!solver || simd < LBM_SIMD_AUTO || simd > static_cast<int>(SimdLevel::SIMD128)) return LBM_ERROR_ARGUMENT;
+    return guarded([&] {
+        StepConfig c = solver->solver.getStepConfig();
+        c.threads = threads;
+        c.simd = static_cast<SimdLevel>(simd);
+        c.tileWidth = tile_width;
+        solver->solver.setStepConfig(c);
+        return LBM_OK;
+    });
+}
+
+int lbm_set_strain_rate_output(lbm_solver* solver, int enabled) {
+    if (!solver) return LBM_ERROR_ARGUMENT;
+    return guarded([&] {
+        solver->solver.setStrainRateOutput(enabled != 0);
+        return LBM_OK;
+    });
+}
+
+int lbm_reset(lbm_solver* solver) {
+    if (!solver) return LBM_ERROR_ARGUMENT;
+    return guarded([&] {
+        solver->solver.reset();
+        solver->applyMask();
+        return LBM_OK;
+    });
+}
+
+int lbm_step_n(lbm_solver* solver, int steps) {
+    if (!solver || steps < 0) return LBM_ERROR_ARGUMENT;
+    return guarded([&] {
+        for (int s = 0; s < steps; s++) solver->solver.step();
+        return LBM_OK;
+    });
+}
+
+int lbm_get_step_count(const lbm_solver* solver, int* steps) {
+    if (!solver || !steps) return LBM_ERROR_ARGUMENT;
+    *steps = solver->solver.getStepCount();
+    return LBM_OK;
+}
+
+int lbm_copy_field(const lbm_solver* solver, lbm_field field, double* buffer, size_t count) {
+    if (!solver || !buffer) return LBM_ERROR_ARGUMENT;
+    if (count < solver->cells()) return LBM_ERROR_SIZE;
+    const LBMSolver& s = solver->solver;
+    int width = s.getWidth();
+    int height = s.getHeight();
+
+    for (int j = 0; j < height; j++) {
+        double* row = buffer + static_cast<size_t>(j) * width;
+        for (int i = 0; i < width; i++) {
+            switch (field) {
+                case LBM_FIELD_DENSITY: row[i] = s.density(i, j); break;
+                case LBM_FIELD_VELOCITY_X: row[i] = s.velocityX(i, j); break;
+                case LBM_FIELD_VELOCITY_Y: row[i] = s.velocityY(i, j); break;
+                case LBM_FIELD_SPEED:
+                    row[i] = std::sqrt(s.velocityX(i, j) * s.velocityX(i, j) + s.velocityY(i, j) * s.velocityY(i, j));
+                    break;
+                case LBM_FIELD_VORTICITY: row[i] = s.vorticity(i, j); break;
+                case LBM_FIELD_PRESSURE: row[i] = s.density(i, j) / 3.0; break;
+                case LBM_FIELD_STRAIN_RATE: row[i] = s.strainRate(i, j); break;
+                default: return LBM_ERROR_ARGUMENT;
+            }
+        }
+    }
+    return LBM_OK;
+}
+
+int lbm_copy_obstacle(const lbm_solver* solver, uint8_t* buffer, size_t count) {
+    if (!solver || !buffer) return LBM_ERROR_ARGUMENT;
+    if (count < solver->cells()) return LBM_ERROR_SIZE;
+    const LBMSolver& s = solver->solver;
+    for (int j = 0; j < s.getHeight(); j++) {
+        for (int i = 0; i < s.getWidth(); i++) {
+            buffer[static_cast<size_t>(j) * s.getWidth() + i] = s.solid(i, j) ? 1 : 0;
+        }
+    }
+    return LBM_OK;
+}
+
+const double* lbm_field_ptr(lbm_solver* solver, lbm_field field, size_t* column_stride) {
+    if (!solver) return nullptr;
+    LBMSolver& s = solver->solver;
+    if (column_stride) *column_stride = s.getColumnStride();
+    switch (field) {
+        case LBM_FIELD_DENSITY: return s.densityData();
+        case LBM_FIELD_VELOCITY_X: return s.velocityXData();
+        case LBM_FIELD_VELOCITY_Y: return s.velocityYData();
+        case LBM_FIELD_STRAIN_RATE: return s.strainRateData();
+        default: return nullptr;
+    }
+}
+
+const double* lbm_population_ptr(lbm_solver* solver, int k, size_t* column_stride) {
+    if (!solver || k < 0 || k > 8) return nullptr;
+    LBMSolver& s = solver->solver;
+    if (column_stride) *column_stride = s.getColumnStride();
+    return s.populationData() + k * s.getPlaneStride();
+}
+
+int lbm_compute_diagnostics(lbm_solver* solver, lbm_diagnostics* out) {
+    if (!solver || !out) return LBM_ERROR_ARGUMENT;
+    return guarded([&] {
+        Diagnostics d = solver->solver.computeDiagnostics();
+        out->mass = d.mass;
+        out->momentum_x = d.momentumX;
+        out->momentum_y = d.momentumY;
+        out->max_speed = d.maxSpeed;
+        out->min_density = d.minDensity;
+        out->max_density = d.maxDensity;
+        out->force_x = d.forceX;
+        out->force_y = d.forceY;
+        out->fluid_cells = d.fluidCells;
+        return LBM_OK;
+    });
+}
+
+int lbm_copy_surface(lbm_solver* solver, int averaged, lbm_surface_point* buffer, size_t capacity, size_t* count) {
+    if (!solver || !count || (capacity > 0 && !buffer)) return LBM_ERROR_ARGUMENT;
+    return guarded([&] {
+        std::vector<SurfacePoint> points = solver->solver.computeSurface(averaged != 0);
+        *count = points.size();
+        if (capacity < points.size()) return LBM_ERROR_SIZE;
+        for (size_t n = 0; n < points.size(); n++) {
+            const SurfacePoint& p = points[n];
+            buffer[n] = {p.i, p.j, p.arcLength, p.nx, p.ny, p.cp, p.cf};
+        }
+        return LBM_OK;
+    });
+}
+
+int lbm_set_surface_averaging(lbm_solver* solver, int enabled) {
+    if (!solver) return LBM_ERROR_ARGUMENT;
+    solver->solver.setSurfaceAveraging(enabled != 0);
+    return LBM_OK;
+}
+
+}  // extern "C"
@@ -0,0 +1,146 @@
+/* C API for the native LBM solver (liblbm.so)
+ * A plain C ABI over LBMSolver for C, Fortran (ISO_C_BINDING) and other
+ * language runtimes. Solvers are opaque handles; every instance is
+ * independent, so different handles may be used from different threads at
+ * the same time (one handle must not be used by two threads at once).
+ *
+ * Fields are exchanged in caller-provided buffers laid out like the
+ * JavaScript exports: row-major, height rows of width values, index
+ * j * width + i. lbm_field_ptr() gives direct read access to solver memory
+ * instead: column-major, column i starting at i * column_stride.
+ *
+ * Functions returning int return LBM_OK or a negative lbm_status; C++
+ * exceptions never cross this interface.
+ *
+ * Build: ./build-native.sh (produces liblbm.so)
+ */
+#ifndef LBM_CAPI_H
+#define LBM_CAPI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define LBM_API __declspec(dllexport)
+#else
+#define LBM_API __attribute__((visibility("default")))
+#endif
+
+/* Incremented when a signature or struct layout changes */
+#define LBM_API_VERSION 1
+
+typedef struct lbm_solver lbm_solver;
+
+typedef enum {
+    LBM_OK = 0,
+    LBM_ERROR_ARGUMENT = -1,  /* null handle/buffer or value out of range */
+    LBM_ERROR_MEMORY = -2,    /* allocation failed */
+    LBM_ERROR_SIZE = -3,      /* buffer smaller than width * height */
+    LBM_ERROR_INTERNAL = -4
+} lbm_status;
+
+typedef enum {
+    LBM_FIELD_DENSITY = 0,
+    LBM_FIELD_VELOCITY_X = 1,
+    LBM_FIELD_VELOCITY_Y = 2,
+    LBM_FIELD_SPEED = 3,      /* copy only */
+    LBM_FIELD_VORTICITY = 4,  /* copy only */
+    LBM_FIELD_PRESSURE = 5,   /* copy only */
+    LBM_FIELD_STRAIN_RATE = 6 /* pointer only after lbm_set_strain_rate_output(solver, 1) */
+} lbm_field;
+
+/* Same values as SimdLevel in lbm-kernels.h */
+typedef enum {
+    LBM_SIMD_AUTO = -1,
+    LBM_SIMD_SCALAR = 0,
+    LBM_SIMD_SSE42 = 1,
+    LBM_SIMD_AVX2 = 2,
+    LBM_SIMD_AVX512 = 3
+} lbm_simd;
+
+typedef struct {
+    double mass;
+    double momentum_x;
+    double momentum_y;
+    double max_speed;
+    double min_density;
+    double max_density;
+    double force_x;
+    double force_y;
+    int fluid_cells;
+} lbm_diagnostics;
+
+/* One fluid cell next to the obstacle, see SurfacePoint in lbm-solver.h */
+typedef struct {
+    int i, j;
+    double arc_length;
+    double nx, ny;  /* unit normal out of the body */
+    double cp;      /* pressure coefficient */
+    double cf;      /* wall shear coefficient along increasing arc_length */
+} lbm_surface_point;
+
+LBM_API int lbm_api_version(void);
+LBM_API const char* lbm_status_string(int status);
+
+/* NULL if the size is invalid or memory runs out */
+LBM_API lbm_solver* lbm_create(int width, int height);
+LBM_API void lbm_destroy(lbm_solver* solver);
+
+LBM_API int lbm_get_size(const lbm_solver* solver, int* width, int* height);
+LBM_API int lbm_set_viscosity(lbm_solver* solver, double viscosity);
+LBM_API int lbm_set_velocity(lbm_solver* solver, double velocity);
+LBM_API int lbm_get_parameters(const lbm_solver* solver, double* viscosity, double* velocity);
+
+/* Built-in body: "circle", "airfoil", "square", "flat_plate", "triangle"
+ * or "none". Resets the flow. */
+LBM_API int lbm_set_geometry(lbm_solver* solver, const char* name);
+/* Custom body, row-major width * height bytes, non-zero = solid. Copied, and
+ * re-applied by lbm_reset(). Resets the flow. */
+LBM_API int lbm_set_geometry_mask(lbm_solver* solver, const uint8_t* mask, size_t count);
+
+/* Threads (clamped to 1..256), SIMD level (unsupported levels fall back to
+ * the best available) and columns per tile (0 = one tile per thread) */
+LBM_API int lbm_set_execution(lbm_solver* solver, int threads, int simd, int tile_width);
+
+/* Have each step store the strain-rate magnitude (one more field); without
+ * it LBM_FIELD_STRAIN_RATE is computed from the populations on copy */
+LBM_API int lbm_set_strain_rate_output(lbm_solver* solver, int enabled);
+
+LBM_API int lbm_reset(lbm_solver* solver);
+LBM_API int lbm_step_n(lbm_solver* solver, int steps);
+LBM_API int lbm_get_step_count(const lbm_solver* solver, int* steps);
+
+/* Copy a field into buffer (count >= width * height, row-major) */
+LBM_API int lbm_copy_field(const lbm_solver* solver, lbm_field field, double* buffer, size_t count);
+/* Copy the obstacle mask (count >= width * height, row-major, 1 = solid) */
+LBM_API int lbm_copy_obstacle(const lbm_solver* solver, uint8_t* buffer, size_t count);
+
+/* Direct read-only pointer to density, velocity or stored strain-rate
+ * storage, valid until lbm_destroy() (strain rate: no longer updated once
+ * switched off); NULL for derived fields. Column-major with *column_stride
+ * doubles per column. Values are from the last collision pass. */
+LBM_API const double* lbm_field_ptr(lbm_solver* solver, lbm_field field, size_t* column_stride);
+/* Population plane k (0..8), same layout. The planes swap buffers every
+ * step, so fetch the pointer again after lbm_step_n(). */
+LBM_API const double* lbm_population_ptr(lbm_solver* solver, int k, size_t* column_stride);
+
+LBM_API int lbm_compute_diagnostics(lbm_solver* solver, lbm_diagnostics* out);
+
+/* Surface points in contour order. *count receives the number of points;
+ * LBM_ERROR_SIZE (and nothing copied) if capacity is smaller, so call with
+ * capacity 0 first to size the buffer. averaged != 0 gives the mean since
+ * lbm_set_surface_averaging(solver, 1). */
+LBM_API int lbm_copy_surface(lbm_solver* solver, int averaged, lbm_surface_point* buffer, size_t capacity,
+                             size_t* count);
+/* Start (enabled != 0) or stop accumulating the surface average; restarts it */
+LBM_API int lbm_set_surface_averaging(lbm_solver* solver, int enabled);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LBM_CAPI_H */
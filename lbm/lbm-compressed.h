@@ -0,0 +1,676 @@
+// Block-compressed D2Q9 solver for lattices that do not fit in memory
+// uncompressed (or in the wasm32 heap). Each 4x4 block of every population
+// plane is stored in a fixed number of bits, coded the way ZFP codes
+// floating-point blocks: a common exponent, a decorrelating lifting
+// transform, then a fixed number of bits per transform coefficient that adds
+// up to the rate (see Layout). What gets coded is the deviation of each population from the
+// equilibrium of its cell's last collision moments. The moments are stored
+// too (rho - 1, ux, uy, coded first), so smooth flow leaves small residuals
+// and the bits go to precision rather than to the mean.
+//
+// step() sweeps the lattice in tiles of 4 columns. A tile is decompressed
+// into cache-resident scratch one tile ahead of the sweep and collided there.
+// Streaming into tile t reads the collided tiles t - 1, t and t + 1, and the
+// result is compressed back one tile later, after the outlet (which copies
+// column W - 2 into W - 1) has seen it. Storage is 12 planes of `rate` bits
+// per cell against 2 * 9 doubles plus moments for LBMSolver: at rate 16 the
+// lattice is about 7x smaller.
+//
+// Compression is lossy, so results follow LBMSolver's to the precision of
+// the rate rather than bit for bit (lbm-bench --compressed reports the
+// difference). The physics is LBMSolver::step() with the default
+// BoundaryConfig and no watchdog, on one thread.
+#pragma once
+
+#include "lbm-solver.h"
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace lbm_zfp {
+
+// 64-bit words of one coded block; rates are multiples of 4 bits per value,
+// so blocks start on word boundaries and sit at fixed offsets
+inline size_t blockWords(int rate) { return static_cast<size_t>(rate) * 16 / 64; }
+
+constexpr int headerBits = 16;  // nonzero flag and biased common exponent
+constexpr int exponentBias = 1023;
+
+// Bits kept of each transform coefficient (index x + 4 * y, sequency x + y).
+// Smooth blocks carry most of their energy at low sequency, so those
+// coefficients get up to 3 bits more than the base and the highest ones 3
+// fewer; the base is one bit below the rate, which pays for the header.
+// Unlike ZFP's embedded bit-plane coder the widths are fixed, so a block
+// codes in a few dozen branch-free operations.
+struct Layout {
+    int bits[16];
+};
+
+inline Layout layoutForRate(int rate) {
+    Layout l;
+    for (int y = 0; y < 4; y++) {
+        for (int x = 0; x < 4; x++) l.bits[x + 4 * y] = std::max(0, std::min(64, rate - 1 + 3 - (x + y)));
+    }
+    return l;
+}
+
+// 2^e for normal exponents, built from the bits (ldexp is a library call)
+inline double powerOfTwo(int e) {
+    uint64_t bits = static_cast<uint64_t>(e + exponentBias) << 52;
+    double d;
+    std::memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+// ZFP's decorrelating lifting transform of p[0], p[s], p[2s], p[3s]
+inline void forwardLift(int64_t* p, size_t s) {
+    int64_t x = p[0], y = p[s], z = p[2 * s], w = p[3 * s];
+    x += w; x >>= 1; w -= x;
+    z += y; z >>= 1; y -= z;
+    x += z; x >>= 1; z -= x;
+    w += y; w >>= 1; y -= w;
+    w += y >> 1; y -= w >> 1;
+    p[0] = x; p[s] = y; p[2 * s] = z; p[3 * s] = w;
+}
+
+inline void inverseLift(int64_t* p, size_t s) {
+    int64_t x = p[0], y = p[s], z = p[2 * s], w = p[3 * s];
+    y += w >> 1; w -= y >> 1;
+    y += w; w *= 2; w -= y;
+    z += x; x *= 2; x -= z;
+    y += z; z *= 2; z -= y;
+    w += x; x *= 2; x -= w;
+    p[0] = x; p[s] = y; p[2 * s] = z; p[3 * s] = w;
+}
+
+// Code 16 values (v[r + 4 * c]) into blockWords(rate) words. Blocks that are
+// all zero or not finite are stored as zero.
+inline void encodeBlock(const double* v, const Layout& layout, int rate, uint64_t* out) {
+    size_t words = blockWords(rate);
+    double vmax = 0.0;
+    for (int i = 0; i < 16; i++) vmax = std::max(vmax, std::fabs(v[i]));
+    if (!(vmax > 0.0) || !std::isfinite(vmax)) {
+        std::fill(out, out + words, uint64_t(0));
+        return;
+    }
+
+    // |v| < 2^emax: scaled to 62 bits, two bits of headroom for the transform.
+    // Blocks below 2^-900 are flushed to zero to keep the scales normal.
+    uint64_t vbits;
+    std::memcpy(&vbits, &vmax, sizeof(vbits));
+    int emax = static_cast<int>(vbits >> 52) - exponentBias + 1;
+    if (emax < -900) {
+        std::fill(out, out + words, uint64_t(0));
+        return;
+    }
+
+    double scale = powerOfTwo(62 - emax);
+    int64_t q[16];
+    for (int i = 0; i < 16; i++) q[i] = static_cast<int64_t>(v[i] * scale);
+    for (int y = 0; y < 4; y++) forwardLift(q + 4 * y, 1);
+    for (int x = 0; x < 4; x++) forwardLift(q + x, 4);
+
+    // Keep the top bits of each coefficient, packed into words in a register
+    uint64_t acc = 2u * static_cast<unsigned>(emax + exponentBias) + 1u;
+    int fill = headerBits;
+    size_t word = 0;
+    for (int i = 0; i < 16; i++) {
+        int n = layout.bits[i];
+        if (n == 0) continue;
+        uint64_t bits = static_cast<uint64_t>(q[i]) >> (64 - n);
+        acc |= bits << fill;
+        if (fill + n >= 64) {
+            out[word++] = acc;
+            acc = fill ? bits >> (64 - fill) : 0;
+            fill += n - 64;
+        } else {
+            fill += n;
+        }
+    }
+    if (fill > 0) out[word++] = acc;
+    std::fill(out + word, out + words, uint64_t(0));
+}
+
+inline void decodeBlock(const uint64_t* in, const Layout& layout, double* v) {
+    uint64_t cur = in[0];
+    uint64_t header = cur & ((uint64_t(1) << headerBits) - 1);
+    if (!(header & 1u)) {
+        for (int i = 0; i < 16; i++) v[i] = 0.0;
+        return;
+    }
+    int emax = static_cast<int>(header >> 1) - exponentBias;
+
+    // Truncated coefficients come back at the middle of their interval
+    int64_t q[16];
+    int used = headerBits;
+    size_t word = 0;
+    for (int i = 0; i < 16; i++) {
+        int n = layout.bits[i];
+        if (n == 0) {
+            q[i] = 0;
+            continue;
+        }
+        if (used == 64) {
+            cur = in[++word];
+            used = 0;
+        }
+        uint64_t bits = cur >> used;
+        int avail = 64 - used;
+        if (n > avail) {
+            cur = in[++word];
+            bits |= cur << avail;
+            used = n - avail;
+        } else {
+            used += n;
+        }
+        int shift = 64 - n;
+        q[i] = static_cast<int64_t>(bits << shift);
+        if (shift > 0) q[i] += int64_t(1) << (shift - 1);
+    }
+    for (int x = 0; x < 4; x++) inverseLift(q + x, 4);
+    for (int y = 0; y < 4; y++) inverseLift(q + 4 * y, 1);
+
+    double scale = powerOfTwo(emax - 62);
+    for (int i = 0; i < 16; i++) v[i] = static_cast<double>(q[i]) * scale;
+}
+
+}  // namespace lbm_zfp
+
+class LBMCompressedSolver {
+public:
+    // Below 12 bits per value the quantization error feeds back through the
+    // collision and the default wind tunnel diverges (rate 8 reaches inf
+    // within 1000 steps at 700x350), and there is no watchdog to catch it
+    static constexpr int minRate = 12;
+
+    // rate: bits per stored value, rounded up to a multiple of 4 in
+    // [minRate, 64]
+    LBMCompressedSolver(int w, int h, int rate = 16, SimdLevel simd = SimdLevel::Auto)
+        : width(w), height(h), u0(0.15), stepCount(0), totalSteps(0), currentGeometry("circle") {
+        if (width < 3 || height < 3) throw std::invalid_argument("lattice must be at least 3x3");
+        colStride = (static_cast<size_t>(height) + padCells - 1) / padCells * padCells;
+        tiles = (width + tileColumns - 1) / tileColumns;
+        tilePlane = tileColumns * colStride;
+        rowBlocks = colStride / 4;
+        if (tilePlane > SIZE_MAX / static_cast<size_t>(tiles)) throw std::bad_alloc();
+        obstacle = AlignedBuffer<uint8_t>(tilePlane * tiles);
+
+        for (Tile& t : ring) {
+            t.f = AlignedBuffer<double>(9 * tilePlane + 2 * padCells);
+            t.rho = AlignedBuffer<double>(tilePlane);
+            t.ux = AlignedBuffer<double>(tilePlane);
+            t.uy = AlignedBuffer<double>(tilePlane);
+        }
+        for (AlignedBuffer<double>& o : out) o = AlignedBuffer<double>(9 * tilePlane + 2 * padCells);
+        equilibrium = AlignedBuffer<double>(9 * tilePlane);
+
+        kernels = lbm_kernels::selectKernels(simd);
+        setRate(rate);
+        setViscosity(0.02);
+    }
+
+    // Arena bytes of a width x height solver at a rate: the blocks plus the
+    // decompressed tiles, which do not grow with the width
+    static uint64_t requiredBytes(int width, int height, int rate) {
+        rate = std::max(minRate, std::min(64, (rate + 3) / 4 * 4));
+        uint64_t colStride = (static_cast<uint64_t>(height) + padCells - 1) / padCells * padCells;
+        uint64_t tiles = (static_cast<uint64_t>(width) + tileColumns - 1) / tileColumns;
+        uint64_t tilePlane = tileColumns * colStride;
+        uint64_t tileWords = planes * (colStride / 4) * lbm_zfp::blockWords(rate);
+        uint64_t tileF = AlignedBuffer<double>::bytesFor(9 * tilePlane + 2 * padCells);
+        uint64_t scratch = 3 * (tileF + 3 * AlignedBuffer<double>::bytesFor(tilePlane)) + 2 * tileF +
+                           AlignedBuffer<double>::bytesFor(9 * tilePlane);
+        return AlignedBuffer<uint64_t>::bytesFor(tileWords * tiles) +
+               AlignedBuffer<uint8_t>::bytesFor(tilePlane * tiles) + scratch;
+    }
+
+    LBMCompressedSolver(const LBMCompressedSolver&) = delete;
+    LBMCompressedSolver& operator=(const LBMCompressedSolver&) = delete;
+
+    // Reallocates the blocks and resets the flow
+    void setRate(int r) {
+        rate = std::max(minRate, std::min(64, (r + 3) / 4 * 4));
+        layout = lbm_zfp::layoutForRate(rate);
+        words = lbm_zfp::blockWords(rate);
+        tileWords = planes * rowBlocks * words;
+        if (tileWords > SIZE_MAX / sizeof(uint64_t) / static_cast<size_t>(tiles)) throw std::bad_alloc();
+        blocks = AlignedBuffer<uint64_t>();
+        blocks = AlignedBuffer<uint64_t>(tileWords * tiles);
+        reset();
+    }
+
+    int getRate() const { return rate; }
+
+    void setViscosity(double viscosity) {
+        nu = viscosity;
+        omega = 1.0 / (3.0 * nu + 0.5);
+    }
+
+    void setVelocity(double velocity) { u0 = velocity; }
+    double getViscosity() const { return nu; }
+    double getVelocity() const { return u0; }
+
+    void setGeometry(const std::string& geom) {
+        currentGeometry = geom;
+        reset();
+    }
+
+    std::string getGeometry() const { return currentGeometry; }
+
+    // Same as LBMSolver::setSolid(): cleared again by reset()
+    void setSolid(int i, int j, bool solid) { obstacle[idx(i, j)] = solid ? 1 : 0; }
+    bool solid(int i, int j) const { return obstacle[idx(i, j)] != 0; }
+
+    // Equilibrium at rest: moments (1, 0, 0) and zero residuals, which code
+    // as all-zero blocks
+    void reset() {
+        stepCount = 0;
+        totalSteps = 0;
+        for (int i = 0; i < tiles * tileColumns; i++) {
+            for (size_t j = 0; j < colStride; j++) {
+                obstacle[idx(i, 0) + j] = i < width && j < static_cast<size_t>(height) ? 0 : 1;
+            }
+        }
+        LBMSolver::rasterizeGeometry(currentGeometry, width, height,
+                                     [this](int i, int j) { obstacle[idx(i, j)] = 1; });
+        std::fill(blocks.data(), blocks.data() + tileWords * tiles, uint64_t(0));
+    }
+
+    void step() {
+        double velocity = u0;
+        if (stepCount < rampUpSteps) {
+            velocity = u0 * static_cast<double>(stepCount) / rampUpSteps;
+            stepCount++;
+        }
+
+        for (int t = 0; t < std::min(2, tiles); t++) prepareTile(t);
+        for (int t = 0; t < tiles; t++) {
+            double* o = out[t & 1].data() + padCells;
+            streamTile(t, o);
+            if (t == 0) applyInlet(o, velocity);
+            applyFreeSlipWalls(t, o);
+            if (t == tiles - 1) applyOutlet();
+
+            // Tile t - 1 is final once the outlet can no longer read it
+            if (t > 0) storeTile(t - 1);
+            if (t + 2 < tiles) prepareTile(t + 2);
+        }
+        storeTile(tiles - 1);
+        totalSteps++;
+    }
+
+    int getStepCount() const { return totalSteps; }
+
+    // Decodes the cell's blocks on every call
+    double distribution(int i, int j, int k) const {
+        double m[3];
+        cellMoments(i, j, m);
+        return predict(k, 1.0 + m[0], m[1], m[2]) + decodeValue(i, j, k);
+    }
+
+    // Moments of the last collision, as LBMSolver::density() / velocityX()
+    double density(int i, int j) const { return solid(i, j) ? 1.0 : 1.0 + decodeValue(i, j, rhoPlane); }
+    double velocityX(int i, int j) const { return solid(i, j) ? 0.0 : decodeValue(i, j, uxPlane); }
+    double velocityY(int i, int j) const { return solid(i, j) ? 0.0 : decodeValue(i, j, uyPlane); }
+
+    // All moments, row-major (j * width + i)
+    void decodeMoments(std::vector<double>& rhoOut, std::vector<double>& uxOut, std::vector<double>& uyOut) const {
+        size_t cells = static_cast<size_t>(width) * height;
+        rhoOut.assign(cells, 1.0);
+        uxOut.assign(cells, 0.0);
+        uyOut.assign(cells, 0.0);
+        double v[16];
+        for (int t = 0; t < tiles; t++) {
+            for (int p = rhoPlane; p <= uyPlane; p++) {
+                std::vector<double>& dst = p == rhoPlane ? rhoOut : p == uxPlane ? uxOut : uyOut;
+                for (size_t b = 0; b < rowBlocks; b++) {
+                    lbm_zfp::decodeBlock(blockAt(t, p, b), layout, v);
+                    for (int c = 0; c < tileColumns; c++) {
+                        int i = t * tileColumns + c;
+                        for (int r = 0; r < 4; r++) {
+                            int j = static_cast<int>(4 * b) + r;
+                            if (i >= width || j >= height || obstacle[idx(i, j)]) continue;
+                            dst[static_cast<size_t>(j) * width + i] = (p == rhoPlane ? 1.0 : 0.0) + v[r + 4 * c];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    size_t getCompressedBytes() const { return tileWords * tiles * sizeof(uint64_t); }
+
+#ifdef __EMSCRIPTEN__
+    // Same fields as LBMSolver's getters, decoded once per call
+    val getVelocityMagnitude() {
+        std::vector<double> r, x, y;
+        decodeMoments(r, x, y);
+        val result = val::array();
+        for (size_t c = 0; c < r.size(); c++) result.call<void>("push", sqrt(x[c] * x[c] + y[c] * y[c]));
+        return result;
+    }
+
+    val getVorticity() {
+        std::vector<double> r, x, y;
+        decodeMoments(r, x, y);
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                double omega_z = 0.0;
+                if (i > 0 && i < width - 1 && j > 0 && j < height - 1) {
+                    size_t c = static_cast<size_t>(j) * width + i;
+                    omega_z = (y[c + 1] - y[c - 1]) / 2.0 - (x[c + width] - x[c - width]) / 2.0;
+                }
+                result.call<void>("push", omega_z);
+            }
+        }
+        return result;
+    }
+
+    val getPressure() {
+        std::vector<double> r, x, y;
+        decodeMoments(r, x, y);
+        val result = val::array();
+        for (double d : r) result.call<void>("push", d / 3.0);
+        return result;
+    }
+
+    val getObstacle() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) result.call<void>("push", obstacle[idx(i, j)] != 0);
+        }
+        return result;
+    }
+
+    val getUx() {
+        std::vector<double> r, x, y;
+        decodeMoments(r, x, y);
+        val result = val::array();
+        for (double u : x) result.call<void>("push", u);
+        return result;
+    }
+
+    val getUy() {
+        std::vector<double> r, x, y;
+        decodeMoments(r, x, y);
+        val result = val::array();
+        for (double u : y) result.call<void>("push", u);
+        return result;
+    }
+#endif
+
+private:
+    static constexpr int ex[9] = {0, 1, 0, -1, 0, 1, -1, -1, 1};
+    static constexpr int ey[9] = {0, 0, 1, 0, -1, 1, 1, -1, -1};
+    static constexpr double w[9] = {4.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0,
+                                     1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0};
+    static constexpr size_t padCells = 8;
+    static constexpr int rampUpSteps = 500;
+    static constexpr int tileColumns = 4;
+    // Coded planes of a tile: the 9 populations, then the moments
+    static constexpr int rhoPlane = 9, uxPlane = 10, uyPlane = 11, planes = 12;
+
+    // Decompressed tile: populations and moments, columns colStride apart
+    struct Tile {
+        AlignedBuffer<double> f;  // 9 planes of tilePlane, padCells of slack at both ends
+        AlignedBuffer<double> rho, ux, uy;
+    };
+
+    int width, height;
+    double nu, omega, u0;
+    int stepCount;   // ramp position, as in LBMSolver
+    int totalSteps;
+    std::string currentGeometry;
+    int rate;
+    lbm_zfp::Layout layout;
+    size_t colStride;
+    int tiles;
+    size_t tilePlane;
+    size_t rowBlocks;  // 4x4 blocks down a tile
+    size_t words;      // per block
+    size_t tileWords;
+
+    AlignedBuffer<uint64_t> blocks;   // tile-major, then plane, then row block
+    AlignedBuffer<uint8_t> obstacle;  // columns past the width are solid
+    Tile ring[3];                     // collided tiles t - 1, t, t + 1 (tile % 3)
+    AlignedBuffer<double> out[2];     // streamed tiles t - 1 and t (tile % 2)
+    AlignedBuffer<double> equilibrium;
+    lbm_kernels::KernelTable kernels;
+
+    size_t idx(int i, int j) const { return static_cast<size_t>(i) * colStride + j; }
+
+    const uint64_t* blockAt(int t, int p, size_t b) const {
+        return blocks.data() + t * tileWords + (p * rowBlocks + b) * words;
+    }
+    uint64_t* blockAt(int t, int p, size_t b) { return blocks.data() + t * tileWords + (p * rowBlocks + b) * words; }
+
+    Tile& slot(int t) { return ring[t % 3]; }
+
+    // Population k of column i (any tile in the ring), first cell
+    double* ringColumn(int i, int k) {
+        return slot(i / tileColumns).f.data() + padCells + k * tilePlane + (i % tileColumns) * colStride;
+    }
+
+    static double predict(int k, double r, double x, double y) {
+        double cu = 3.0 * (ex[k] * x + ey[k] * y);
+        double u2 = 1.5 * (x * x + y * y);
+        return w[k] * r * (1.0 + cu + 0.5 * cu * cu - u2);
+    }
+
+    void predictTile(const Tile& s) {
+        for (int k = 0; k < 9; k++) {
+            double* eq = &equilibrium[k * tilePlane];
+            for (size_t c = 0; c < tilePlane; c++) eq[c] = predict(k, s.rho[c], s.ux[c], s.uy[c]);
+        }
+    }
+
+    double decodeValue(int i, int j, int p) const {
+        double v[16];
+        lbm_zfp::decodeBlock(blockAt(i / tileColumns, p, j / 4), layout, v);
+        return v[j % 4 + 4 * (i % tileColumns)];
+    }
+
+    void cellMoments(int i, int j, double* m) const {
+        for (int p = rhoPlane; p <= uyPlane; p++) m[p - rhoPlane] = decodeValue(i, j, p);
+    }
+
+    // Coded value of a cell: plane - bias - base (base may be null)
+    void encodePlane(int t, int p, const double* plane, double bias, const double* base) {
+        double v[16];
+        for (size_t b = 0; b < rowBlocks; b++) {
+            for (int c = 0; c < tileColumns; c++) {
+                for (int r = 0; r < 4; r++) {
+                    size_t cell = c * colStride + 4 * b + r;
+                    v[r + 4 * c] = plane[cell] - bias - (base ? base[cell] : 0.0);
+                }
+            }
+            lbm_zfp::encodeBlock(v, layout, rate, blockAt(t, p, b));
+        }
+    }
+
+    void decodePlane(int t, int p, double* plane, double bias, const double* base) const {
+        double v[16];
+        for (size_t b = 0; b < rowBlocks; b++) {
+            lbm_zfp::decodeBlock(blockAt(t, p, b), layout, v);
+            for (int c = 0; c < tileColumns; c++) {
+                for (int r = 0; r < 4; r++) {
+                    size_t cell = c * colStride + 4 * b + r;
+                    plane[cell] = v[r + 4 * c] + bias + (base ? base[cell] : 0.0);
+                }
+            }
+        }
+    }
+
+    // Stored moments of tile t into s, and their equilibria
+    void loadMoments(int t, Tile& s) {
+        decodePlane(t, rhoPlane, s.rho.data(), 1.0, nullptr);
+        decodePlane(t, uxPlane, s.ux.data(), 0.0, nullptr);
+        decodePlane(t, uyPlane, s.uy.data(), 0.0, nullptr);
+        predictTile(s);
+    }
+
+    // Decompress tile t into its ring slot and collide it
+    void prepareTile(int t) {
+        Tile& s = slot(t);
+        loadMoments(t, s);
+        double* f = s.f.data() + padCells;
+        for (int k = 0; k < 9; k++) decodePlane(t, k, f + k * tilePlane, 0.0, &equilibrium[k * tilePlane]);
+
+        // Solid cells keep LBMSolver's reset moments
+        const uint8_t* solid = &obstacle[idx(t * tileColumns, 0)];
+        for (size_t c = 0; c < tilePlane; c++) {
+            if (solid[c]) {
+                s.rho[c] = 1.0;
+                s.ux[c] = 0.0;
+                s.uy[c] = 0.0;
+            }
+        }
+
+        for (int c = 0; c < tileColumns && t * tileColumns + c < width; c++) collideColumn(s, c, solid + c * colStride);
+    }
+
+    // Compress the streamed tile t with the moments of its collision. The
+    // moments go first and are decoded again, so the populations are coded
+    // against exactly the equilibria prepareTile() will rebuild.
+    void storeTile(int t) {
+        Tile& s = slot(t);
+        encodePlane(t, rhoPlane, s.rho.data(), 1.0, nullptr);
+        encodePlane(t, uxPlane, s.ux.data(), 0.0, nullptr);
+        encodePlane(t, uyPlane, s.uy.data(), 0.0, nullptr);
+        loadMoments(t, s);
+        const double* f = out[t & 1].data() + padCells;
+        for (int k = 0; k < 9; k++) encodePlane(t, k, f + k * tilePlane, 0.0, &equilibrium[k * tilePlane]);
+    }
+
+    // LBMSolver::collideCell() / collideTileSimd() on column c of a tile
+    void collideColumn(Tile& s, int c, const uint8_t* solid) {
+        double* f = s.f.data() + padCells + c * colStride;
+        double* rho = s.rho.data() + c * colStride;
+        double* ux = s.ux.data() + c * colStride;
+        double* uy = s.uy.data() + c * colStride;
+
+        if (kernels.collide) {
+            double* cols[9];
+            for (int k = 0; k < 9; k++) cols[k] = f + k * tilePlane;
+            lbm_kernels::ColumnHealth h;
+            kernels.collide(cols, rho, ux, uy, nullptr, solid, colStride, omega, &h);
+            return;
+        }
+
+        for (int j = 0; j < height; j++) {
+            if (solid[j]) continue;
+            double rho_local = 0.0;
+            double ux_local = 0.0;
+            double uy_local = 0.0;
+
+            for (int k = 0; k < 9; k++) {
+                double fk = f[k * tilePlane + j];
+                rho_local += fk;
+                ux_local += ex[k] * fk;
+                uy_local += ey[k] * fk;
+            }
+
+            ux_local /= rho_local;
+            uy_local /= rho_local;
+            rho[j] = rho_local;
+            ux[j] = ux_local;
+            uy[j] = uy_local;
+
+            double u2 = 1.5 * (ux_local * ux_local + uy_local * uy_local);
+
+            for (int k = 0; k < 9; k++) {
+                double cu = 3.0 * (ex[k] * ux_local + ey[k] * uy_local);
+                double feq = w[k] * rho_local * (1.0 + cu + 0.5 * cu * cu - u2);
+                f[k * tilePlane + j] += omega * (feq - f[k * tilePlane + j]);
+            }
+        }
+    }
+
+    // LBMSolver::streamCellFused() / streamTileSimd() into tile t of `o`;
+    // columns past the width are carried over unchanged
+    void streamTile(int t, double* o) {
+        for (int c = 0; c < tileColumns; c++) {
+            int i = t * tileColumns + c;
+            double* dst[9];
+            const double* own[9];
+            for (int k = 0; k < 9; k++) {
+                dst[k] = o + k * tilePlane + c * colStride;
+                own[k] = ringColumn(i, k);
+            }
+            if (i >= width) {
+                for (int k = 0; k < 9; k++) std::memcpy(dst[k], own[k], colStride * sizeof(double));
+                continue;
+            }
+
+            const uint8_t* solid = &obstacle[idx(i, 0)];
+            if (kernels.stream) {
+                const double* src[9];
+                for (int k = 0; k < 9; k++) {
+                    int iprev = i - ex[k];
+                    src[k] = iprev >= 0 && iprev < width ? ringColumn(iprev, k) - ey[k] : own[k];
+                }
+                kernels.stream(dst, src, own, solid, colStride);
+
+                if (!solid[0]) {
+                    for (int k : {2, 5, 6}) dst[k][0] = own[k][0];
+                }
+                if (!solid[height - 1]) {
+                    for (int k : {4, 7, 8}) dst[k][height - 1] = own[k][height - 1];
+                }
+                continue;
+            }
+
+            for (int j = 0; j < height; j++) {
+                if (solid[j]) {
+                    for (int k = 0; k < 9; k++) dst[k][j] = own[lbm_kernels::opp[k]][j];
+                    continue;
+                }
+                for (int k = 0; k < 9; k++) {
+                    int iprev = i - ex[k];
+                    int jprev = j - ey[k];
+                    if (iprev >= 0 && iprev < width && jprev >= 0 && jprev < height) {
+                        dst[k][j] = ringColumn(iprev, k)[jprev];
+                    } else {
+                        dst[k][j] = own[k][j];
+                    }
+                }
+            }
+        }
+    }
+
+    // LBMSolver::applyInletOutlet() for a uniform inlet and zero-gradient outlet
+    void applyInlet(double* o, double velocity) {
+        for (int j = 0; j < height; j++) {
+            for (int k = 0; k < 9; k++) o[k * tilePlane + j] = predict(k, 1.0, velocity, 0.0);
+        }
+    }
+
+    // Column W - 2 is in the last tile or the one before, whose output is
+    // still in `out`. The walls were already applied to it, which is the
+    // same as copying first: the swap is per column.
+    void applyOutlet() {
+        int last = width - 1;
+        int interior = width - 2;
+        double* dst = out[(last / tileColumns) & 1].data() + padCells + (last % tileColumns) * colStride;
+        const double* src = out[(interior / tileColumns) & 1].data() + padCells + (interior % tileColumns) * colStride;
+        for (int k = 0; k < 9; k++) {
+            std::memcpy(dst + k * tilePlane, src + k * tilePlane, height * sizeof(double));
+        }
+    }
+
+    void applyFreeSlipWalls(int t, double* o) {
+        for (int c = 0; c < tileColumns && t * tileColumns + c < width; c++) {
+            for (size_t cell : {c * colStride, c * colStride + height - 1}) {
+                std::swap(o[2 * tilePlane + cell], o[4 * tilePlane + cell]);
+                std::swap(o[5 * tilePlane + cell], o[8 * tilePlane + cell]);
+                std::swap(o[6 * tilePlane + cell], o[7 * tilePlane + cell]);
+            }
+        }
+    }
+};
@@ -0,0 +1,104 @@
+// Package energy measurement through the Linux powercap (RAPL) sysfs interface
+// Intel and recent AMD CPUs both expose their counters under /sys/class/powercap/intel-rapl:*
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <dirent.h>
+
+class RaplMeter {
+private:
+    struct Domain {
+        std::string name;
+        std::string energyPath;
+        uint64_t maxRange;   // counter wraps at this value (microjoules)
+        uint64_t last;
+        uint64_t accumulated;
+    };
+
+    std::vector<Domain> domains;
+
+    static bool readCounter(const std::string& path, uint64_t& value) {
+        std::ifstream in(path);
+        if (!in) return false;
+        in >> value;
+        return static_cast<bool>(in);
+    }
+
+    static std::string readLine(const std::string& path) {
+        std::ifstream in(path);
+        std::string line;
+        std::getline(in, line);
+        return line;
+    }
+
+public:
+    RaplMeter() {
+        const std::string root = "/sys/class/powercap/";
+        DIR* dir = opendir(root.c_str());
+        if (!dir) return;
+
+        while (dirent* entry = readdir(dir)) {
+            std::string zone = entry->d_name;
+
+            // Only top-level package zones ("intel-rapl:0"); subzones such as
+            // "intel-rapl:0:0" (cores) are already included in their package
+            if (zone.rfind("intel-rapl:", 0) != 0) continue;
+            if (zone.find(':', 11) != std::string::npos) continue;
+
+            std::string base = root + zone + "/";
+            std::string name = readLine(base + "name");
+
+            // psys covers the whole platform and overlaps the packages
+            if (name == "psys") continue;
+
+            Domain d;
+            d.name = name.empty() ? zone : name;
+            d.energyPath = base + "energy_uj";
+            d.accumulated = 0;
+            if (!readCounter(base + "max_energy_range_uj", d.maxRange)) continue;
+            // Counters are root-only on most distributions since CVE-2020-8694
+            if (!readCounter(d.energyPath, d.last)) continue;
+
+            domains.push_back(d);
+        }
+        closedir(dir);
+    }
+
+    bool available() const { return !domains.empty(); }
+
+    std::vector<std::string> domainNames() const {
+        std::vector<std::string> names;
+        for (const Domain& d : domains) names.push_back(d.name);
+        return names;
+    }
+
+    // Start a new measurement interval
+    void begin() {
+        for (Domain& d : domains) {
+            readCounter(d.energyPath, d.last);
+            d.accumulated = 0;
+        }
+    }
+
+    // Fold the counter deltas since the previous call into the running total.
+    // Call at least once per wrap period (tens of seconds at full load).
+    void sample() {
+        for (Domain& d : domains) {
+            uint64_t now;
+            if (!readCounter(d.energyPath, now)) continue;
+            uint64_t delta = now >= d.last ? now - d.last : d.maxRange - d.last + now;
+            d.accumulated += delta;
+            d.last = now;
+        }
+    }
+
+    // Energy of all packages since begin(), in joules
+    double joules() const {
+        uint64_t total = 0;
+        for (const Domain& d : domains) total += d.accumulated;
+        return total * 1e-6;
+    }
+};
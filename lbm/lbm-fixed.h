@@ -0,0 +1,500 @@
+// Fixed-point D2Q9 solver with bit-reproducible results on every platform
+// Populations are stored as integer deviations from the lattice weights,
+// f_k = w_k + F_k * 2^-shift, in int32 (shift 28) or int16 (shift 17, a
+// quarter of LBMSolver's bandwidth, for display). Collision and streaming
+// use integer arithmetic only, so x86, ARM and WebAssembly builds, every
+// SIMD level and every thread count produce the same bits, and a lattice
+// checksum can serve as a regression baseline across machines.
+//
+// The equilibrium is the division-free incompressible form (He & Luo):
+// feq_k = w_k (rho + 3 e.j + 4.5 (e.j)^2 - 1.5 j^2) with j the momentum,
+// which agrees with LBMSolver's to O(Ma^2 (rho - 1)). The relaxation of each
+// population is rounded, then populations 3, 4 and 0 take whatever keeps x
+// momentum, y momentum and mass exactly conserved. The boundaries are
+// LBMSolver's defaults (equilibrium inlet with the velocity ramp,
+// zero-gradient outlet, free-slip walls) and there is no watchdog.
+#pragma once
+
+#include "lbm-solver.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace lbm_fixed {
+
+// Scale of the stored deviations: int16 covers |f - w| < 0.25
+template <typename T>
+struct Format;
+template <>
+struct Format<int32_t> {
+    static constexpr int shift = 28;
+};
+template <>
+struct Format<int16_t> {
+    static constexpr int shift = 17;
+};
+
+constexpr int omegaShift = 15;           // omega in units of 2^-15
+constexpr int weightShift = 24;
+constexpr int64_t inverse36 = 466034;    // round(2^24 / 36)
+constexpr int64_t weight36[9] = {16, 4, 4, 4, 4, 1, 1, 1, 1};  // 36 w_k
+
+template <typename T>
+using CollideFn = void (*)(T* const* f, const uint8_t* solid, size_t n, int64_t omega);
+
+template <typename T>
+struct KernelTable {
+    SimdLevel level;
+    CollideFn<T> collide;
+};
+
+// Equilibrium deviation of population k for density deviation r and
+// momentum (jx, jy), all in units of 2^-shift
+inline int64_t equilibrium(int k, int64_t r, int64_t jx, int64_t jy, int shift) {
+    int64_t ej = lbm_kernels::ex[k] * jx + lbm_kernels::ey[k] * jy;
+    int64_t x = r + 3 * ej + ((9 * ej * ej - 3 * (jx * jx + jy * jy)) >> (shift + 1));
+    return (x * (weight36[k] * inverse36)) >> weightShift;
+}
+
+template <class V, typename T>
+__attribute__((always_inline)) inline V loadLanes(const T* p) {
+    constexpr int lanes = sizeof(V) / sizeof(int64_t);
+    typedef T N __attribute__((vector_size(lanes * sizeof(T))));
+    N v;
+    std::memcpy(&v, p, sizeof(N));
+    return __builtin_convertvector(v, V);
+}
+
+// Saturating store (a diverging run clips instead of wrapping)
+template <class V, typename T>
+__attribute__((always_inline)) inline void storeLanes(T* p, const V& value) {
+    constexpr int lanes = sizeof(V) / sizeof(int64_t);
+    typedef T N __attribute__((vector_size(lanes * sizeof(T))));
+    const V lo = V{} + static_cast<int64_t>(std::numeric_limits<T>::min());
+    const V hi = V{} + static_cast<int64_t>(std::numeric_limits<T>::max());
+    V v = lbm_kernels::select(value < lo, lo, value);
+    v = lbm_kernels::select(v > hi, hi, v);
+    N n = __builtin_convertvector(v, N);
+    std::memcpy(p, &n, sizeof(N));
+}
+
+// BGK collision of n cells in place; solid cells are left untouched. V is a
+// vector of int64 lanes (one lane for the portable path); every lane does
+// the same integer operations, so the lane count does not change the result.
+template <class V, typename T>
+__attribute__((always_inline)) inline void collideColumn(T* const* f, const uint8_t* solid, size_t n,
+                                                         int64_t omega) {
+    constexpr int lanes = sizeof(V) / sizeof(int64_t);
+    constexpr int shift = Format<T>::shift;
+    const V half = V{} + (int64_t(1) << (omegaShift - 1));
+
+    for (size_t j = 0; j < n; j += lanes) {
+        V mask = lbm_kernels::solidMask<V, V>(solid + j);
+
+        V F[9];
+        for (int k = 0; k < 9; k++) F[k] = loadLanes<V, T>(f[k] + j);
+        V r = F[0] + F[1] + F[2] + F[3] + F[4] + F[5] + F[6] + F[7] + F[8];
+        V jx = F[1] - F[3] + F[5] - F[6] - F[7] + F[8];
+        V jy = F[2] - F[4] + F[5] + F[6] - F[7] - F[8];
+        V j2 = 3 * (jx * jx + jy * jy);
+
+        V d[9];
+        for (int k : {1, 2, 5, 6, 7, 8}) {
+            V ej = lbm_kernels::ex[k] * jx + lbm_kernels::ey[k] * jy;
+            V x = r + 3 * ej + ((9 * ej * ej - j2) >> (shift + 1));
+            V feq = (x * (weight36[k] * inverse36)) >> weightShift;
+            d[k] = (omega * (feq - F[k]) + half) >> omegaShift;
+        }
+        d[3] = d[1] + d[5] - d[6] - d[7] + d[8];
+        d[4] = d[2] + d[5] + d[6] - d[7] - d[8];
+        d[0] = -(d[1] + d[2] + d[3] + d[4] + d[5] + d[6] + d[7] + d[8]);
+
+        for (int k = 0; k < 9; k++) storeLanes<V, T>(f[k] + j, lbm_kernels::select(mask, F[k], F[k] + d[k]));
+    }
+}
+
+typedef int64_t q1 __attribute__((vector_size(8)));
+
+template <typename T>
+inline void collidePortable(T* const* f, const uint8_t* solid, size_t n, int64_t omega) {
+    collideColumn<q1, T>(f, solid, n, omega);
+}
+
+#ifdef LBM_X86_KERNELS
+
+typedef int64_t q2 __attribute__((vector_size(16)));
+typedef int64_t q4 __attribute__((vector_size(32)));
+typedef int64_t q8 __attribute__((vector_size(64)));
+
+template <typename T>
+__attribute__((target("sse4.2"))) inline void collideSSE42(T* const* f, const uint8_t* solid, size_t n,
+                                                           int64_t omega) {
+    collideColumn<q2, T>(f, solid, n, omega);
+}
+template <typename T>
+__attribute__((target("avx2"))) inline void collideAVX2(T* const* f, const uint8_t* solid, size_t n,
+                                                        int64_t omega) {
+    collideColumn<q4, T>(f, solid, n, omega);
+}
+template <typename T>
+__attribute__((target("avx512f"))) inline void collideAVX512(T* const* f, const uint8_t* solid, size_t n,
+                                                             int64_t omega) {
+    collideColumn<q8, T>(f, solid, n, omega);
+}
+
+#endif
+
+#ifdef __wasm_simd128__
+
+typedef int64_t wq2 __attribute__((vector_size(16)));
+
+template <typename T>
+inline void collideSIMD128(T* const* f, const uint8_t* solid, size_t n, int64_t omega) {
+    collideColumn<wq2, T>(f, solid, n, omega);
+}
+
+#endif
+
+// Same fallback rules as lbm_kernels::selectKernels(); Scalar is the
+// one-lane instantiation
+template <typename T>
+inline KernelTable<T> selectKernels(SimdLevel level) {
+    if (level == SimdLevel::Auto || !lbm_kernels::simdSupported(level)) level = lbm_kernels::detectSimdLevel();
+
+    KernelTable<T> table = {SimdLevel::Scalar, collidePortable<T>};
+    switch (level) {
+#ifdef LBM_X86_KERNELS
+    case SimdLevel::SSE42:
+        table = {level, collideSSE42<T>};
+        break;
+    case SimdLevel::AVX2:
+        table = {level, collideAVX2<T>};
+        break;
+    case SimdLevel::AVX512:
+        table = {level, collideAVX512<T>};
+        break;
+#endif
+#ifdef __wasm_simd128__
+    case SimdLevel::SIMD128:
+        table = {level, collideSIMD128<T>};
+        break;
+#endif
+    default:
+        break;
+    }
+    return table;
+}
+
+}  // namespace lbm_fixed
+
+template <typename T>
+class LBMFixedSolver {
+public:
+    static constexpr int shift = lbm_fixed::Format<T>::shift;
+
+    LBMFixedSolver(int w, int h) : width(w), height(h), u0(0.15), stepCount(0), totalSteps(0),
+                                   currentGeometry("circle") {
+        if (width < 3 || height < 3) throw std::invalid_argument("lattice must be at least 3x3");
+        colStride = (static_cast<size_t>(height) + padCells - 1) / padCells * padCells;
+        if (colStride > SIZE_MAX / sizeof(T) / 9 / static_cast<size_t>(width)) throw std::bad_alloc();
+        planeStride = colStride * width;
+        fBuffer = AlignedBuffer<T>(9 * planeStride + 2 * padCells);
+        fTempBuffer = AlignedBuffer<T>(9 * planeStride + 2 * padCells);
+        f = fBuffer.data() + padCells;
+        fTemp = fTempBuffer.data() + padCells;
+        obstacle = AlignedBuffer<uint8_t>(planeStride);
+
+        setSimdLevel(SimdLevel::Auto);
+        setViscosity(0.02);
+        reset();
+    }
+
+    // Arena bytes of a width x height solver
+    static uint64_t requiredBytes(int width, int height) {
+        uint64_t plane = (static_cast<uint64_t>(height) + padCells - 1) / padCells * padCells * width;
+        return 2 * AlignedBuffer<T>::bytesFor(9 * plane + 2 * padCells) + AlignedBuffer<uint8_t>::bytesFor(plane);
+    }
+
+    LBMFixedSolver(const LBMFixedSolver&) = delete;
+    LBMFixedSolver& operator=(const LBMFixedSolver&) = delete;
+
+    // omega is rounded to 2^-15; the double arithmetic before it is
+    // correctly rounded IEEE on every platform
+    void setViscosity(double viscosity) {
+        nu = viscosity;
+        omega = std::llround(std::ldexp(1.0 / (3.0 * nu + 0.5), lbm_fixed::omegaShift));
+    }
+
+    void setVelocity(double velocity) { u0 = velocity; }
+    double getViscosity() const { return nu; }
+    double getVelocity() const { return u0; }
+
+    // Results do not depend on either setting
+    void setSimdLevel(SimdLevel level) { kernels = lbm_fixed::selectKernels<T>(level); }
+    SimdLevel getSimdLevel() const { return kernels.level; }
+
+    void setThreads(int threads) {
+        threads = std::max(1, std::min(threads, 256));
+        if (threads > 1) {
+            if (!pool || pool->size() != threads) pool.reset(new ThreadPool(threads));
+        } else {
+            pool.reset();
+        }
+    }
+
+    int getThreads() const { return pool ? pool->size() : 1; }
+
+    void setGeometry(const std::string& geom) {
+        currentGeometry = geom;
+        reset();
+    }
+
+    std::string getGeometry() const { return currentGeometry; }
+
+    // Same as LBMSolver::setSolid(): cleared again by reset()
+    void setSolid(int i, int j, bool solid) { obstacle[idx(i, j)] = solid ? 1 : 0; }
+    bool solid(int i, int j) const { return obstacle[idx(i, j)] != 0; }
+
+    // Equilibrium at rest: every deviation is zero
+    void reset() {
+        stepCount = 0;
+        totalSteps = 0;
+        std::fill(fBuffer.data(), fBuffer.data() + 9 * planeStride + 2 * padCells, T(0));
+        std::fill(fTempBuffer.data(), fTempBuffer.data() + 9 * planeStride + 2 * padCells, T(0));
+        for (int i = 0; i < width; i++) {
+            for (size_t j = 0; j < colStride; j++) obstacle[idx(i, 0) + j] = j < static_cast<size_t>(height) ? 0 : 1;
+        }
+        LBMSolver::rasterizeGeometry(currentGeometry, width, height,
+                                     [this](int i, int j) { obstacle[idx(i, j)] = 1; });
+    }
+
+    void step() {
+        double velocity = u0;
+        if (stepCount < rampUpSteps) {
+            velocity = u0 * static_cast<double>(stepCount) / rampUpSteps;
+            stepCount++;
+        }
+
+        forColumns([this](int i) { collideColumn(i); });
+        forColumns([this](int i) { streamColumn(i); });
+        std::swap(f, fTemp);
+        applyInlet(std::llround(std::ldexp(velocity, shift)));
+        applyOutlet();
+        applyFreeSlipWalls();
+        totalSteps++;
+    }
+
+    int getStepCount() const { return totalSteps; }
+
+    // Stored value of population k (w_k + raw * 2^-shift)
+    T raw(int i, int j, int k) const { return f[k * planeStride + idx(i, j)]; }
+
+    double distribution(int i, int j, int k) const { return w[k] + std::ldexp(raw(i, j, k), -shift); }
+
+    // Moments of the current populations
+    double density(int i, int j) const { return 1.0 + std::ldexp(static_cast<double>(moment(i, j, nullptr)), -shift); }
+    double velocityX(int i, int j) const { return std::ldexp(static_cast<double>(moment(i, j, ex)), -shift) / density(i, j); }
+    double velocityY(int i, int j) const { return std::ldexp(static_cast<double>(moment(i, j, ey)), -shift) / density(i, j); }
+
+    // FNV-1a over every population of every cell, as 64-bit integers in
+    // little-endian order: equal checksums mean identical lattices
+    uint64_t checksum() const {
+        uint64_t hash = 1469598103934665603ull;
+        for (int k = 0; k < 9; k++) {
+            for (int i = 0; i < width; i++) {
+                for (int j = 0; j < height; j++) {
+                    uint64_t v = static_cast<uint64_t>(static_cast<int64_t>(raw(i, j, k)));
+                    for (int b = 0; b < 8; b++) {
+                        hash ^= (v >> (8 * b)) & 0xff;
+                        hash *= 1099511628211ull;
+                    }
+                }
+            }
+        }
+        return hash;
+    }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    size_t getLatticeBytes() const { return 2 * 9 * planeStride * sizeof(T); }
+
+#ifdef __EMSCRIPTEN__
+    // checksum() as 16 hex digits (embind has no plain 64-bit integers)
+    std::string getChecksum() const {
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(checksum()));
+        return hex;
+    }
+
+    // Same fields as LBMSolver's getters, from the current populations
+    val getVelocityMagnitude() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                double x = solid(i, j) ? 0.0 : velocityX(i, j);
+                double y = solid(i, j) ? 0.0 : velocityY(i, j);
+                result.call<void>("push", sqrt(x * x + y * y));
+            }
+        }
+        return result;
+    }
+
+    val getVorticity() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                double omega_z = 0.0;
+                if (i > 0 && i < width - 1 && j > 0 && j < height - 1) {
+                    omega_z = (fluidVelocityY(i + 1, j) - fluidVelocityY(i - 1, j)) / 2.0 -
+                              (fluidVelocityX(i, j + 1) - fluidVelocityX(i, j - 1)) / 2.0;
+                }
+                result.call<void>("push", omega_z);
+            }
+        }
+        return result;
+    }
+
+    val getPressure() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) result.call<void>("push", solid(i, j) ? 1.0 / 3.0 : density(i, j) / 3.0);
+        }
+        return result;
+    }
+
+    val getObstacle() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) result.call<void>("push", solid(i, j));
+        }
+        return result;
+    }
+
+    val getUx() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) result.call<void>("push", fluidVelocityX(i, j));
+        }
+        return result;
+    }
+
+    val getUy() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) result.call<void>("push", fluidVelocityY(i, j));
+        }
+        return result;
+    }
+#endif
+
+private:
+    static constexpr int ex[9] = {0, 1, 0, -1, 0, 1, -1, -1, 1};
+    static constexpr int ey[9] = {0, 0, 1, 0, -1, 1, 1, -1, -1};
+    static constexpr double w[9] = {4.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0,
+                                     1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0};
+    static constexpr size_t padCells = 8;
+    static constexpr int rampUpSteps = 500;
+
+    int width, height;
+    double nu, u0;
+    int64_t omega;   // 2^-15 units
+    int stepCount;   // ramp position, as in LBMSolver
+    int totalSteps;
+    std::string currentGeometry;
+    size_t colStride;
+    size_t planeStride;
+
+    AlignedBuffer<T> fBuffer, fTempBuffer;
+    T* f;
+    T* fTemp;
+    AlignedBuffer<uint8_t> obstacle;
+
+    std::shared_ptr<ThreadPool> pool;
+    lbm_fixed::KernelTable<T> kernels;
+
+    size_t idx(int i, int j) const { return static_cast<size_t>(i) * colStride + j; }
+
+    int64_t moment(int i, int j, const int* e) const {
+        int64_t m = 0;
+        for (int k = 0; k < 9; k++) m += (e ? e[k] : 1) * static_cast<int64_t>(raw(i, j, k));
+        return m;
+    }
+
+    double fluidVelocityX(int i, int j) const { return solid(i, j) ? 0.0 : velocityX(i, j); }
+    double fluidVelocityY(int i, int j) const { return solid(i, j) ? 0.0 : velocityY(i, j); }
+
+    template <typename F>
+    void forColumns(F body) {
+        if (!pool) {
+            for (int i = 0; i < width; i++) body(i);
+            return;
+        }
+        int tasks = std::min(width, pool->size());
+        pool->run(tasks, [&](int task) {
+            int begin = static_cast<int>(static_cast<long long>(width) * task / tasks);
+            int end = static_cast<int>(static_cast<long long>(width) * (task + 1) / tasks);
+            for (int i = begin; i < end; i++) body(i);
+        });
+    }
+
+    void collideColumn(int i) {
+        T* cols[9];
+        for (int k = 0; k < 9; k++) cols[k] = f + k * planeStride + idx(i, 0);
+        kernels.collide(cols, &obstacle[idx(i, 0)], colStride, omega);
+    }
+
+    // Pull streaming with bounce-back in solid cells; plain integer copies,
+    // which the compiler vectorises
+    void streamColumn(int i) {
+        const uint8_t* solid = &obstacle[idx(i, 0)];
+        size_t c = idx(i, 0);
+        for (int k = 0; k < 9; k++) {
+            int iprev = i - ex[k];
+            T* dst = fTemp + k * planeStride + c;
+            const T* own = f + k * planeStride + c;
+            const T* bounced = f + lbm_kernels::opp[k] * planeStride + c;
+            const T* src = iprev >= 0 && iprev < width ? f + k * planeStride + idx(iprev, 0) - ey[k] : own;
+            for (size_t j = 0; j < colStride; j++) dst[j] = solid[j] ? bounced[j] : src[j];
+
+            // Nothing streams in across the top and bottom rows
+            if (ey[k] > 0 && !solid[0]) dst[0] = own[0];
+            if (ey[k] < 0 && !solid[height - 1]) dst[height - 1] = own[height - 1];
+        }
+    }
+
+    void applyInlet(int64_t jx) {
+        T column[9];
+        for (int k = 0; k < 9; k++) {
+            int64_t v = lbm_fixed::equilibrium(k, 0, jx, 0, shift);
+            column[k] = static_cast<T>(std::max<int64_t>(std::numeric_limits<T>::min(),
+                                                         std::min<int64_t>(std::numeric_limits<T>::max(), v)));
+        }
+        for (int j = 0; j < height; j++) {
+            for (int k = 0; k < 9; k++) f[k * planeStride + idx(0, j)] = column[k];
+        }
+    }
+
+    void applyOutlet() {
+        for (int k = 0; k < 9; k++) {
+            std::memcpy(f + k * planeStride + idx(width - 1, 0), f + k * planeStride + idx(width - 2, 0),
+                        height * sizeof(T));
+        }
+    }
+
+    void applyFreeSlipWalls() {
+        for (int i = 0; i < width; i++) {
+            for (size_t c : {idx(i, 0), idx(i, height - 1)}) {
+                std::swap(f[2 * planeStride + c], f[4 * planeStride + c]);
+                std::swap(f[5 * planeStride + c], f[8 * planeStride + c]);
+                std::swap(f[6 * planeStride + c], f[7 * planeStride + c]);
+            }
+        }
+    }
+};
+
+typedef LBMFixedSolver<int32_t> LBMFixedSolver32;
+typedef LBMFixedSolver<int16_t> LBMFixedSolver16;
@@ -0,0 +1,383 @@
+// Vectorised D2Q9 column kernels with runtime CPU feature dispatch
+//
+// Each kernel is one template written with GCC/Clang vector extensions and
+// instantiated inside functions carrying a target attribute, so a single
+// binary built for baseline x86-64 contains SSE4.2, AVX2+FMA and AVX-512
+// code paths. selectKernels() picks the widest one the CPU supports.
+// WebAssembly builds compiled with -msimd128 get a SIMD128 instantiation.
+//
+// Kernels work on one lattice column at a time. Columns are padded to a
+// multiple of 8 cells (64 bytes) and padding cells are flagged as solid,
+// so every loop runs whole vectors with aligned stores.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define LBM_X86_KERNELS 1
+#endif
+
+enum class SimdLevel {
+    Auto = -1,   // widest level supported by the CPU
+    Scalar = 0,  // reference per-cell kernels in LBMSolver
+    SSE42 = 1,
+    AVX2 = 2,    // AVX2 + FMA
+    AVX512 = 3,  // AVX-512F
+    SIMD128 = 4  // WebAssembly SIMD (module built with -msimd128)
+};
+
+// The helpers below take and return wide vectors by value; they are always
+// inlined into target-specific functions, so the ABI note does not apply.
+// GCC reports it at the end of the translation unit, hence no push/pop.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace lbm_kernels {
+
+// Planes of one column: p[k] points at population k of the column's first cell
+typedef double* const* Planes;
+typedef const double* const* ConstPlanes;
+
+// Per-column summary written by the collision pass, read by the watchdog
+struct ColumnHealth {
+    double minRho;  // smallest fluid density
+    double maxU2;   // largest ux^2 + uy^2
+    double probe;   // sum of rho + u^2 over fluid cells: NaN/Inf if any cell is
+};
+
+// strain may be null; otherwise it receives the strain-rate magnitude
+typedef void (*CollideFn)(Planes f, double* rho, double* ux, double* uy, double* strain,
+                          const uint8_t* solid, size_t n, double omega, ColumnHealth* health);
+typedef void (*StreamFn)(Planes dst, ConstPlanes src, ConstPlanes own,
+                         const uint8_t* solid, size_t n);
+
+struct KernelTable {
+    SimdLevel level;
+    CollideFn collide;
+    StreamFn stream;      // regular stores
+    StreamFn streamNT;    // non-temporal stores, bypassing the cache
+};
+
+constexpr int ex[9] = {0, 1, 0, -1, 0, 1, -1, -1, 1};
+constexpr int ey[9] = {0, 0, 1, 0, -1, 1, 1, -1, -1};
+constexpr double w[9] = {4.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0,
+                         1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0};
+constexpr int opp[9] = {0, 3, 4, 1, 2, 7, 8, 5, 6};
+
+// Distance (in cells) of the software prefetch ahead of the streaming reads
+constexpr size_t prefetchDistance = 64;
+
+template <class V>
+__attribute__((always_inline)) inline V load(const double* p) {
+    V v;
+    std::memcpy(&v, p, sizeof(V));
+    return v;
+}
+
+template <class V>
+__attribute__((always_inline)) inline void store(double* p, const V& v) {
+    std::memcpy(p, &v, sizeof(V));
+}
+
+// All-ones lanes where the cell is solid
+template <class V, class M>
+__attribute__((always_inline)) inline M solidMask(const uint8_t* solid) {
+    constexpr int lanes = sizeof(V) / sizeof(double);
+    M m;
+    for (int l = 0; l < lanes; l++) m[l] = solid[l] ? -1 : 0;
+    return m;
+}
+
+template <class V, class M>
+__attribute__((always_inline)) inline V select(const M& mask, const V& a, const V& b) {
+    return (V)(((M)a & mask) | ((M)b & ~mask));
+}
+
+// BGK collision of n cells in place; solid cells are left untouched.
+// The arithmetic mirrors LBMSolver::collideCell term by term. The column's
+// density/velocity extremes are gathered on the way for the watchdog. With
+// Strain, the non-equilibrium second moments give the strain rate
+// S = -3 omega / (2 rho) * sum (f - feq) e e, and |S| = sqrt(2 S:S) is
+// stored per cell; Root supplies the vector square root.
+template <class V, class M, class Root, bool Strain>
+__attribute__((always_inline)) inline void collideColumn(Planes f, double* rho, double* ux, double* uy,
+                                                         double* strain, const uint8_t* solid, size_t n,
+                                                         double omega, ColumnHealth* health) {
+    constexpr int lanes = sizeof(V) / sizeof(double);
+    const V zero = {};
+    const V one = zero + 1.0;
+    V minRho = zero + INFINITY;
+    V maxU2 = zero;
+    V probe = zero;
+
+    for (size_t j = 0; j < n; j += lanes) {
+        M mask = solidMask<V, M>(solid + j);
+
+        V fk[9];
+        V rho_local = zero;
+        V ux_local = zero;
+        V uy_local = zero;
+        for (int k = 0; k < 9; k++) {
+            fk[k] = load<V>(f[k] + j);
+            rho_local += fk[k];
+            ux_local += static_cast<double>(ex[k]) * fk[k];
+            uy_local += static_cast<double>(ey[k]) * fk[k];
+        }
+
+        ux_local /= rho_local;
+        uy_local /= rho_local;
+
+        store(rho + j, select(mask, load<V>(rho + j), rho_local));
+        store(ux + j, select(mask, load<V>(ux + j), ux_local));
+        store(uy + j, select(mask, load<V>(uy + j), uy_local));
+
+        V u2 = 1.5 * (ux_local * ux_local + uy_local * uy_local);
+
+        minRho = select(mask | (M)(rho_local >= minRho), minRho, rho_local);
+        maxU2 = select(mask | (M)(u2 <= maxU2), maxU2, u2);
+        probe += select(mask, zero, rho_local + u2);
+
+        for (int k = 0; k < 9; k++) {
+            V cu = 3.0 * (static_cast<double>(ex[k]) * ux_local + static_cast<double>(ey[k]) * uy_local);
+            V feq = w[k] * rho_local * (one + cu + 0.5 * cu * cu - u2);
+            V updated = fk[k] + omega * (feq - fk[k]);
+            store(f[k] + j, select(mask, fk[k], updated));
+        }
+
+        if (Strain) {
+            // Second moments of f minus those of feq (rho/3 + rho u u)
+            V diagonal = fk[5] + fk[6] + fk[7] + fk[8];
+            V pxx = fk[1] + fk[3] + diagonal - rho_local * (ux_local * ux_local + 1.0 / 3.0);
+            V pyy = fk[2] + fk[4] + diagonal - rho_local * (uy_local * uy_local + 1.0 / 3.0);
+            V pxy = fk[5] - fk[6] + fk[7] - fk[8] - rho_local * ux_local * uy_local;
+            V scale = (-1.5 * omega) / rho_local;
+            V sxx = scale * pxx, syy = scale * pyy, sxy = scale * pxy;
+            V s2 = 2.0 * (sxx * sxx + syy * syy + 2.0 * sxy * sxy);
+            store(strain + j, select(mask, load<V>(strain + j), Root::sqrt(s2)));
+        }
+    }
+
+    ColumnHealth h = {INFINITY, 0.0, 0.0};
+    for (int l = 0; l < lanes; l++) {
+        h.minRho = std::min(h.minRho, minRho[l]);
+        h.maxU2 = std::max(h.maxU2, maxU2[l] / 1.5);
+        h.probe += probe[l];
+    }
+    *health = h;
+}
+
+// Pull streaming of n cells: dst[k][j] = src[k][j] for fluid cells and the
+// cell's own opposite population (bounce-back) for solid cells.
+// src[k] is already offset so that src[k][j] is the upstream neighbour.
+template <class V, class M, class Store>
+__attribute__((always_inline)) inline void streamColumn(Planes dst, ConstPlanes src, ConstPlanes own,
+                                                        const uint8_t* solid, size_t n) {
+    constexpr int lanes = sizeof(V) / sizeof(double);
+
+    for (size_t j = 0; j < n; j += lanes) {
+        M mask = solidMask<V, M>(solid + j);
+        for (int k = 0; k < 9; k++) {
+            __builtin_prefetch(src[k] + j + prefetchDistance);
+            V pulled = load<V>(src[k] + j);
+            V bounced = load<V>(own[opp[k]] + j);
+            Store::put(dst[k] + j, select(mask, bounced, pulled));
+        }
+    }
+}
+
+#ifdef LBM_X86_KERNELS
+
+typedef double v2d __attribute__((vector_size(16)));
+typedef long long v2m __attribute__((vector_size(16)));
+typedef double v4d __attribute__((vector_size(32)));
+typedef long long v4m __attribute__((vector_size(32)));
+typedef double v8d __attribute__((vector_size(64)));
+typedef long long v8m __attribute__((vector_size(64)));
+
+struct StoreSSE42 {
+    __attribute__((target("sse4.2"))) static inline void put(double* p, v2d v) { store(p, v); }
+};
+struct StreamSSE42 {
+    __attribute__((target("sse4.2"))) static inline void put(double* p, v2d v) { _mm_stream_pd(p, (__m128d)v); }
+};
+struct StoreAVX2 {
+    __attribute__((target("avx2,fma"))) static inline void put(double* p, v4d v) { store(p, v); }
+};
+struct StreamAVX2 {
+    __attribute__((target("avx2,fma"))) static inline void put(double* p, v4d v) { _mm256_stream_pd(p, (__m256d)v); }
+};
+struct StoreAVX512 {
+    __attribute__((target("avx512f"))) static inline void put(double* p, v8d v) { store(p, v); }
+};
+struct StreamAVX512 {
+    __attribute__((target("avx512f"))) static inline void put(double* p, v8d v) { _mm512_stream_pd(p, (__m512d)v); }
+};
+
+struct RootSSE42 {
+    __attribute__((target("sse4.2"))) static inline v2d sqrt(v2d v) { return (v2d)_mm_sqrt_pd((__m128d)v); }
+};
+struct RootAVX2 {
+    __attribute__((target("avx2,fma"))) static inline v4d sqrt(v4d v) { return (v4d)_mm256_sqrt_pd((__m256d)v); }
+};
+struct RootAVX512 {
+    __attribute__((target("avx512f"))) static inline v8d sqrt(v8d v) { return (v8d)_mm512_sqrt_pd((__m512d)v); }
+};
+
+__attribute__((target("sse4.2"))) inline void collideSSE42(Planes f, double* rho, double* ux, double* uy,
+                                                           double* strain, const uint8_t* solid, size_t n,
+                                                           double omega, ColumnHealth* health) {
+    if (strain) collideColumn<v2d, v2m, RootSSE42, true>(f, rho, ux, uy, strain, solid, n, omega, health);
+    else collideColumn<v2d, v2m, RootSSE42, false>(f, rho, ux, uy, strain, solid, n, omega, health);
+}
+__attribute__((target("sse4.2"))) inline void streamSSE42(Planes dst, ConstPlanes src, ConstPlanes own,
+                                                          const uint8_t* solid, size_t n) {
+    streamColumn<v2d, v2m, StoreSSE42>(dst, src, own, solid, n);
+}
+__attribute__((target("sse4.2"))) inline void streamNTSSE42(Planes dst, ConstPlanes src, ConstPlanes own,
+                                                            const uint8_t* solid, size_t n) {
+    streamColumn<v2d, v2m, StreamSSE42>(dst, src, own, solid, n);
+}
+
+__attribute__((target("avx2,fma"))) inline void collideAVX2(Planes f, double* rho, double* ux, double* uy,
+                                                            double* strain, const uint8_t* solid, size_t n,
+                                                            double omega, ColumnHealth* health) {
+    if (strain) collideColumn<v4d, v4m, RootAVX2, true>(f, rho, ux, uy, strain, solid, n, omega, health);
+    else collideColumn<v4d, v4m, RootAVX2, false>(f, rho, ux, uy, strain, solid, n, omega, health);
+}
+__attribute__((target("avx2,fma"))) inline void streamAVX2(Planes dst, ConstPlanes src, ConstPlanes own,
+                                                           const uint8_t* solid, size_t n) {
+    streamColumn<v4d, v4m, StoreAVX2>(dst, src, own, solid, n);
+}
+__attribute__((target("avx2,fma"))) inline void streamNTAVX2(Planes dst, ConstPlanes src, ConstPlanes own,
+                                                             const uint8_t* solid, size_t n) {
+    streamColumn<v4d, v4m, StreamAVX2>(dst, src, own, solid, n);
+}
+
+__attribute__((target("avx512f"))) inline void collideAVX512(Planes f, double* rho, double* ux, double* uy,
+                                                             double* strain, const uint8_t* solid, size_t n,
+                                                             double omega, ColumnHealth* health) {
+    if (strain) collideColumn<v8d, v8m, RootAVX512, true>(f, rho, ux, uy, strain, solid, n, omega, health);
+    else collideColumn<v8d, v8m, RootAVX512, false>(f, rho, ux, uy, strain, solid, n, omega, health);
+}
+__attribute__((target("avx512f"))) inline void streamAVX512(Planes dst, ConstPlanes src, ConstPlanes own,
+                                                            const uint8_t* solid, size_t n) {
+    streamColumn<v8d, v8m, StoreAVX512>(dst, src, own, solid, n);
+}
+__attribute__((target("avx512f"))) inline void streamNTAVX512(Planes dst, ConstPlanes src, ConstPlanes own,
+                                                              const uint8_t* solid, size_t n) {
+    streamColumn<v8d, v8m, StreamAVX512>(dst, src, own, solid, n);
+}
+
+#endif
+
+#ifdef __wasm_simd128__
+
+typedef double w2d __attribute__((vector_size(16)));
+typedef long long w2m __attribute__((vector_size(16)));
+
+// WebAssembly has no non-temporal stores; both tables use plain stores
+struct StoreSIMD128 {
+    static inline void put(double* p, w2d v) { store(p, v); }
+};
+struct RootSIMD128 {
+    static inline w2d sqrt(w2d v) { return w2d{__builtin_sqrt(v[0]), __builtin_sqrt(v[1])}; }
+};
+
+inline void collideSIMD128(Planes f, double* rho, double* ux, double* uy,
+                           double* strain, const uint8_t* solid, size_t n,
+                           double omega, ColumnHealth* health) {
+    if (strain) collideColumn<w2d, w2m, RootSIMD128, true>(f, rho, ux, uy, strain, solid, n, omega, health);
+    else collideColumn<w2d, w2m, RootSIMD128, false>(f, rho, ux, uy, strain, solid, n, omega, health);
+}
+inline void streamSIMD128(Planes dst, ConstPlanes src, ConstPlanes own,
+                          const uint8_t* solid, size_t n) {
+    streamColumn<w2d, w2m, StoreSIMD128>(dst, src, own, solid, n);
+}
+
+#endif
+
+inline bool simdSupported(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar:
+        return true;
+#ifdef LBM_X86_KERNELS
+    case SimdLevel::SSE42:
+        return __builtin_cpu_supports("sse4.2");
+    case SimdLevel::AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case SimdLevel::AVX512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+#ifdef __wasm_simd128__
+    case SimdLevel::SIMD128:
+        return true;  // the module would not have validated otherwise
+#endif
+    default:
+        return false;
+    }
+}
+
+// Widest supported level (cpuid via __builtin_cpu_supports on x86)
+inline SimdLevel detectSimdLevel() {
+    for (SimdLevel level : {SimdLevel::AVX512, SimdLevel::AVX2, SimdLevel::SSE42, SimdLevel::SIMD128}) {
+        if (simdSupported(level)) return level;
+    }
+    return SimdLevel::Scalar;
+}
+
+// Kernel table for a level; falls back to the widest supported level.
+// collide/stream are null for SimdLevel::Scalar (LBMSolver's own loops).
+inline KernelTable selectKernels(SimdLevel level) {
+    if (level == SimdLevel::Auto || !simdSupported(level)) level = detectSimdLevel();
+
+    KernelTable table = {SimdLevel::Scalar, nullptr, nullptr, nullptr};
+    switch (level) {
+#ifdef LBM_X86_KERNELS
+    case SimdLevel::SSE42:
+        table = {level, collideSSE42, streamSSE42, streamNTSSE42};
+        break;
+    case SimdLevel::AVX2:
+        table = {level, collideAVX2, streamAVX2, streamNTAVX2};
+        break;
+    case SimdLevel::AVX512:
+        table = {level, collideAVX512, streamAVX512, streamNTAVX512};
+        break;
+#endif
+#ifdef __wasm_simd128__
+    case SimdLevel::SIMD128:
+        table = {level, collideSIMD128, streamSIMD128, streamSIMD128};
+        break;
+#endif
+    default:
+        break;
+    }
+    return table;
+}
+
+// Order non-temporal stores before the lattice is read by other threads
+inline void storeFence() {
+#ifdef LBM_X86_KERNELS
+    _mm_sfence();
+#endif
+}
+
+inline const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Auto: return "auto";
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::SSE42: return "sse4.2";
+    case SimdLevel::AVX2: return "avx2";
+    case SimdLevel::AVX512: return "avx512";
+    case SimdLevel::SIMD128: return "simd128";
+    }
+    return "unknown";
+}
+
+}  // namespace lbm_kernels
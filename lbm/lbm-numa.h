@@ -0,0 +1,167 @@
+// NUMA topology and thread pinning for the native thread pool (Linux)
+// On a multi-socket machine each thread should step columns that live in its
+// own socket's memory. LBMSolver initialises the lattice with the same static
+// tile partition it steps with, so pages are first touched (and therefore
+// placed) by the thread that will use them; pinning keeps each pool thread on
+// the socket its pages went to. Elsewhere (WASM, other systems) the topology
+// is a single node and pinning does nothing.
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#define LBM_NUMA 1
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <cstdio>
+#include <cstdlib>
+#endif
+
+// Where StepConfig::threads pool threads run
+enum class ThreadPinning {
+    Off = 0,      // wherever the OS schedules them
+    Compact = 1,  // fill the first socket's cores before using the next
+    Spread = 2    // split evenly across sockets, contiguous tiles per socket
+};
+
+namespace lbm_numa {
+
+// CPUs this process may run on, grouped by NUMA node
+struct Topology {
+    std::vector<std::vector<int>> nodes;
+
+    int cpuCount() const {
+        int n = 0;
+        for (const std::vector<int>& node : nodes) n += static_cast<int>(node.size());
+        return n;
+    }
+};
+
+#ifdef LBM_NUMA
+// Parse a sysfs cpulist such as "0-15,32-47"
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    const char* p = list.c_str();
+    while (*p) {
+        char* end;
+        long first = strtol(p, &end, 10);
+        if (end == p) break;
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        for (long c = first; c <= last; c++) cpus.push_back(static_cast<int>(c));
+        while (*p == ',' || *p == '\n' || *p == ' ') p++;
+    }
+    return cpus;
+}
+
+// The affinity mask at first use, before any pool thread was pinned
+inline const cpu_set_t& processCpus() {
+    static cpu_set_t allowed = [] {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+            for (int c = 0; c < CPU_SETSIZE; c++) CPU_SET(c, &set);
+        }
+        return set;
+    }();
+    return allowed;
+}
+#endif
+
+inline Topology detectTopology() {
+    Topology t;
+#ifdef LBM_NUMA
+    const cpu_set_t& allowed = processCpus();
+    DIR* dir = opendir("/sys/devices/system/node");
+    std::vector<int> nodeIds;
+    if (dir) {
+        while (dirent* e = readdir(dir)) {
+            int id;
+            char tail;
+            if (sscanf(e->d_name, "node%d%c", &id, &tail) == 1) nodeIds.push_back(id);
+        }
+        closedir(dir);
+    }
+    std::sort(nodeIds.begin(), nodeIds.end());
+
+    for (int id : nodeIds) {
+        std::string path = "/sys/devices/system/node/node" + std::to_string(id) + "/cpulist";
+        FILE* f = fopen(path.c_str(), "r");
+        if (!f) continue;
+        char buf[4096] = {0};
+        size_t n = fread(buf, 1, sizeof(buf) - 1, f);
+        fclose(f);
+        std::vector<int> cpus;
+        for (int c : parseCpuList(std::string(buf, n))) {
+            if (c >= 0 && c < CPU_SETSIZE && CPU_ISSET(c, &allowed)) cpus.push_back(c);
+        }
+        if (!cpus.empty()) t.nodes.push_back(cpus);
+    }
+
+    if (t.nodes.empty()) {
+        std::vector<int> cpus;
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &allowed)) cpus.push_back(c);
+        }
+        t.nodes.push_back(cpus);
+    }
+#else
+    t.nodes.push_back({0});
+#endif
+    return t;
+}
+
+// Read once per process
+inline const Topology& systemTopology() {
+    static const Topology topology = detectTopology();
+    return topology;
+}
+
+// CPU for each pool participant (participant p steps the p-th block of
+// tiles); empty for ThreadPinning::Off. More threads than CPUs wrap around.
+inline std::vector<int> pinningCpus(ThreadPinning pinning, int threads, const Topology& t) {
+    std::vector<int> cpus;
+    if (pinning == ThreadPinning::Off || t.cpuCount() == 0) return cpus;
+
+    if (pinning == ThreadPinning::Compact) {
+        std::vector<int> all;
+        for (const std::vector<int>& node : t.nodes) all.insert(all.end(), node.begin(), node.end());
+        for (int p = 0; p < threads; p++) cpus.push_back(all[p % all.size()]);
+        return cpus;
+    }
+
+    // Spread: participants [p0, p1) of node n are consecutive, so each
+    // socket owns a contiguous range of columns
+    int nodes = static_cast<int>(t.nodes.size());
+    for (int p = 0; p < threads; p++) {
+        int n = static_cast<int>(static_cast<long long>(p) * nodes / threads);
+        int first = static_cast<int>((static_cast<long long>(n) * threads + nodes - 1) / nodes);
+        const std::vector<int>& node = t.nodes[n];
+        cpus.push_back(node[(p - first) % node.size()]);
+    }
+    return cpus;
+}
+
+// Pin the calling thread to one CPU (cpu < 0: back to the process mask)
+inline bool pinCurrentThread(int cpu) {
+#ifdef LBM_NUMA
+    cpu_set_t set = processCpus();
+    if (cpu >= 0) {
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+}  // namespace lbm_numa
@@ -0,0 +1,524 @@
+// Out-of-core D2Q9 solver for lattices whose populations exceed memory
+// (native builds, POSIX only). The populations live in two memory-mapped
+// files, each holding the 9 planes in LBMSolver's layout (column i of plane k
+// at k * planeStride + i * colStride): one holds time t, the other receives
+// time t + T. A pass sweeps the x-slabs of the lattice in order. For each
+// slab [a, b) it copies columns [a - T, b + T) into an in-memory window,
+// advances the window T steps (each step leaves one fewer valid column on
+// each interior side), writes columns [a, b) to the other file and swaps the
+// files at the end of the pass. So every population is read and written once
+// per T steps instead of once per step. While a slab is computed, the next
+// window is prefetched (madvise WILLNEED starts an asynchronous read) and the
+// pages of the previous slab are handed back to the kernel for write-back.
+//
+// Only the obstacle mask (one byte per cell) stays in memory. The physics is
+// LBMSolver::step() with the default BoundaryConfig (equilibrium inlet with
+// the velocity ramp, zero-gradient outlet, free-slip walls) and no watchdog;
+// the kernels are LBMSolver's, so with the same SIMD level the populations
+// match an in-core run bit for bit (checked by lbm-verify).
+//
+// The files are unlinked right after creation: disk space is returned when
+// the solver is destroyed or the process dies.
+#pragma once
+
+#include "lbm-solver.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+struct OutOfCoreConfig {
+    int slabWidth = 256;      // columns written per slab
+    int temporalSteps = 8;    // steps advanced per pass over the files
+    int threads = 1;          // split each window sweep across a pool
+    SimdLevel simd = SimdLevel::Auto;
+};
+
+// File traffic since construction
+struct OutOfCoreStats {
+    double bytesRead = 0.0;     // window loads, halo columns included
+    double bytesWritten = 0.0;
+    int passes = 0;
+};
+
+class LBMOutOfCore {
+public:
+    // directory: where the two population files are created (needs
+    // 2 * 9 * 8 * width * colStride bytes of free space)
+    LBMOutOfCore(int w, int h, const std::string& directory, OutOfCoreConfig c = OutOfCoreConfig())
+        : width(w), height(h), u0(0.15), stepCount(0), totalSteps(0), currentGeometry("circle") {
+        if (width < 3 || height < 3) throw std::invalid_argument("lattice must be at least 3x3");
+        colStride = (static_cast<size_t>(height) + padCells - 1) / padCells * padCells;
+        if (colStride > SIZE_MAX / sizeof(double) / 9 / static_cast<size_t>(width)) throw std::bad_alloc();
+        planeStride = colStride * width;
+        obstacle = AlignedBuffer<uint8_t>(planeStride);
+
+        fileBytes = 9 * planeStride * sizeof(double);
+        current = mapFile(directory);
+        next = mapFile(directory);
+
+        setConfig(c);
+        setViscosity(0.02);
+        reset();
+    }
+
+    ~LBMOutOfCore() {
+        unmap(current);
+        unmap(next);
+    }
+
+    LBMOutOfCore(const LBMOutOfCore&) = delete;
+    LBMOutOfCore& operator=(const LBMOutOfCore&) = delete;
+
+    void setViscosity(double viscosity) {
+        nu = viscosity;
+        omega = 1.0 / (3.0 * nu + 0.5);
+    }
+
+    void setVelocity(double velocity) { u0 = velocity; }
+    double getViscosity() const { return nu; }
+    double getVelocity() const { return u0; }
+
+    // Slabs are at least 2 columns wide, so the window of the last slab
+    // always holds the column the outlet copies from
+    void setConfig(OutOfCoreConfig c) {
+        c.slabWidth = std::max(2, std::min(c.slabWidth, width));
+        c.temporalSteps = std::max(1, c.temporalSteps);
+        c.threads = std::max(1, std::min(c.threads, 256));
+        kernels = lbm_kernels::selectKernels(c.simd);
+        c.simd = kernels.level;
+        config = c;
+
+        if (config.threads > 1) {
+            if (!pool || pool->size() != config.threads) pool.reset(new ThreadPool(config.threads));
+        } else {
+            pool.reset();
+        }
+
+        // Window for the widest slab plus a halo of temporalSteps on each side
+        windowColumns = std::min(width, config.slabWidth + 2 * config.temporalSteps + 1);
+        windowPlane = colStride * windowColumns;
+        window = AlignedBuffer<double>(9 * windowPlane + 2 * padCells);
+        windowTemp = AlignedBuffer<double>(9 * windowPlane + 2 * padCells);
+        rho = AlignedBuffer<double>(windowPlane);
+        ux = AlignedBuffer<double>(windowPlane);
+        uy = AlignedBuffer<double>(windowPlane);
+        health.assign(windowColumns, lbm_kernels::ColumnHealth());
+    }
+
+    OutOfCoreConfig getConfig() const { return config; }
+
+    void setGeometry(const std::string& geom) {
+        currentGeometry = geom;
+        reset();
+    }
+
+    std::string getGeometry() const { return currentGeometry; }
+
+    // Same as LBMSolver::setSolid(): cleared again by reset()
+    void setSolid(int i, int j, bool solid) { obstacle[idx(i, j)] = solid ? 1 : 0; }
+    bool solid(int i, int j) const { return obstacle[idx(i, j)] != 0; }
+
+    // Equilibrium at rest everywhere, written through the mapping one slab
+    // at a time
+    void reset() {
+        stepCount = 0;
+        totalSteps = 0;
+
+        for (int i = 0; i < width; i++) {
+            for (size_t j = 0; j < colStride; j++) {
+                obstacle[idx(i, 0) + j] = j < static_cast<size_t>(height) ? 0 : 1;
+            }
+        }
+        LBMSolver::rasterizeGeometry(currentGeometry, width, height,
+                                     [this](int i, int j) { obstacle[idx(i, j)] = 1; });
+
+        double rho0 = 1.0;
+        double ux0 = 0.0;
+        double uy0 = 0.0;
+        for (int a = 0; a < width; a += config.slabWidth) {
+            int b = std::min(width, a + config.slabWidth);
+            for (int k = 0; k < 9; k++) {
+                double cu = 3.0 * (ex[k] * ux0 + ey[k] * uy0);
+                double u2 = 1.5 * (ux0 * ux0 + uy0 * uy0);
+                double feq = w[k] * rho0 * (1.0 + cu + 0.5 * cu * cu - u2);
+                double* p = plane(current.data, k);
+                std::fill(p + idx(a, 0), p + idx(b, 0), feq);
+            }
+            writeBack(current, a, b);
+        }
+    }
+
+    // Advance by steps, in passes of up to temporalSteps
+    void step(int steps = 1) {
+        while (steps > 0) {
+            int t = std::min(steps, config.temporalSteps);
+            pass(t);
+            steps -= t;
+        }
+    }
+
+    int getStepCount() const { return totalSteps; }
+    OutOfCoreStats getStats() const { return stats; }
+
+    // Reads go through the mapping and may fault pages in from disk
+    double distribution(int i, int j, int k) const { return current.data[k * planeStride + idx(i, j)]; }
+
+    // Moments of the current populations (LBMSolver's rho/ux/uy are those of
+    // the collision pass, before the last streaming step)
+    double density(int i, int j) const {
+        double r = 0.0;
+        for (int k = 0; k < 9; k++) r += distribution(i, j, k);
+        return r;
+    }
+
+    double velocityX(int i, int j) const { return moment(i, j, ex); }
+    double velocityY(int i, int j) const { return moment(i, j, ey); }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    size_t getFileBytes() const { return fileBytes; }
+
+private:
+    static constexpr int ex[9] = {0, 1, 0, -1, 0, 1, -1, -1, 1};
+    static constexpr int ey[9] = {0, 0, 1, 0, -1, 1, 1, -1, -1};
+    static constexpr double w[9] = {4.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0,
+                                     1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0};
+    static constexpr size_t padCells = 8;
+    static constexpr int rampUpSteps = 500;
+
+    struct MappedFile {
+        double* data = nullptr;
+        int fd = -1;
+    };
+
+    int width, height;
+    double nu, omega, u0;
+    int stepCount;   // ramp position, as in LBMSolver
+    int totalSteps;
+    std::string currentGeometry;
+    size_t colStride;
+    size_t planeStride;
+    size_t fileBytes;
+    OutOfCoreConfig config;
+    OutOfCoreStats stats;
+
+    MappedFile current;  // populations at the current time
+    MappedFile next;     // receives the next pass
+    AlignedBuffer<uint8_t> obstacle;
+
+    // In-memory window: up to windowColumns columns from global column
+    // windowLo, planes windowPlane apart
+    int windowLo = 0;
+    int windowColumns;
+    size_t windowPlane;
+    AlignedBuffer<double> window;
+    AlignedBuffer<double> windowTemp;
+    AlignedBuffer<double> rho, ux, uy;  // collision output, not kept
+    std::vector<lbm_kernels::ColumnHealth> health;
+
+    std::shared_ptr<ThreadPool> pool;
+    lbm_kernels::KernelTable kernels;
+
+    size_t idx(int i, int j) const { return static_cast<size_t>(i) * colStride + j; }
+    double* plane(double* base, int k) const { return base + k * planeStride; }
+
+    double moment(int i, int j, const int* e) const {
+        double r = 0.0, m = 0.0;
+        for (int k = 0; k < 9; k++) {
+            double fk = distribution(i, j, k);
+            r += fk;
+            m += e[k] * fk;
+        }
+        return m / r;
+    }
+
+    MappedFile mapFile(const std::string& directory) {
+        std::string path = (directory.empty() ? std::string(".") : directory) + "/lbm-outofcore-XXXXXX";
+        std::vector<char> name(path.begin(), path.end());
+        name.push_back('\0');
+
+        MappedFile m;
+        m.fd = mkstemp(name.data());
+        if (m.fd < 0) throw std::system_error(errno, std::generic_category(), "cannot create " + path);
+        unlink(name.data());
+        if (ftruncate(m.fd, static_cast<off_t>(fileBytes)) != 0) {
+            int err = errno;
+            close(m.fd);
+            throw std::system_error(err, std::generic_category(), "cannot size lattice file");
+        }
+        void* p = mmap(nullptr, fileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m.fd, 0);
+        if (p == MAP_FAILED) {
+            int err = errno;
+            close(m.fd);
+            throw std::system_error(err, std::generic_category(), "cannot map lattice file");
+        }
+        m.data = static_cast<double*>(p);
+        return m;
+    }
+
+    void unmap(MappedFile& m) {
+        if (m.data) munmap(m.data, fileBytes);
+        if (m.fd >= 0) close(m.fd);
+        m.data = nullptr;
+        m.fd = -1;
+    }
+
+    // Apply advice to columns [i0, i1) of every plane, widened to whole pages
+    void advise(const MappedFile& m, int i0, int i1, int advice) const {
+        if (i0 >= i1) return;
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        for (int k = 0; k < 9; k++) {
+            uintptr_t begin = reinterpret_cast<uintptr_t>(plane(m.data, k) + idx(i0, 0));
+            uintptr_t end = reinterpret_cast<uintptr_t>(plane(m.data, k) + idx(i1, 0));
+            begin -= begin % page;
+            madvise(reinterpret_cast<void*>(begin), end - begin, advice);
+        }
+    }
+
+    // Start writing columns [i0, i1) to disk and drop them from this
+    // process; the page cache keeps them until the kernel has written them
+    void writeBack(const MappedFile& m, int i0, int i1) const {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        for (int k = 0; k < 9; k++) {
+            uintptr_t begin = reinterpret_cast<uintptr_t>(plane(m.data, k) + idx(i0, 0));
+            uintptr_t end = reinterpret_cast<uintptr_t>(plane(m.data, k) + idx(i1, 0));
+            begin -= begin % page;
+            msync(reinterpret_cast<void*>(begin), end - begin, MS_ASYNC);
+        }
+        advise(m, i0, i1, MADV_DONTNEED);
+    }
+
+    // Slab [a, b) of a pass; the last slab absorbs a 1-column remainder
+    int slabEnd(int a) const {
+        int b = std::min(width, a + config.slabWidth);
+        return width - b < 2 ? width : b;
+    }
+
+    int windowBegin(int a, int t) const { return std::max(0, a - t); }
+    int windowEnd(int b, int t) const { return std::min(width, b + t); }
+
+    void pass(int t) {
+        // Inlet velocity of each step of the pass
+        std::vector<double> velocities(t);
+        for (int s = 0; s < t; s++) {
+            if (stepCount < rampUpSteps) {
+                velocities[s] = u0 * static_cast<double>(stepCount) / rampUpSteps;
+                stepCount++;
+            } else {
+                velocities[s] = u0;
+            }
+        }
+
+        int previous = 0;  // first column of `current` still needed
+        for (int a = 0; a < width;) {
+            int b = slabEnd(a);
+            int lo = windowBegin(a, t);
+            int hi = windowEnd(b, t);
+
+            if (b < width) {
+                int nb = slabEnd(b);
+                advise(current, windowBegin(b, t), windowEnd(nb, t), MADV_WILLNEED);
+            }
+
+            windowLo = lo;
+            double* f = window.data() + padCells;
+            for (int k = 0; k < 9; k++) {
+                std::memcpy(f + k * windowPlane, plane(current.data, k) + idx(lo, 0),
+                            (hi - lo) * colStride * sizeof(double));
+            }
+            stats.bytesRead += 9.0 * (hi - lo) * colStride * sizeof(double);
+
+            double* result = advanceWindow(lo, hi, velocities);
+
+            for (int k = 0; k < 9; k++) {
+                std::memcpy(plane(next.data, k) + idx(a, 0), result + k * windowPlane + local(a),
+                            (b - a) * colStride * sizeof(double));
+            }
+            stats.bytesWritten += 9.0 * (b - a) * colStride * sizeof(double);
+            writeBack(next, a, b);
+
+            // Columns left of the next window are not read again this pass
+            int keep = b < width ? windowBegin(b, t) : width;
+            advise(current, previous, keep, MADV_DONTNEED);
+            previous = std::max(previous, keep);
+            a = b;
+        }
+
+        std::swap(current, next);
+        totalSteps += t;
+        stats.passes++;
+    }
+
+    // t steps on columns [lo, hi) held in `window`; returns the buffer with
+    // the final state. Interior edges of the window lose one valid column per
+    // step; the domain edges do not, because nothing streams in from outside.
+    double* advanceWindow(int lo, int hi, const std::vector<double>& velocities) {
+        double* f = window.data() + padCells;
+        double* fTemp = windowTemp.data() + padCells;
+
+        int c0 = lo, c1 = hi;  // columns valid before the step
+        for (double velocity : velocities) {
+            int n0 = lo == 0 ? 0 : c0 + 1;
+            int n1 = hi == width ? width : c1 - 1;
+
+            forColumns(c0, c1, [&](int i) { collideColumn(f, i); });
+            forColumns(n0, n1, [&](int i) { streamColumn(f, fTemp, i); });
+            std::swap(f, fTemp);
+
+            if (n0 == 0) applyInlet(f, velocity);
+            if (n1 == width) applyOutlet(f);
+            applyFreeSlipWalls(f, n0, n1);
+
+            c0 = n0;
+            c1 = n1;
+        }
+        return f;
+    }
+
+    template <typename F>
+    void forColumns(int i0, int i1, F body) {
+        int n = i1 - i0;
+        if (n <= 0) return;
+        if (!pool) {
+            for (int i = i0; i < i1; i++) body(i);
+            return;
+        }
+        int tasks = std::min(n, pool->size());
+        pool->run(tasks, [&](int task) {
+            int begin = i0 + static_cast<int>(static_cast<long long>(n) * task / tasks);
+            int end = i0 + static_cast<int>(static_cast<long long>(n) * (task + 1) / tasks);
+            for (int i = begin; i < end; i++) body(i);
+        });
+    }
+
+    // Offset of global column i in the window
+    size_t local(int i) const { return idx(i - windowLo, 0); }
+
+    // LBMSolver::collideCell() / collideTileSimd() on one column
+    void collideColumn(double* f, int i) {
+        size_t c = local(i);
+        const uint8_t* solid = &obstacle[idx(i, 0)];
+        lbm_kernels::ColumnHealth& h = health[i - windowLo];
+        h = {INFINITY, 0.0, 0.0};
+
+        if (kernels.collide) {
+            double* cols[9];
+            for (int k = 0; k < 9; k++) cols[k] = f + k * windowPlane + c;
+            kernels.collide(cols, &rho[c], &ux[c], &uy[c], nullptr, solid, colStride, omega, &h);
+            return;
+        }
+
+        for (int j = 0; j < height; j++) {
+            if (solid[j]) continue;
+            size_t cj = c + j;
+            double rho_local = 0.0;
+            double ux_local = 0.0;
+            double uy_local = 0.0;
+
+            for (int k = 0; k < 9; k++) {
+                double fk = f[k * windowPlane + cj];
+                rho_local += fk;
+                ux_local += ex[k] * fk;
+                uy_local += ey[k] * fk;
+            }
+
+            ux_local /= rho_local;
+            uy_local /= rho_local;
+
+            double u2 = 1.5 * (ux_local * ux_local + uy_local * uy_local);
+
+            for (int k = 0; k < 9; k++) {
+                double cu = 3.0 * (ex[k] * ux_local + ey[k] * uy_local);
+                double feq = w[k] * rho_local * (1.0 + cu + 0.5 * cu * cu - u2);
+                f[k * windowPlane + cj] += omega * (feq - f[k * windowPlane + cj]);
+            }
+        }
+    }
+
+    // LBMSolver::streamCellFused() / streamTileSimd() on one column
+    void streamColumn(const double* f, double* fTemp, int i) {
+        size_t c = local(i);
+        const uint8_t* solid = &obstacle[idx(i, 0)];
+
+        if (kernels.stream) {
+            double* dst[9];
+            const double* src[9];
+            const double* own[9];
+            for (int k = 0; k < 9; k++) {
+                int iprev = i - ex[k];
+                dst[k] = fTemp + k * windowPlane + c;
+                own[k] = f + k * windowPlane + c;
+                src[k] = iprev >= 0 && iprev < width ? f + k * windowPlane + local(iprev) - ey[k] : own[k];
+            }
+            kernels.stream(dst, src, own, solid, colStride);
+
+            size_t bottom = c;
+            size_t top = c + height - 1;
+            if (!solid[0]) {
+                for (int k : {2, 5, 6}) fTemp[k * windowPlane + bottom] = f[k * windowPlane + bottom];
+            }
+            if (!solid[height - 1]) {
+                for (int k : {4, 7, 8}) fTemp[k * windowPlane + top] = f[k * windowPlane + top];
+            }
+            return;
+        }
+
+        for (int j = 0; j < height; j++) {
+            size_t cj = c + j;
+            if (solid[j]) {
+                for (int k = 0; k < 9; k++) fTemp[k * windowPlane + cj] = f[lbm_kernels::opp[k] * windowPlane + cj];
+                continue;
+            }
+            for (int k = 0; k < 9; k++) {
+                int iprev = i - ex[k];
+                int jprev = j - ey[k];
+                if (iprev >= 0 && iprev < width && jprev >= 0 && jprev < height) {
+                    fTemp[k * windowPlane + cj] = f[k * windowPlane + local(iprev) + jprev];
+                } else {
+                    fTemp[k * windowPlane + cj] = f[k * windowPlane + cj];
+                }
+            }
+        }
+    }
+
+    // LBMSolver::applyInletOutlet() for a uniform inlet and zero-gradient outlet
+    void applyInlet(double* f, double velocity) {
+        size_t c = local(0);
+        double ux_in = velocity;
+        double uy_in = 0.0;
+        double u2 = 1.5 * (ux_in * ux_in + uy_in * uy_in);
+        for (int j = 0; j < height; j++) {
+            for (int k = 0; k < 9; k++) {
+                double cu = 3.0 * (ex[k] * ux_in + ey[k] * uy_in);
+                f[k * windowPlane + c + j] = w[k] * 1.0 * (1.0 + cu + 0.5 * cu * cu - u2);
+            }
+        }
+    }
+
+    void applyOutlet(double* f) {
+        size_t last = local(width - 1);
+        size_t interior = local(width - 2);
+        for (int k = 0; k < 9; k++) {
+            std::memcpy(f + k * windowPlane + last, f + k * windowPlane + interior, height * sizeof(double));
+        }
+    }
+
+    void applyFreeSlipWalls(double* f, int i0, int i1) {
+        for (int i = i0; i < i1; i++) {
+            for (size_t c : {local(i), local(i) + height - 1}) {
+                std::swap(f[2 * windowPlane + c], f[4 * windowPlane + c]);
+                std::swap(f[5 * windowPlane + c], f[8 * windowPlane + c]);
+                std::swap(f[6 * windowPlane + c], f[7 * windowPlane + c]);
+            }
+        }
+    }
+};
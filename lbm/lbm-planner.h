@@ -0,0 +1,298 @@
+// Resolution planner for LBMSolver
+// Turns a physical flow (body size, free-stream speed, fluid viscosity) and an
+// accuracy target into the cheapest lattice that stays stable: lattice size,
+// inlet velocity u0 and lattice viscosity nu, chosen to minimise cell updates
+// per simulated second. Stability limits come from a table measured with
+// `lbm-bench --stability`; re-measure and paste its output into
+// stabilityTable() after changing the collision or boundary code.
+//
+// planMemory() is the memory side: the exact lattice bytes of each storage
+// layout for a lattice size and the requested features, and the fastest
+// layout that fits a byte budget, decided before anything is allocated.
+#pragma once
+
+#include "lbm-solver.h"
+#include "lbm-compressed.h"
+#include "lbm-fixed.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+struct PhysicalFlow {
+    double bodySize = 0.01;        // characteristic length (m), see LBMSolver::bodyLength()
+    double velocity = 1.0;         // free-stream speed (m/s)
+    double viscosity = 1.0e-6;     // kinematic viscosity (m^2/s), water at 20 C
+    std::string geometry = "circle";
+    // Accuracy target
+    int minCellsAcross = 20;       // lattice cells along the body
+    double maxMach = 0.3;          // lattice Mach number bound (compressibility error ~ Ma^2)
+    double safetyFactor = 1.25;    // nu must exceed the measured limit by this factor
+    int maxHeight = 4096;          // largest lattice the plan may use
+};
+
+struct ResolutionPlan {
+    bool feasible;
+    std::string reason;            // why no plan was found
+    int width;
+    int height;
+    double u0;                     // lattice inlet velocity
+    double nu;                     // lattice viscosity
+    double tau;
+    std::string collision;         // collision model; "bgk" is the only one implemented
+    std::string geometry;
+    double reynolds;
+    double mach;
+    double cellsAcross;            // lattice cells along the body
+    double dx;                     // m per cell
+    double dt;                     // s per step
+    double updatesPerSecond;       // cell updates per simulated second
+};
+
+// Lattice storage, fastest first
+enum class LatticeLayout {
+    Double = 0,      // LBMSolver
+    Fixed32 = 1,     // LBMFixedSolver32
+    Fixed16 = 2,     // LBMFixedSolver16
+    Compressed = 3   // LBMCompressedSolver
+};
+
+struct MemoryRequest {
+    int width = 0;
+    int height = 0;
+    double budgetBytes = 0.0;        // cap on the lattice plus reserveBytes
+    double reserveBytes = 0.0;       // held back for everything else (runtime, page)
+    // Features: a layout that lacks a required one is not a candidate
+    bool watchdog = false;           // divergence watchdog (LBMSolver only)
+    bool reproducible = false;       // bit-identical on every machine (fixed point only)
+    bool reducedPrecision = true;    // allow int16 and compressed storage
+};
+
+struct MemoryOption {
+    LatticeLayout layout;
+    int bits;                        // per stored value (compression rate for Compressed)
+    bool watchdog;
+    bool reproducible;
+    double bytes;                    // arena bytes of the lattice, exact
+    bool eligible;                   // has every requested feature
+    bool fits;                       // bytes + reserveBytes <= budgetBytes
+};
+
+struct MemoryPlan {
+    bool feasible;
+    std::string reason;              // why no layout was chosen
+    MemoryOption choice;             // the first eligible option that fits
+    std::vector<MemoryOption> options;  // every layout, fastest first
+};
+
+// Smallest stable lattice viscosity at an inlet velocity
+struct StabilityLimit {
+    double velocity;
+    double minViscosity;
+};
+
+namespace lbm_planner {
+
+// Measured with `lbm-bench --stability` (circle, BGK, free-slip walls);
+// the larger of the 200x100 and 400x200 limits at each velocity, raised to
+// the largest limit at any lower velocity. The bisection resolves the limit to
+// about 4%, so neighbouring entries can come out in the wrong order. A
+// higher inlet velocity never needs less viscosity, and the planner relies on
+// that. The limit grows slowly with lattice size, which safetyFactor has to
+// absorb on lattices much larger than 400x200.
+inline const std::vector<StabilityLimit>& stabilityTable() {
+    static const std::vector<StabilityLimit> table = {
+        {0.02, 0.000498},
+        {0.04, 0.000652},
+        {0.06, 0.000823},
+        {0.08, 0.000998},
+        {0.10, 0.001165},
+        {0.12, 0.001361},
+        {0.14, 0.001588},
+        {0.16, 0.001588},
+        {0.17, 0.001588},
+    };
+    return table;
+}
+
+// Linear interpolation in the table; velocities outside it have no limit
+inline double minStableViscosity(double velocity) {
+    const std::vector<StabilityLimit>& table = stabilityTable();
+    if (velocity < table.front().velocity || velocity > table.back().velocity) return INFINITY;
+    for (size_t i = 1; i < table.size(); i++) {
+        if (velocity <= table[i].velocity) {
+            const StabilityLimit& a = table[i - 1];
+            const StabilityLimit& b = table[i];
+            double t = (velocity - a.velocity) / (b.velocity - a.velocity);
+            return a.minViscosity + t * (b.minViscosity - a.minViscosity);
+        }
+    }
+    return table.back().minViscosity;
+}
+
+// True if the solver runs `steps` steps at (velocity, viscosity) without
+// non-finite values or density collapsing below minDensity
+inline bool runsStable(int width, int height, const std::string& geometry, double velocity,
+                       double viscosity, int steps, const StepConfig& config = StepConfig(),
+                       double minDensity = 0.05) {
+    LBMSolver solver(width, height);
+    solver.setStepConfig(config);
+    solver.setVelocity(velocity);
+    solver.setViscosity(viscosity);
+    solver.setGeometry(geometry);
+    for (int s = 0; s < steps; s++) {
+        solver.step();
+        StepHealth h = solver.getStepHealth();
+        if (!h.finite || h.minDensity < minDensity) return false;
+    }
+    return true;
+}
+
+// Bisect (geometrically) the smallest stable viscosity at one velocity.
+// Returns INFINITY if even maxViscosity diverges.
+inline double measureStabilityLimit(int width, int height, const std::string& geometry, double velocity,
+                                    int steps, const StepConfig& config = StepConfig(),
+                                    double minViscosity = 1.0e-5, double maxViscosity = 0.2,
+                                    int iterations = 8) {
+    if (!runsStable(width, height, geometry, velocity, maxViscosity, steps, config)) return INFINITY;
+    double stable = maxViscosity;
+    double unstable = minViscosity;
+    for (int it = 0; it < iterations; it++) {
+        double mid = std::sqrt(stable * unstable);
+        if (runsStable(width, height, geometry, velocity, mid, steps, config)) {
+            stable = mid;
+        } else {
+            unstable = mid;
+        }
+    }
+    return stable;
+}
+
+// Cheapest stable lattice for a physical flow. Candidate inlet velocities are
+// scanned across the stability table; for each, the body needs enough cells
+// that nu = u0 * cells / Re clears the stability limit, and the cost is
+// width * height steps per simulated time of dx * u0 / U.
+inline ResolutionPlan planResolution(const PhysicalFlow& flow) {
+    ResolutionPlan best = {};
+    best.feasible = false;
+    best.collision = "bgk";
+    best.geometry = flow.geometry;
+    best.reynolds = flow.velocity * flow.bodySize / flow.viscosity;
+
+    double fraction = LBMSolver::bodyLength(flow.geometry, 1.0);
+    if (!(best.reynolds > 0.0) || !std::isfinite(best.reynolds) || fraction <= 0.0) {
+        best.reason = "body size, velocity and viscosity must be positive";
+        return best;
+    }
+
+    const std::vector<StabilityLimit>& table = stabilityTable();
+    double maxVelocity = std::min(table.back().velocity, flow.maxMach / std::sqrt(3.0));
+    best.reason = "no stable lattice up to the maximum height";
+
+    const double maxViscosity = 0.5;  // tau = 2; beyond this BGK boundaries lose accuracy
+    for (int n = 0;; n++) {
+        double u = table.front().velocity + 0.0025 * n;
+        if (u > maxVelocity + 1e-12) break;
+        double nuMin = flow.safetyFactor * minStableViscosity(u);
+        double cells = std::max(static_cast<double>(flow.minCellsAcross), best.reynolds * nuMin / u);
+
+        // Bodies scale with the lattice height; keep heights a multiple of
+        // the column padding so SIMD columns have no remainder
+        int height = static_cast<int>(std::ceil(cells / fraction));
+        height = (height + 7) / 8 * 8;
+        if (height > flow.maxHeight) continue;
+        cells = LBMSolver::bodyLength(flow.geometry, height);
+        double nu = u * cells / best.reynolds;
+        if (nu > maxViscosity) continue;
+
+        int width = 2 * height;
+        double dx = flow.bodySize / cells;
+        double dt = dx * u / flow.velocity;
+        double updates = static_cast<double>(width) * height / dt;
+        if (!best.feasible || updates < best.updatesPerSecond) {
+            best.feasible = true;
+            best.reason.clear();
+            best.width = width;
+            best.height = height;
+            best.u0 = u;
+            best.nu = nu;
+            best.tau = 3.0 * nu + 0.5;
+            best.mach = u * std::sqrt(3.0);
+            best.cellsAcross = cells;
+            best.dx = dx;
+            best.dt = dt;
+            best.updatesPerSecond = updates;
+        }
+    }
+    return best;
+}
+
+// Configure a solver from a plan. The lattice size is fixed at construction,
+// so the solver must have been created as LBMSolver(plan.width, plan.height).
+inline bool applyPlan(LBMSolver& solver, const ResolutionPlan& plan) {
+    if (!plan.feasible || solver.getWidth() != plan.width || solver.getHeight() != plan.height) return false;
+    solver.setVelocity(plan.u0);
+    solver.setViscosity(plan.nu);
+    solver.setGeometry(plan.geometry);  // resets the flow
+    return true;
+}
+
+// Every layout's bytes for the lattice, and the fastest one with the
+// requested features that fits the budget. Layouts are ordered by measured
+// single-core throughput: double, fixed32 and fixed16 within ~20% of each
+// other on large lattices, compressed about six times slower. The double
+// layout with checkpoints comes before the one without, since the watchdog
+// costs memory but no speed.
+inline MemoryPlan planMemory(const MemoryRequest& request) {
+    MemoryPlan plan = {};
+    plan.feasible = false;
+    if (request.width < 3 || request.height < 3) {
+        plan.reason = "lattice must be at least 3x3";
+        return plan;
+    }
+
+    int w = request.width, h = request.height;
+    auto add = [&](LatticeLayout layout, int bits, bool watchdog, bool reproducible, bool reduced, uint64_t bytes) {
+        MemoryOption o;
+        o.layout = layout;
+        o.bits = bits;
+        o.watchdog = watchdog;
+        o.reproducible = reproducible;
+        o.bytes = static_cast<double>(bytes);
+        o.eligible = (watchdog || !request.watchdog) && (reproducible || !request.reproducible) &&
+                     (!reduced || request.reducedPrecision);
+        o.fits = o.bytes + request.reserveBytes <= request.budgetBytes;
+        plan.options.push_back(o);
+    };
+    add(LatticeLayout::Double, 64, true, false, false, LBMSolver::requiredBytes(w, h, true));
+    add(LatticeLayout::Double, 64, false, false, false, LBMSolver::requiredBytes(w, h, false));
+    add(LatticeLayout::Fixed32, 32, false, true, false, LBMFixedSolver32::requiredBytes(w, h));
+    add(LatticeLayout::Fixed16, 16, false, true, true, LBMFixedSolver16::requiredBytes(w, h));
+    // Rate 12 loses about 1% of the velocity and below that runs diverge
+    for (int rate : {24, 16}) {
+        add(LatticeLayout::Compressed, rate, false, false, true, LBMCompressedSolver::requiredBytes(w, h, rate));
+    }
+
+    bool anyEligible = false;
+    for (const MemoryOption& o : plan.options) {
+        anyEligible = anyEligible || o.eligible;
+        if (o.eligible && o.fits) {
+            plan.feasible = true;
+            plan.choice = o;
+            return plan;
+        }
+    }
+    if (!anyEligible) {
+        plan.reason = "no layout has both the watchdog and bit-reproducible results";
+    } else {
+        char reason[160];
+        snprintf(reason, sizeof(reason), "%dx%d needs more than the %.0f MB budget in every eligible layout", w, h,
+                 request.budgetBytes / (1024.0 * 1024.0));
+        plan.reason = reason;
+    }
+    return plan;
+}
+
+}  // namespace lbm_planner
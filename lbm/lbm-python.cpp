@@ -0,0 +1,395 @@
+// Python bindings (pybind11) for the native solver
+// Same classes, methods and value types as the Emscripten bindings in
+// lbm-solver.cpp, plus NumPy views that point straight at solver memory:
+//
+//   solver.rho, solver.ux, solver.uy   float64 (height, width), writable
+//   solver.obstacle                    uint8 (height, width), read-only mask
+//   solver.populations()               float64 (9, height, width)
+//
+// Change the mask with set_solid(mask) or setSolid(i, j, solid), which also
+// drop the cached surface and thaw skipped blocks.
+//
+// Views index as [j, i] like the field exports and keep the solver alive.
+// The population planes swap buffers every step, so call populations() again
+// after stepping. step_n() releases the GIL for the whole run, so other Python
+// threads keep working while the solver steps (reading a view meanwhile sees
+// a partially updated lattice).
+//
+// Build: ./build-python.sh
+// Usage: import lbm; s = lbm.LBMSolver(700, 350); s.step_n(1000); s.ux.mean()
+
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include "lbm-solver.h"
+#include "lbm-planner.h"
+
+#include <cmath>
+#include <vector>
+
+namespace py = pybind11;
+
+// (height, width) view of a per-cell field; base keeps the solver alive
+template <typename T>
+static py::array_t<T> fieldView(py::object self, T* data) {
+    const LBMSolver& s = self.cast<const LBMSolver&>();
+    std::vector<py::ssize_t> shape = {s.getHeight(), s.getWidth()};
+    std::vector<py::ssize_t> strides = {static_cast<py::ssize_t>(sizeof(T)),
+                                        static_cast<py::ssize_t>(s.getColumnStride() * sizeof(T))};
+    return py::array_t<T>(shape, strides, data, self);
+}
+
+static void checkCell(const LBMSolver& s, int i, int j) {
+    if (i < 0 || i >= s.getWidth() || j < 0 || j >= s.getHeight()) {
+        throw py::index_error("cell (" + std::to_string(i) + ", " + std::to_string(j) + ") outside the " +
+                              std::to_string(s.getWidth()) + "x" + std::to_string(s.getHeight()) + " lattice");
+    }
+}
+
+// Copy of a derived field in the layout of the embind exports
+template <typename F>
+static py::array_t<double> fieldCopy(const LBMSolver& s, F value) {
+    py::array_t<double> out(std::vector<py::ssize_t>{s.getHeight(), s.getWidth()});
+    auto v = out.mutable_unchecked<2>();
+    for (int j = 0; j < s.getHeight(); j++) {
+        for (int i = 0; i < s.getWidth(); i++) v(j, i) = value(i, j);
+    }
+    return out;
+}
+
+PYBIND11_MODULE(lbm, m) {
+    m.doc() = "D2Q9 lattice Boltzmann solver with zero-copy NumPy field views";
+
+    py::enum_<Traversal>(m, "Traversal")
+        .value("Columns", Traversal::Columns)
+        .value("Rows", Traversal::Rows);
+
+    py::enum_<KernelVariant>(m, "KernelVariant")
+        .value("TwoPass", KernelVariant::TwoPass)
+        .value("Fused", KernelVariant::Fused);
+
+    py::enum_<SimdLevel>(m, "SimdLevel")
+        .value("Auto", SimdLevel::Auto)
+        .value("Scalar", SimdLevel::Scalar)
+        .value("SSE42", SimdLevel::SSE42)
+        .value("AVX2", SimdLevel::AVX2)
+        .value("AVX512", SimdLevel::AVX512)
+        .value("SIMD128", SimdLevel::SIMD128);
+
+    py::enum_<ThreadPinning>(m, "ThreadPinning")
+        .value("Off", ThreadPinning::Off)
+        .value("Compact", ThreadPinning::Compact)
+        .value("Spread", ThreadPinning::Spread);
+
+    py::class_<StepConfig>(m, "StepConfig")
+        .def(py::init<>())
+        .def_readwrite("threads", &StepConfig::threads)
+        .def_readwrite("tileWidth", &StepConfig::tileWidth)
+        .def_readwrite("traversal", &StepConfig::traversal)
+        .def_readwrite("kernel", &StepConfig::kernel)
+        .def_readwrite("simd", &StepConfig::simd)
+        .def_readwrite("nonTemporal", &StepConfig::nonTemporal)
+        .def_readwrite("pinning", &StepConfig::pinning);
+
+    py::enum_<FlowBoundary>(m, "FlowBoundary")
+        .value("InletOutlet", FlowBoundary::InletOutlet)
+        .value("Periodic", FlowBoundary::Periodic)
+        .value("NoSlip", FlowBoundary::NoSlip);
+
+    py::enum_<WallBoundary>(m, "WallBoundary")
+        .value("FreeSlip", WallBoundary::FreeSlip)
+        .value("Periodic", WallBoundary::Periodic)
+        .value("NoSlip", WallBoundary::NoSlip);
+
+    py::enum_<InletProfile>(m, "InletProfile")
+        .value("Uniform", InletProfile::Uniform)
+        .value("Parabolic", InletProfile::Parabolic);
+
+    py::enum_<OutletCondition>(m, "OutletCondition")
+        .value("ZeroGradient", OutletCondition::ZeroGradient)
+        .value("Pressure", OutletCondition::Pressure);
+
+    py::class_<BoundaryConfig>(m, "BoundaryConfig")
+        .def(py::init<>())
+        .def_readwrite("flow", &BoundaryConfig::flow)
+        .def_readwrite("walls", &BoundaryConfig::walls)
+        .def_readwrite("inlet", &BoundaryConfig::inlet)
+        .def_readwrite("outlet", &BoundaryConfig::outlet)
+        .def_readwrite("lidVelocity", &BoundaryConfig::lidVelocity);
+
+    py::class_<Diagnostics>(m, "Diagnostics")
+        .def(py::init<>())
+        .def_readwrite("mass", &Diagnostics::mass)
+        .def_readwrite("momentumX", &Diagnostics::momentumX)
+        .def_readwrite("momentumY", &Diagnostics::momentumY)
+        .def_readwrite("maxSpeed", &Diagnostics::maxSpeed)
+        .def_readwrite("minDensity", &Diagnostics::minDensity)
+        .def_readwrite("maxDensity", &Diagnostics::maxDensity)
+        .def_readwrite("forceX", &Diagnostics::forceX)
+        .def_readwrite("forceY", &Diagnostics::forceY)
+        .def_readwrite("fluidCells", &Diagnostics::fluidCells);
+
+    py::class_<SurfacePoint>(m, "SurfacePoint")
+        .def(py::init<>())
+        .def_readwrite("i", &SurfacePoint::i)
+        .def_readwrite("j", &SurfacePoint::j)
+        .def_readwrite("arcLength", &SurfacePoint::arcLength)
+        .def_readwrite("nx", &SurfacePoint::nx)
+        .def_readwrite("ny", &SurfacePoint::ny)
+        .def_readwrite("cp", &SurfacePoint::cp)
+        .def_readwrite("cf", &SurfacePoint::cf);
+
+    py::enum_<WatchdogBackoff>(m, "WatchdogBackoff")
+        .value("Velocity", WatchdogBackoff::Velocity)
+        .value("Viscosity", WatchdogBackoff::Viscosity);
+
+    py::class_<WatchdogConfig>(m, "WatchdogConfig")
+        .def(py::init<>())
+        .def_readwrite("enabled", &WatchdogConfig::enabled)
+        .def_readwrite("checkpointInterval", &WatchdogConfig::checkpointInterval)
+        .def_readwrite("maxMach", &WatchdogConfig::maxMach)
+        .def_readwrite("minDensity", &WatchdogConfig::minDensity)
+        .def_readwrite("backoff", &WatchdogConfig::backoff)
+        .def_readwrite("backoffFactor", &WatchdogConfig::backoffFactor)
+        .def_readwrite("maxRetries", &WatchdogConfig::maxRetries);
+
+    py::class_<WatchdogEvent>(m, "WatchdogEvent")
+        .def_readonly("step", &WatchdogEvent::step)
+        .def_readonly("restoredStep", &WatchdogEvent::restoredStep)
+        .def_readonly("reason", &WatchdogEvent::reason)
+        .def_readonly("previousVelocity", &WatchdogEvent::previousVelocity)
+        .def_readonly("previousViscosity", &WatchdogEvent::previousViscosity)
+        .def_readonly("velocity", &WatchdogEvent::velocity)
+        .def_readonly("viscosity", &WatchdogEvent::viscosity)
+        .def_readonly("halted", &WatchdogEvent::halted);
+
+    py::class_<ActivityConfig>(m, "ActivityConfig")
+        .def(py::init<>())
+        .def_readwrite("enabled", &ActivityConfig::enabled)
+        .def_readwrite("threshold", &ActivityConfig::threshold)
+        .def_readwrite("blockWidth", &ActivityConfig::blockWidth)
+        .def_readwrite("checkInterval", &ActivityConfig::checkInterval)
+        .def_readwrite("verify", &ActivityConfig::verify);
+
+    py::class_<ActivityStats>(m, "ActivityStats")
+        .def_readonly("blocks", &ActivityStats::blocks)
+        .def_readonly("frozenBlocks", &ActivityStats::frozenBlocks)
+        .def_readonly("thawedBlocks", &ActivityStats::thawedBlocks)
+        .def_readonly("skippedFraction", &ActivityStats::skippedFraction)
+        .def_readonly("maxFrozenDeviation", &ActivityStats::maxFrozenDeviation);
+
+    py::class_<StepHealth>(m, "StepHealth")
+        .def_readonly("minDensity", &StepHealth::minDensity)
+        .def_readonly("maxMach", &StepHealth::maxMach)
+        .def_readonly("finite", &StepHealth::finite);
+
+    py::class_<PhysicalFlow>(m, "PhysicalFlow")
+        .def(py::init<>())
+        .def_readwrite("bodySize", &PhysicalFlow::bodySize)
+        .def_readwrite("velocity", &PhysicalFlow::velocity)
+        .def_readwrite("viscosity", &PhysicalFlow::viscosity)
+        .def_readwrite("geometry", &PhysicalFlow::geometry)
+        .def_readwrite("minCellsAcross", &PhysicalFlow::minCellsAcross)
+        .def_readwrite("maxMach", &PhysicalFlow::maxMach)
+        .def_readwrite("safetyFactor", &PhysicalFlow::safetyFactor)
+        .def_readwrite("maxHeight", &PhysicalFlow::maxHeight);
+
+    py::class_<ResolutionPlan>(m, "ResolutionPlan")
+        .def_readonly("feasible", &ResolutionPlan::feasible)
+        .def_readonly("reason", &ResolutionPlan::reason)
+        .def_readonly("width", &ResolutionPlan::width)
+        .def_readonly("height", &ResolutionPlan::height)
+        .def_readonly("u0", &ResolutionPlan::u0)
+        .def_readonly("nu", &ResolutionPlan::nu)
+        .def_readonly("tau", &ResolutionPlan::tau)
+        .def_readonly("collision", &ResolutionPlan::collision)
+        .def_readonly("geometry", &ResolutionPlan::geometry)
+        .def_readonly("reynolds", &ResolutionPlan::reynolds)
+        .def_readonly("mach", &ResolutionPlan::mach)
+        .def_readonly("cellsAcross", &ResolutionPlan::cellsAcross)
+        .def_readonly("dx", &ResolutionPlan::dx)
+        .def_readonly("dt", &ResolutionPlan::dt)
+        .def_readonly("updatesPerSecond", &ResolutionPlan::updatesPerSecond);
+
+    m.def("planResolution", &lbm_planner::planResolution);
+    m.def("applyPlan", &lbm_planner::applyPlan);
+
+    py::enum_<LatticeLayout>(m, "LatticeLayout")
+        .value("Double", LatticeLayout::Double)
+        .value("Fixed32", LatticeLayout::Fixed32)
+        .value("Fixed16", LatticeLayout::Fixed16)
+        .value("Compressed", LatticeLayout::Compressed);
+
+    py::class_<MemoryRequest>(m, "MemoryRequest")
+        .def(py::init<>())
+        .def_readwrite("width", &MemoryRequest::width)
+        .def_readwrite("height", &MemoryRequest::height)
+        .def_readwrite("budgetBytes", &MemoryRequest::budgetBytes)
+        .def_readwrite("reserveBytes", &MemoryRequest::reserveBytes)
+        .def_readwrite("watchdog", &MemoryRequest::watchdog)
+        .def_readwrite("reproducible", &MemoryRequest::reproducible)
+        .def_readwrite("reducedPrecision", &MemoryRequest::reducedPrecision);
+
+    py::class_<MemoryOption>(m, "MemoryOption")
+        .def_readonly("layout", &MemoryOption::layout)
+        .def_readonly("bits", &MemoryOption::bits)
+        .def_readonly("watchdog", &MemoryOption::watchdog)
+        .def_readonly("reproducible", &MemoryOption::reproducible)
+        .def_readonly("bytes", &MemoryOption::bytes)
+        .def_readonly("eligible", &MemoryOption::eligible)
+        .def_readonly("fits", &MemoryOption::fits);
+
+    py::class_<MemoryPlan>(m, "MemoryPlan")
+        .def_readonly("feasible", &MemoryPlan::feasible)
+        .def_readonly("reason", &MemoryPlan::reason)
+        .def_readonly("choice", &MemoryPlan::choice)
+        .def_readonly("options", &MemoryPlan::options);
+
+    m.def("planMemory", &lbm_planner::planMemory);
+
+    py::enum_<HugePages>(m, "HugePages")
+        .value("Off", HugePages::Off)
+        .value("Transparent", HugePages::Transparent)
+        .value("Explicit", HugePages::Explicit);
+
+    // Backing of lattices created afterwards
+    m.def("setHugePages", [](HugePages mode) { LatticeArena::instance().setHugePages(mode); });
+
+    py::class_<LBMSolver>(m, "LBMSolver")
+        .def(py::init<int, int>())
+        .def(py::init<int, int, StepConfig>())
+        .def("setViscosity", &LBMSolver::setViscosity)
+        .def("setVelocity", &LBMSolver::setVelocity)
+        .def("getViscosity", &LBMSolver::getViscosity)
+        .def("getVelocity", &LBMSolver::getVelocity)
+        .def("setGeometry", &LBMSolver::setGeometry)
+        .def("getGeometry", &LBMSolver::getGeometry)
+        .def("setBoundary", &LBMSolver::setBoundary)
+        .def("getBoundary", &LBMSolver::getBoundary)
+        // The solver does not check cell indices; a bad one from Python must
+        // raise instead of writing outside the lattice
+        .def("setSolid", [](LBMSolver& s, int i, int j, bool solid) {
+            checkCell(s, i, j);
+            s.setSolid(i, j, solid);
+        })
+        .def("setCellState", [](LBMSolver& s, int i, int j, double density, double velocityX, double velocityY) {
+            checkCell(s, i, j);
+            s.setCellState(i, j, density, velocityX, velocityY);
+        })
+        .def("setStepConfig", &LBMSolver::setStepConfig)
+        .def("getStepConfig", &LBMSolver::getStepConfig)
+        .def_static("getHardwareThreads", &LBMSolver::getHardwareThreads)
+        .def_static("getBestSimdLevel", &LBMSolver::getBestSimdLevel)
+        .def_static("bodyLength", &LBMSolver::bodyLength)
+        .def("reset", &LBMSolver::reset)
+        .def("step", &LBMSolver::step, py::call_guard<py::gil_scoped_release>())
+        .def("step_n", [](LBMSolver& s, int n) {
+            for (int k = 0; k < n; k++) s.step();
+        }, py::arg("n"), py::call_guard<py::gil_scoped_release>())
+        .def("computeDiagnostics", &LBMSolver::computeDiagnostics, py::call_guard<py::gil_scoped_release>())
+        .def("computeSurface", &LBMSolver::computeSurface, py::arg("averaged") = false)
+        // (N, 7) array of arcLength, i, j, nx, ny, cp, cf for plotting
+        .def("surfaceArray", [](LBMSolver& s, bool averaged) {
+            std::vector<SurfacePoint> points = s.computeSurface(averaged);
+            py::array_t<double> out(std::vector<py::ssize_t>{static_cast<py::ssize_t>(points.size()), 7});
+            auto v = out.mutable_unchecked<2>();
+            for (size_t n = 0; n < points.size(); n++) {
+                const SurfacePoint& p = points[n];
+                double row[7] = {p.arcLength, double(p.i), double(p.j), p.nx, p.ny, p.cp, p.cf};
+                for (int c = 0; c < 7; c++) v(n, c) = row[c];
+            }
+            return out;
+        }, py::arg("averaged") = false)
+        .def("setSurfaceAveraging", &LBMSolver::setSurfaceAveraging)
+        .def("getSurfaceAveraging", &LBMSolver::getSurfaceAveraging)
+        .def("getSurfaceAverageSteps", &LBMSolver::getSurfaceAverageSteps)
+        .def("setWatchdog", &LBMSolver::setWatchdog)
+        .def("getWatchdog", &LBMSolver::getWatchdog)
+        .def("getWatchdogEvents", &LBMSolver::getWatchdogEvents)
+        .def("getWatchdogEventCount", &LBMSolver::getWatchdogEventCount)
+        .def("clearWatchdogEvents", &LBMSolver::clearWatchdogEvents)
+        .def("setActivity", &LBMSolver::setActivity)
+        .def("getActivity", &LBMSolver::getActivity)
+        .def("getActivityStats", &LBMSolver::getActivityStats)
+        .def("getStepHealth", &LBMSolver::getStepHealth)
+        .def("getStepCount", &LBMSolver::getStepCount)
+        .def("isHalted", &LBMSolver::isHalted)
+        .def("getVelocityMagnitude", [](const LBMSolver& s) {
+            return fieldCopy(s, [&](int i, int j) {
+                return std::sqrt(s.velocityX(i, j) * s.velocityX(i, j) + s.velocityY(i, j) * s.velocityY(i, j));
+            });
+        })
+        .def("getVorticity", [](const LBMSolver& s) {
+            return fieldCopy(s, [&](int i, int j) { return s.vorticity(i, j); });
+        })
+        .def("getStrainRate", [](const LBMSolver& s) {
+            return fieldCopy(s, [&](int i, int j) { return s.strainRate(i, j); });
+        })
+        .def("setStrainRateOutput", &LBMSolver::setStrainRateOutput)
+        .def("getStrainRateOutput", &LBMSolver::getStrainRateOutput)
+        .def("getPressure", [](const LBMSolver& s) {
+            return fieldCopy(s, [&](int i, int j) { return s.density(i, j) / 3.0; });
+        })
+        .def("getObstacle", [](const LBMSolver& s) {
+            return fieldCopy(s, [&](int i, int j) { return s.solid(i, j) ? 1.0 : 0.0; });
+        })
+        .def("getUx", [](const LBMSolver& s) {
+            return fieldCopy(s, [&](int i, int j) { return s.velocityX(i, j); });
+        })
+        .def("getUy", [](const LBMSolver& s) {
+            return fieldCopy(s, [&](int i, int j) { return s.velocityY(i, j); });
+        })
+        .def("getWidth", &LBMSolver::getWidth)
+        .def("getHeight", &LBMSolver::getHeight)
+        .def("setRunning", &LBMSolver::setRunning)
+        .def("isRunning", &LBMSolver::isRunning)
+        // Zero-copy views
+        .def_property_readonly("rho", [](py::object self) {
+            return fieldView(self, self.cast<LBMSolver&>().densityData());
+        })
+        .def_property_readonly("ux", [](py::object self) {
+            return fieldView(self, self.cast<LBMSolver&>().velocityXData());
+        })
+        .def_property_readonly("uy", [](py::object self) {
+            return fieldView(self, self.cast<LBMSolver&>().velocityYData());
+        })
+        // Read-only: writes would bypass setSolid() and leave the surface and
+        // activity caches stale
+        .def_property_readonly("obstacle", [](py::object self) {
+            py::array_t<uint8_t> view = fieldView(self, self.cast<LBMSolver&>().obstacleData());
+            view.attr("setflags")(py::arg("write") = false);
+            return view;
+        })
+        // Whole-mask counterpart of setSolid(); only cells that change are set
+        .def("set_solid", [](LBMSolver& s, py::array_t<uint8_t, py::array::forcecast> mask) {
+            if (mask.ndim() != 2 || mask.shape(0) != s.getHeight() || mask.shape(1) != s.getWidth()) {
+                throw py::value_error("set_solid: mask must have shape (height, width)");
+            }
+            auto m = mask.unchecked<2>();
+            const uint8_t* obstacle = s.obstacleData();
+            for (int j = 0; j < s.getHeight(); j++) {
+                for (int i = 0; i < s.getWidth(); i++) {
+                    bool solid = m(j, i) != 0;
+                    if (solid != (obstacle[static_cast<size_t>(i) * s.getColumnStride() + j] != 0)) {
+                        s.setSolid(i, j, solid);
+                    }
+                }
+            }
+        })
+        // None unless setStrainRateOutput(True); an existing view stays valid
+        // after disabling but is no longer updated
+        .def_property_readonly("strain_rate", [](py::object self) -> py::object {
+            double* data = self.cast<LBMSolver&>().strainRateData();
+            if (!data) return py::none();
+            return fieldView(self, data);
+        })
+        .def("populations", [](py::object self) {
+            LBMSolver& s = self.cast<LBMSolver&>();
+            std::vector<py::ssize_t> shape = {9, s.getHeight(), s.getWidth()};
+            std::vector<py::ssize_t> strides = {static_cast<py::ssize_t>(s.getPlaneStride() * sizeof(double)),
+                                                static_cast<py::ssize_t>(sizeof(double)),
+                                                static_cast<py::ssize_t>(s.getColumnStride() * sizeof(double))};
+            return py::array_t<double>(shape, strides, s.populationData(), self);
+        });
+}
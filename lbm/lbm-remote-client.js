@@ -0,0 +1,253 @@
+// Client for lbm-server: the native solver runs on a nearby workstation and
+// streams quantized, delta-compressed frames over a WebSocket (the protocol
+// is described at the top of lbm-server.cpp).
+// Same interface as LBMSolver / LBMSolverWASM so script.js drives it
+// unchanged: step() is a no-op because the server steps, render() draws the
+// latest frame scaled to the canvas, and the setters become control messages.
+// The page uses it when opened with ?lbm-server=ws://localhost:8765
+
+const LBM_FRAME_MAGIC = 0x464D424C;  // "LBMF"
+const LBM_FRAME_KEY = 1;
+const LBM_FRAME_DELTA = 2;
+const LBM_FRAME_MASK = 3;
+
+class LBMRemoteSolver {
+  constructor(canvas, url) {
+    this.canvas = canvas;
+    this.ctx = canvas.getContext('2d');
+    this.width = canvas.width;
+    this.height = canvas.height;
+    this.url = url;
+    this.visualMode = 'velocity';
+    this.showMesh = false;
+    this.isRunning = false;
+
+    // Latest server status (lattice size, parameters, stepsPerSecond)
+    this.status = null;
+    this.stepsPerSecond = 0;
+
+    // Quantized values of the latest frame and the obstacle mask, both at
+    // the server's frame resolution
+    this.frame = null;
+    this.header = null;
+    this.mask = null;
+    this.dirty = false;
+    this.frameCanvas = document.createElement('canvas');
+    this.frameCtx = this.frameCanvas.getContext('2d');
+
+    this.initPromise = this.connect();
+  }
+
+  static isSupported() {
+    return typeof WebSocket === 'function';
+  }
+
+  // Resolves on the first status message, rejects if the server is unreachable
+  connect() {
+    return new Promise((resolve, reject) => {
+      const socket = new WebSocket(this.url);
+      socket.binaryType = 'arraybuffer';
+      socket.onopen = () => {
+        this.send({ type: 'visualization', value: this.visualMode });
+      };
+      socket.onmessage = (event) => {
+        if (typeof event.data === 'string') {
+          const message = JSON.parse(event.data);
+          if (message.type === 'status') {
+            this.status = message;
+            this.stepsPerSecond = message.stepsPerSecond;
+            resolve();
+          }
+        } else {
+          this.receiveFrame(event.data);
+        }
+      };
+      socket.onerror = () => reject(new Error('Cannot connect to ' + this.url));
+      socket.onclose = () => {
+        this.socket = null;
+        console.warn('LBM server connection closed');
+      };
+      this.socket = socket;
+    });
+  }
+
+  send(message) {
+    if (this.socket && this.socket.readyState === WebSocket.OPEN) {
+      this.socket.send(JSON.stringify(message));
+    }
+  }
+
+  // The server pauses while no page has it running
+  get running() {
+    return this.isRunning;
+  }
+
+  set running(value) {
+    if (value !== this.isRunning) {
+      this.isRunning = value;
+      this.send({ type: 'run', value: value });
+    }
+  }
+
+  // PackBits: c < 128 copies c + 1 bytes, c >= 128 repeats one byte c - 125 times
+  static unpackBits(input, count) {
+    const out = new Uint8Array(count);
+    let pos = 0;
+    let o = 0;
+    while (pos < input.length) {
+      const c = input[pos++];
+      if (c < 128) {
+        if (o + c + 1 > count || pos + c + 1 > input.length) return null;
+        out.set(input.subarray(pos, pos + c + 1), o);
+        pos += c + 1;
+        o += c + 1;
+      } else {
+        if (o + c - 125 > count) return null;
+        out.fill(input[pos++], o, o + c - 125);
+        o += c - 125;
+      }
+    }
+    return o === count ? out : null;
+  }
+
+  receiveFrame(buffer) {
+    const view = new DataView(buffer);
+    if (buffer.byteLength < 32 || view.getUint32(0, true) !== LBM_FRAME_MAGIC) return;
+    const header = {
+      type: view.getUint8(4),
+      field: view.getUint8(5),
+      stride: view.getUint16(6, true),
+      frame: view.getUint32(8, true),
+      step: view.getUint32(12, true),
+      width: view.getUint32(16, true),
+      height: view.getUint32(20, true),
+      min: view.getFloat32(24, true),
+      max: view.getFloat32(28, true)
+    };
+    const cells = header.width * header.height;
+    const bytes = LBMRemoteSolver.unpackBits(new Uint8Array(buffer, 32), cells);
+    if (!bytes) return;
+
+    if (header.type === LBM_FRAME_MASK) {
+      this.mask = bytes;
+    } else if (header.type === LBM_FRAME_KEY) {
+      this.frame = bytes;
+      this.header = header;
+    } else if (header.type === LBM_FRAME_DELTA && this.frame && this.frame.length === cells) {
+      // Byte differences modulo 256; Uint8Array wraps on store
+      const frame = this.frame;
+      for (let i = 0; i < cells; i++) frame[i] += bytes[i];
+      this.header = header;
+    } else {
+      return;
+    }
+    this.dirty = true;
+  }
+
+  step() {
+    // Stepping happens on the server
+  }
+
+  reset() {
+    this.send({ type: 'reset' });
+  }
+
+  setGeometry(geom) {
+    this.send({ type: 'geometry', value: geom });
+  }
+
+  setVelocity(u0) {
+    this.send({ type: 'velocity', value: u0 });
+  }
+
+  setViscosity(nu) {
+    this.send({ type: 'viscosity', value: nu });
+  }
+
+  setVisualization(mode) {
+    this.visualMode = mode;
+    this.send({ type: 'visualization', value: mode });
+  }
+
+  toggleMesh(show) {
+    this.showMesh = show;
+  }
+
+  // Same blue -> cyan -> green -> yellow -> red map as the local solvers
+  static colormap(normalized) {
+    if (normalized < 0.25) {
+      return [0, Math.floor(normalized * 4 * 255), 255];
+    } else if (normalized < 0.5) {
+      return [0, 255, Math.floor((1 - (normalized - 0.25) * 4) * 255)];
+    } else if (normalized < 0.75) {
+      return [Math.floor((normalized - 0.5) * 4 * 255), 255, 0];
+    }
+    return [255, Math.floor((1 - (normalized - 0.75) * 4) * 255), 0];
+  }
+
+  // Colorize a new frame at its own resolution, then scale it to the canvas
+  render() {
+    const h = this.header;
+    if (!h) return;
+
+    if (this.dirty) {
+      if (this.frameCanvas.width !== h.width || this.frameCanvas.height !== h.height) {
+        this.frameCanvas.width = h.width;
+        this.frameCanvas.height = h.height;
+        this.imageData = this.frameCtx.createImageData(h.width, h.height);
+      }
+      const frame = this.frame;
+      const mask = this.mask && this.mask.length === frame.length ? this.mask : null;
+
+      // Values are scaled by the largest fluid value, as in the local render()
+      let maxQ = 0;
+      for (let i = 0; i < frame.length; i++) {
+        if (frame[i] > maxQ && !(mask && mask[i])) maxQ = frame[i];
+      }
+      const scale = (h.max - h.min) / 255;
+      const invMaxVal = 1.0 / Math.max(h.min + maxQ * scale, 0.01);
+      const lut = new Uint8ClampedArray(256 * 3);
+      for (let q = 0; q < 256; q++) {
+        lut.set(LBMRemoteSolver.colormap((h.min + q * scale) * invMaxVal), q * 3);
+      }
+
+      const data = this.imageData.data;
+      for (let i = 0; i < frame.length; i++) {
+        const idx = i * 4;
+        if (mask && mask[i]) {
+          // Solid objects in dark gray
+          data[idx] = 40;
+          data[idx + 1] = 40;
+          data[idx + 2] = 40;
+        } else {
+          const c = frame[i] * 3;
+          data[idx] = lut[c];
+          data[idx + 1] = lut[c + 1];
+          data[idx + 2] = lut[c + 2];
+        }
+        data[idx + 3] = 255;
+      }
+      this.frameCtx.putImageData(this.imageData, 0, 0);
+      this.dirty = false;
+    }
+
+    this.ctx.imageSmoothingEnabled = true;
+    this.ctx.drawImage(this.frameCanvas, 0, 0, this.width, this.height);
+
+    if (this.showMesh) {
+      this.ctx.strokeStyle = 'rgba(255, 255, 255, 0.15)';
+      this.ctx.lineWidth = 0.5;
+      const gridSpacing = 10;
+      this.ctx.beginPath();
+      for (let i = 0; i < this.width; i += gridSpacing) {
+        this.ctx.moveTo(i, 0);
+        this.ctx.lineTo(i, this.height);
+      }
+      for (let j = 0; j < this.height; j += gridSpacing) {
+        this.ctx.moveTo(0, j);
+        this.ctx.lineTo(this.width, j);
+      }
+      this.ctx.stroke();
+    }
+  }
+}
@@ -0,0 +1,243 @@
+#!/usr/bin/env node
+// Headless replay of a recorded page session
+// Replays a session saved by LBMSolverWASM.saveRecording() (geometry
+// switches, slider drags, view changes, steps and renders with the times
+// they happened) against an Emscripten build in Node.js as fast as it will
+// run. It times each kind of call, so reset and geometry-change latency and
+// the per-frame field exports are measured under the page's real mix of work
+// rather than a bare step loop. A render replays the module side of the
+// page's render(): the field for the current view, the obstacle mask, and
+// ux/uy when streamlines are shown. Canvas drawing is not included.
+//
+// Usage: node lbm-replay-node.js SESSION.json [--module lbm-solver-wasm.js]
+//                                [--repeat 1] [--json results.json]
+//                                [--baseline previous.json] [--max-regression 10]
+
+const fs = require('fs');
+const path = require('path');
+const { performance } = require('perf_hooks');
+const { loadModule } = require('./lbm-bench-node.js');
+
+// Field each view exports per frame, as in LBMSolverWASM.render()
+const VIEW_EXPORTS = { velocity: 'getVelocityMagnitude', vorticity: 'getVorticity', pressure: 'getPressure',
+  strain: 'getStrainRate' };
+
+function usage() {
+  console.error('Usage: node lbm-replay-node.js SESSION.json [--module FILE] [--repeat N] [--json FILE]\n' +
+    '       [--baseline FILE] [--max-regression PERCENT]');
+  process.exit(1);
+}
+
+function parseArgs(argv) {
+  const options = {
+    session: null,
+    module: 'lbm-solver-wasm.js',
+    repeat: 1,
+    json: null,
+    baseline: null,
+    maxRegression: null
+  };
+
+  for (let a = 2; a < argv.length; a++) {
+    const arg = argv[a];
+    if (!arg.startsWith('--')) {
+      options.session = arg;
+      continue;
+    }
+    const value = argv[++a];
+    if (value === undefined) usage();
+    if (arg === '--module') options.module = value;
+    else if (arg === '--repeat') options.repeat = Math.max(1, parseInt(value, 10));
+    else if (arg === '--json') options.json = value;
+    else if (arg === '--baseline') options.baseline = value;
+    else if (arg === '--max-regression') options.maxRegression = parseFloat(value);
+    else usage();
+  }
+  if (!options.session) usage();
+  return options;
+}
+
+// The solver class the page used; the double layout for sessions from
+// builds without the others
+function createSolver(M, session) {
+  if (session.layout === 'compressed' && typeof M.LBMCompressedSolver === 'function') {
+    return new M.LBMCompressedSolver(session.width, session.height, session.bits);
+  }
+  if ((session.layout === 'fixed16' || session.layout === 'fixed32') &&
+      typeof M['LBMFixedSolver' + session.bits] === 'function') {
+    return new M['LBMFixedSolver' + session.bits](session.width, session.height);
+  }
+  return new M.LBMSolver(session.width, session.height);
+}
+
+// Embind vectors must be freed; plain arrays need nothing
+function release(v) {
+  if (v && typeof v.delete === 'function') v.delete();
+}
+
+function replay(M, session) {
+  const solver = createSolver(M, session);
+  const timings = {};
+  const time = (name, fn, units = 1) => {
+    const start = performance.now();
+    fn();
+    const ms = performance.now() - start;
+    const t = timings[name] || (timings[name] = { calls: 0, units: 0, totalMs: 0, samples: [] });
+    t.calls++;
+    t.units += units;
+    t.totalMs += ms;
+    t.samples.push(ms / units);
+  };
+
+  let view = 'velocity';
+  let mesh = false;
+  const wallStart = performance.now();
+  for (const e of session.events) {
+    switch (e.op) {
+      case 'step':
+        time('step', () => { for (let s = 0; s < e.count; s++) solver.step(); }, e.count);
+        break;
+      case 'reset':
+        time('reset', () => solver.reset());
+        break;
+      case 'setGeometry':
+        time('setGeometry', () => solver.setGeometry(e.value));
+        break;
+      case 'setVelocity':
+        time('setVelocity', () => solver.setVelocity(e.value));
+        break;
+      case 'setViscosity':
+        time('setViscosity', () => solver.setViscosity(e.value));
+        break;
+      case 'setVisualization':
+        view = e.value;
+        break;
+      case 'toggleMesh':
+        mesh = e.value;
+        break;
+      case 'render':
+        time('render:' + view + (mesh ? '+streamlines' : ''), () => {
+          release(solver[VIEW_EXPORTS[view] || VIEW_EXPORTS.velocity]());
+          release(solver.getObstacle());
+          if (mesh) {
+            release(solver.getUx());
+            release(solver.getUy());
+          }
+        });
+        break;
+      default:
+        break;  // calls added after this replayer are skipped
+    }
+  }
+  const wallMs = performance.now() - wallStart;
+  solver.delete();
+  return { wallMs, timings };
+}
+
+function percentile(sorted, p) {
+  return sorted[Math.min(sorted.length - 1, Math.floor(p / 100 * sorted.length))];
+}
+
+// Per kind of call: calls, total and mean milliseconds, p95 and max (per
+// step for step events)
+function summarise(runs) {
+  const merged = {};
+  for (const run of runs) {
+    for (const [name, t] of Object.entries(run.timings)) {
+      const m = merged[name] || (merged[name] = { calls: 0, units: 0, totalMs: 0, samples: [] });
+      m.calls += t.calls;
+      m.units += t.units;
+      m.totalMs += t.totalMs;
+      m.samples.push(...t.samples);
+    }
+  }
+  const results = {};
+  for (const [name, m] of Object.entries(merged)) {
+    const sorted = m.samples.slice().sort((a, b) => a - b);
+    results[name] = {
+      calls: m.calls,
+      units: m.units,
+      total_ms: m.totalMs,
+      mean_ms: m.totalMs / m.units,
+      p95_ms: percentile(sorted, 95),
+      max_ms: sorted[sorted.length - 1]
+    };
+  }
+  return results;
+}
+
+// Compare mean latencies with an earlier --json run of the same session.
+// Returns false if any kind of call got more than maxRegression percent
+// slower; calls that took under a millisecond in total are too noisy to judge.
+function compareBaseline(results, baselinePath, maxRegression) {
+  const baseline = JSON.parse(fs.readFileSync(baselinePath, 'utf8')).results || {};
+  let ok = true;
+
+  console.log('\nCompared with ' + baselinePath + ':');
+  for (const [name, r] of Object.entries(results)) {
+    const match = baseline[name];
+    if (!match) continue;
+    const change = (r.mean_ms / match.mean_ms - 1) * 100;
+    const regressed = maxRegression !== null && change > maxRegression && match.total_ms >= 1;
+    if (regressed) ok = false;
+    console.log('  ' + name.padEnd(28) + ' ' + r.mean_ms.toFixed(3) + ' vs ' + match.mean_ms.toFixed(3) + ' ms (' +
+      (change >= 0 ? '+' : '') + change.toFixed(1) + '%)' + (regressed ? '  REGRESSION' : ''));
+  }
+  return ok;
+}
+
+async function main() {
+  const options = parseArgs(process.argv);
+  const session = JSON.parse(fs.readFileSync(options.session, 'utf8'));
+  if (session.version !== 1 || !Array.isArray(session.events)) {
+    console.error(options.session + ' is not a recorded LBM session');
+    process.exit(1);
+  }
+
+  let M;
+  try {
+    M = await loadModule(options.module);
+  } catch (e) {
+    console.error('Cannot load ' + options.module + ': ' + e.message);
+    process.exit(1);
+  }
+
+  const steps = session.events.reduce((n, e) => n + (e.op === 'step' ? e.count : 0), 0);
+  console.log('Node ' + process.version + ', ' + require('os').cpus()[0].model);
+  console.log(path.basename(options.session) + ': ' + session.width + 'x' + session.height + ' ' +
+    session.layout + ', ' + session.events.length + ' events, ' + steps + ' steps, recorded over ' +
+    (session.duration / 1000).toFixed(1) + ' s' + (session.module ? ' with the ' + session.module + ' module' : ''));
+
+  const runs = [];
+  for (let r = 0; r < options.repeat; r++) runs.push(replay(M, session));
+  const results = summarise(runs);
+  const wallMs = runs.reduce((sum, run) => sum + run.wallMs, 0) / runs.length;
+
+  console.log('\ncall                            calls   total (ms)    mean (ms)     p95 (ms)     max (ms)');
+  for (const [name, r] of Object.entries(results)) {
+    console.log(name.padEnd(28) + ' ' + String(r.calls).padStart(8) + ' ' + r.total_ms.toFixed(1).padStart(12) + ' ' +
+      r.mean_ms.toFixed(3).padStart(12) + ' ' + r.p95_ms.toFixed(3).padStart(12) + ' ' +
+      r.max_ms.toFixed(3).padStart(12));
+  }
+  if (results.step) {
+    console.log('\nsteps: ' + (session.width * session.height / results.step.mean_ms / 1000).toFixed(2) + ' MLUPS');
+  }
+  console.log('replay: ' + wallMs.toFixed(0) + ' ms per run, ' + (session.duration / wallMs).toFixed(1) +
+    'x the recorded time');
+
+  if (options.json) {
+    const out = { node: process.version, module: path.basename(options.module), session: path.basename(options.session),
+      width: session.width, height: session.height, layout: session.layout, repeat: options.repeat,
+      wall_ms: wallMs, results };
+    fs.writeFileSync(options.json, JSON.stringify(out, null, 2) + '\n');
+  }
+
+  if (options.baseline && !compareBaseline(results, options.baseline, options.maxRegression)) {
+    process.exitCode = 1;
+  }
+
+  // Pthread builds keep their worker pool alive
+  process.exit(process.exitCode || 0);
+}
+
+main();
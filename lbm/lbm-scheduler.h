@@ -0,0 +1,176 @@
+// Process-wide scheduler for several LBMSolver instances
+// Solvers added here step on one shared worker pool instead of each creating
+// its own threads (or all running serially on the caller), and their lattices
+// come from the shared LatticeArena. run(budget) spends a wall-time budget by
+// stride scheduling: the solver with the least weighted time so far steps
+// next, so at equal weights a small and a large simulation get the same share
+// of time. Solvers on hidden canvases run at hiddenWeight times their weight
+// (0 = paused until visible again); weight 0 pauses a solver outright.
+//
+// A solver must be removed before it is destroyed.
+#pragma once
+
+#include "lbm-solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+class LBMScheduler {
+public:
+    // cacheMegabytes: freed lattice memory the arena keeps for the next instance
+    explicit LBMScheduler(int threads = LBMSolver::getHardwareThreads(), double cacheMegabytes = 64.0)
+        : pool(std::make_shared<ThreadPool>(std::max(1, std::min(threads, 256)))) {
+        LatticeArena::instance().setCacheLimit(static_cast<size_t>(cacheMegabytes * 1024 * 1024));
+    }
+
+    ~LBMScheduler() {
+        for (Entry& e : entries) e.solver->attachPool(nullptr);
+    }
+
+    LBMScheduler(const LBMScheduler&) = delete;
+    LBMScheduler& operator=(const LBMScheduler&) = delete;
+
+    // Returns an id for the other calls; new solvers start level with the
+    // least-served one so they cannot monopolise the next budgets
+    int add(LBMSolver* solver, double weight) {
+        solver->attachPool(pool);
+        Entry e;
+        e.id = nextId++;
+        e.solver = solver;
+        e.weight = std::max(0.0, weight);
+        e.virtualTime = minVirtualTime(nullptr);
+        entries.push_back(e);
+        return e.id;
+    }
+
+    void remove(int id) {
+        for (size_t n = 0; n < entries.size(); n++) {
+            if (entries[n].id == id) {
+                entries[n].solver->attachPool(nullptr);
+                entries.erase(entries.begin() + n);
+                return;
+            }
+        }
+    }
+
+    void setVisible(int id, bool visible) {
+        Entry* e = find(id);
+        if (!e) return;
+        bool wasPaused = effectiveWeight(*e) == 0.0;
+        e->visible = visible;
+        if (wasPaused) catchUp(*e);
+    }
+
+    void setWeight(int id, double weight) {
+        Entry* e = find(id);
+        if (!e) return;
+        bool wasPaused = effectiveWeight(*e) == 0.0;
+        e->weight = std::max(0.0, weight);
+        if (wasPaused) catchUp(*e);
+    }
+
+    void setHiddenWeight(double weight) { hiddenWeight = std::max(0.0, weight); }
+
+    // Step solvers until budgetMs of wall time has been used; returns the
+    // number of steps taken (0 if no solver is eligible)
+    int run(double budgetMs) {
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now();
+        Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                                 std::chrono::duration<double, std::milli>(budgetMs));
+        for (Entry& e : entries) e.lastSteps = 0;
+
+        int steps = 0;
+        Clock::time_point now = start;
+        while (now < deadline) {
+            Entry* next = nullptr;
+            for (Entry& e : entries) {
+                if (effectiveWeight(e) > 0.0 && !e.solver->isHalted() &&
+                    (!next || e.virtualTime < next->virtualTime)) {
+                    next = &e;
+                }
+            }
+            if (!next) break;
+
+            next->solver->step();
+            Clock::time_point after = Clock::now();
+            double seconds = std::chrono::duration<double>(after - now).count();
+            next->virtualTime += seconds / effectiveWeight(*next);
+            next->seconds += seconds;
+            next->steps++;
+            next->lastSteps++;
+            steps++;
+            now = after;
+        }
+        return steps;
+    }
+
+    int getThreads() const { return pool->size(); }
+    int getSolverCount() const { return static_cast<int>(entries.size()); }
+
+    // Steps taken by one solver in the last run() / since it was added
+    int getLastSteps(int id) const {
+        const Entry* e = find(id);
+        return e ? e->lastSteps : 0;
+    }
+
+    int getSteps(int id) const {
+        const Entry* e = find(id);
+        return e ? e->steps : 0;
+    }
+
+    double getSeconds(int id) const {
+        const Entry* e = find(id);
+        return e ? e->seconds : 0.0;
+    }
+
+private:
+    struct Entry {
+        int id = 0;
+        LBMSolver* solver = nullptr;
+        double weight = 1.0;
+        bool visible = true;
+        double virtualTime = 0.0;  // seconds stepped / weight
+        double seconds = 0.0;
+        int steps = 0;
+        int lastSteps = 0;
+    };
+
+    std::shared_ptr<ThreadPool> pool;
+    std::vector<Entry> entries;
+    int nextId = 1;
+    double hiddenWeight = 0.1;
+
+    double effectiveWeight(const Entry& e) const { return e.visible ? e.weight : e.weight * hiddenWeight; }
+
+    double minVirtualTime(const Entry* exclude) const {
+        double t = 0.0;
+        bool any = false;
+        for (const Entry& e : entries) {
+            if (&e != exclude && effectiveWeight(e) > 0.0 && (!any || e.virtualTime < t)) {
+                t = e.virtualTime;
+                any = true;
+            }
+        }
+        return t;
+    }
+
+    // A solver resuming from a pause gets no burst for the time it was paused
+    void catchUp(Entry& e) { e.virtualTime = std::max(e.virtualTime, minVirtualTime(&e)); }
+
+    Entry* find(int id) {
+        for (Entry& e : entries) {
+            if (e.id == id) return &e;
+        }
+        return nullptr;
+    }
+
+    const Entry* find(int id) const {
+        for (const Entry& e : entries) {
+            if (e.id == id) return &e;
+        }
+        return nullptr;
+    }
+};
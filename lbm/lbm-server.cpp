@@ -0,0 +1,1192 @@
+// Local solver server
+// Runs the native multithreaded LBMSolver on a workstation and streams frames
+// to the page over a WebSocket (lbm-remote-client.js), so the browser only
+// decodes and draws while lattices far beyond what it could step itself run
+// next to it. The page's controls come back as text messages.
+//
+// Frame protocol (binary messages, little-endian, 32-byte header):
+//   u32 magic 'LBMF'  u8 type  u8 field  u16 stride  u32 frame  u32 step
+//   u32 width  u32 height  f32 min  f32 max
+// followed by width * height bytes (row-major) in PackBits run-length coding:
+//   type 1 (key)    quantized values q = round((v - min) / (max - min) * 255)
+//   type 2 (delta)  (q - previous q) mod 256 against the last frame sent to
+//                   this client, quantized with the range of the last key
+//                   frame; mostly zeros wherever the flow is steady
+//   type 3 (mask)   obstacle cells, 1 = solid (after connect and geometry changes)
+// The field is 0 velocity magnitude, 1 vorticity, 2 pressure; width and
+// height are the lattice sampled every `stride` cells.
+//
+// Controls (text messages, JSON objects):
+//   {"type":"velocity","value":0.1}     {"type":"viscosity","value":0.02}
+//   {"type":"geometry","value":"circle"} {"type":"visualization","value":"vorticity"}
+// Geometries are the solver's built-in bodies (circle, airfoil, square,
+// flat_plate or plate, triangle) and none; other controls are ignored.
+//   {"type":"run","value":true}          {"type":"reset"}
+// Each one is answered with {"type":"ack","control":...,"step":N}, N being
+// the step count when it was applied. A {"type":"status",...} message goes
+// out on connect and once a second. All clients share one solver, so a
+// control from any page affects every page.
+//
+// Browsers let any page open a WebSocket to localhost, so upgrades are only
+// accepted from the origins the page is normally served from: localhost,
+// 127.0.0.1 and [::1] over http(s). --allow-origin adds one more (repeatable,
+// "*" for any). Pages opened from a file send Origin "null", which any site
+// can also get from a sandboxed iframe, so they need --allow-origin null.
+// Requests without an Origin header come from non-browser clients and are
+// accepted.
+//
+// Build: ./build-native.sh
+// Usage: ./lbm-server [--port 8765] [--bind 127.0.0.1] [--size 700x350]
+//                     [--threads N] [--simd auto|scalar|sse4.2|avx2|avx512]
+//                     [--stride 1] [--fps 30] [--keyframe 60]
+//                     [--allow-origin https://host.example]
+//        ./lbm-server --selftest
+
+#include "lbm-solver.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// WebSocket handshake helpers (RFC 6455 needs SHA-1 and base64)
+
+static uint32_t rotl32(uint32_t x, int n) { return (x << n) | (x >> (32 - n)); }
+
+static void sha1(const std::string& input, uint8_t digest[20]) {
+    uint32_t h[5] = {0x67452301u, 0xEFCDAB89u, 0x98BADCFEu, 0x10325476u, 0xC3D2E1F0u};
+    std::vector<uint8_t> msg(input.begin(), input.end());
+    uint64_t bits = static_cast<uint64_t>(input.size()) * 8;
+    msg.push_back(0x80);
+    while (msg.size() % 64 != 56) msg.push_back(0);
+    for (int i = 7; i >= 0; i--) msg.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+
+    for (size_t chunk = 0; chunk < msg.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            const uint8_t* p = &msg[chunk + 4 * i];
+            w[i] = static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+                   static_cast<uint32_t>(p[2]) << 8 | p[3];
+        }
+        for (int i = 16; i < 80; i++) w[i] = rotl32(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999u;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1u;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDCu;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6u;
+            }
+            uint32_t t = rotl32(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl32(b, 30);
+            b = a;
+            a = t;
+        }
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+    for (int i = 0; i < 20; i++) digest[i] = static_cast<uint8_t>(h[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+static std::string base64(const uint8_t* data, size_t n) {
+    static const char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    for (size_t i = 0; i < n; i += 3) {
+        uint32_t v = static_cast<uint32_t>(data[i]) << 16;
+        if (i + 1 < n) v |= static_cast<uint32_t>(data[i + 1]) << 8;
+        if (i + 2 < n) v |= data[i + 2];
+        out += table[(v >> 18) & 63];
+        out += table[(v >> 12) & 63];
+        out += i + 1 < n ? table[(v >> 6) & 63] : '=';
+        out += i + 2 < n ? table[v & 63] : '=';
+    }
+    return out;
+}
+
+static std::string webSocketAccept(const std::string& key) {
+    uint8_t digest[20];
+    sha1(key + "258EAFA5-E914-47DA-95CA-C5AB0DC85B11", digest);
+    return base64(digest, 20);
+}
+
+// Server-to-client frames are never masked
+static void appendWebSocketFrame(std::string& out, int opcode, const std::string& payload) {
+    out += static_cast<char>(0x80 | opcode);
+    size_t n = payload.size();
+    if (n < 126) {
+        out += static_cast<char>(n);
+    } else if (n < 65536) {
+        out += static_cast<char>(126);
+        for (int i = 1; i >= 0; i--) out += static_cast<char>(n >> (8 * i));
+    } else {
+        out += static_cast<char>(127);
+        for (int i = 7; i >= 0; i--) out += static_cast<char>(static_cast<uint64_t>(n) >> (8 * i));
+    }
+    out += payload;
+}
+
+// ---------------------------------------------------------------------------
+// Frame codec
+
+enum class FrameType : uint8_t { Key = 1, Delta = 2, Mask = 3 };
+enum class FrameField : uint8_t { Velocity = 0, Vorticity = 1, Pressure = 2 };
+
+static const uint32_t frameMagic = 0x464D424C;  // "LBMF"
+static const size_t frameHeaderSize = 32;
+
+struct FrameHeader {
+    FrameType type;
+    FrameField field;
+    int stride;
+    uint32_t frame;
+    uint32_t step;
+    int width;
+    int height;
+    float min;
+    float max;
+};
+
+static const char* fieldName(FrameField field) {
+    switch (field) {
+    case FrameField::Velocity: return "velocity";
+    case FrameField::Vorticity: return "vorticity";
+    case FrameField::Pressure: return "pressure";
+    }
+    return "unknown";
+}
+
+static bool parseField(const std::string& name, FrameField& field) {
+    for (int f = 0; f <= static_cast<int>(FrameField::Pressure); f++) {
+        if (name == fieldName(static_cast<FrameField>(f))) {
+            field = static_cast<FrameField>(f);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void putU32(std::string& out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out += static_cast<char>(v >> (8 * i));
+}
+
+static uint32_t getU32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+           static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+static void writeHeader(std::string& out, const FrameHeader& h) {
+    uint32_t minBits, maxBits;
+    memcpy(&minBits, &h.min, 4);
+    memcpy(&maxBits, &h.max, 4);
+    putU32(out, frameMagic);
+    out += static_cast<char>(h.type);
+    out += static_cast<char>(h.field);
+    out += static_cast<char>(h.stride & 0xFF);
+    out += static_cast<char>(h.stride >> 8);
+    putU32(out, h.frame);
+    putU32(out, h.step);
+    putU32(out, static_cast<uint32_t>(h.width));
+    putU32(out, static_cast<uint32_t>(h.height));
+    putU32(out, minBits);
+    putU32(out, maxBits);
+}
+
+static bool readHeader(const std::string& msg, FrameHeader& h) {
+    if (msg.size() < frameHeaderSize) return false;
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(msg.data());
+    if (getU32(p) != frameMagic) return false;
+    h.type = static_cast<FrameType>(p[4]);
+    h.field = static_cast<FrameField>(p[5]);
+    h.stride = p[6] | p[7] << 8;
+    h.frame = getU32(p + 8);
+    h.step = getU32(p + 12);
+    h.width = static_cast<int>(getU32(p + 16));
+    h.height = static_cast<int>(getU32(p + 20));
+    uint32_t minBits = getU32(p + 24), maxBits = getU32(p + 28);
+    memcpy(&h.min, &minBits, 4);
+    memcpy(&h.max, &maxBits, 4);
+    return true;
+}
+
+// PackBits: control byte c < 128 copies the next c + 1 bytes, c >= 128
+// repeats the next byte c - 125 times (runs of 3..130)
+static void packBits(const uint8_t* data, size_t n, std::string& out) {
+    size_t i = 0;
+    while (i < n) {
+        size_t run = 1;
+        while (i + run < n && run < 130 && data[i + run] == data[i]) run++;
+        if (run >= 3) {
+            out += static_cast<char>(run + 125);
+            out += static_cast<char>(data[i]);
+            i += run;
+            continue;
+        }
+        size_t start = i;
+        while (i < n && i - start < 128) {
+            if (i + 2 < n && data[i] == data[i + 1] && data[i] == data[i + 2]) break;
+            i++;
+        }
+        out += static_cast<char>(i - start - 1);
+        out.append(reinterpret_cast<const char*>(data + start), i - start);
+    }
+}
+
+static bool unpackBits(const uint8_t* data, size_t n, std::vector<uint8_t>& out) {
+    size_t pos = 0;
+    size_t o = 0;
+    while (pos < n) {
+        uint8_t c = data[pos++];
+        size_t count = c < 128 ? c + 1 : c - 125;
+        if (o + count > out.size()) return false;
+        if (c < 128) {
+            if (pos + count > n) return false;
+            memcpy(&out[o], data + pos, count);
+            pos += count;
+        } else {
+            if (pos >= n) return false;
+            memset(&out[o], data[pos++], count);
+        }
+        o += count;
+    }
+    return o == out.size();
+}
+
+// The displayed field sampled every `stride` cells, row-major
+static void sampleField(const LBMSolver& s, FrameField field, int stride, std::vector<float>& values,
+                        int& w, int& h) {
+    int width = s.getWidth();
+    int height = s.getHeight();
+    w = (width + stride - 1) / stride;
+    h = (height + stride - 1) / stride;
+    values.resize(static_cast<size_t>(w) * h);
+    for (int jj = 0; jj < h; jj++) {
+        int j = jj * stride;
+        for (int ii = 0; ii < w; ii++) {
+            int i = ii * stride;
+            double v = 0.0;
+            switch (field) {
+            case FrameField::Velocity:
+                v = std::sqrt(s.velocityX(i, j) * s.velocityX(i, j) + s.velocityY(i, j) * s.velocityY(i, j));
+                break;
+            case FrameField::Vorticity:
+                // Same central difference as the JavaScript export
+                if (i > 0 && i < width - 1 && j > 0 && j < height - 1) {
+                    v = (s.velocityY(i + 1, j) - s.velocityY(i - 1, j)) / 2.0 -
+                        (s.velocityX(i, j + 1) - s.velocityX(i, j - 1)) / 2.0;
+                }
+                break;
+            case FrameField::Pressure:
+                v = s.density(i, j) / 3.0;
+                break;
+            }
+            values[static_cast<size_t>(jj) * w + ii] = static_cast<float>(v);
+        }
+    }
+}
+
+static void sampleMask(const LBMSolver& s, int stride, std::vector<uint8_t>& mask) {
+    int w = (s.getWidth() + stride - 1) / stride;
+    int h = (s.getHeight() + stride - 1) / stride;
+    mask.resize(static_cast<size_t>(w) * h);
+    for (int jj = 0; jj < h; jj++) {
+        for (int ii = 0; ii < w; ii++) {
+            mask[static_cast<size_t>(jj) * w + ii] = s.solid(ii * stride, jj * stride) ? 1 : 0;
+        }
+    }
+}
+
+static void quantize(const std::vector<float>& values, float min, float max, std::vector<uint8_t>& q) {
+    q.resize(values.size());
+    float scale = max > min ? 255.0f / (max - min) : 0.0f;
+    for (size_t c = 0; c < values.size(); c++) {
+        float v = (values[c] - min) * scale + 0.5f;
+        q[c] = static_cast<uint8_t>(v <= 0.0f ? 0.0f : v >= 255.0f ? 255.0f : v);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Minimal JSON access for the flat control messages
+
+static size_t findKey(const std::string& json, const char* key) {
+    std::string quoted = std::string("\"") + key + "\"";
+    size_t pos = json.find(quoted);
+    if (pos == std::string::npos) return pos;
+    pos = json.find(':', pos + quoted.size());
+    if (pos == std::string::npos) return pos;
+    pos++;
+    while (pos < json.size() && isspace(static_cast<unsigned char>(json[pos]))) pos++;
+    return pos < json.size() ? pos : std::string::npos;
+}
+
+static bool jsonString(const std::string& json, const char* key, std::string& value) {
+    size_t pos = findKey(json, key);
+    if (pos == std::string::npos || json[pos] != '"') return false;
+    size_t end = json.find('"', pos + 1);
+    if (end == std::string::npos) return false;
+    value = json.substr(pos + 1, end - pos - 1);
+    return true;
+}
+
+// Quote-safe copy of a string for a JSON string literal
+static std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char ch : s) {
+        unsigned char u = static_cast<unsigned char>(ch);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (u < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", u);
+            out += esc;
+        } else {
+            out += ch;
+        }
+    }
+    return out;
+}
+
+static bool jsonNumber(const std::string& json, const char* key, double& value) {
+    size_t pos = findKey(json, key);
+    if (pos == std::string::npos) return false;
+    char* end = nullptr;
+    value = strtod(json.c_str() + pos, &end);
+    return end != json.c_str() + pos;
+}
+
+static bool jsonBool(const std::string& json, const char* key, bool& value) {
+    size_t pos = findKey(json, key);
+    if (pos == std::string::npos) return false;
+    if (json.compare(pos, 4, "true") == 0) {
+        value = true;
+    } else if (json.compare(pos, 5, "false") == 0) {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// Server
+
+struct ServerOptions {
+    std::string bind = "127.0.0.1";
+    int port = 8765;  // 0 = any free port
+    int width = 700;
+    int height = 350;
+    StepConfig step;
+    int stride = 1;
+    double fps = 30.0;  // frame rate cap, <= 0 = a frame after every step
+    int keyInterval = 60;  // frames between key frames
+    std::vector<std::string> allowOrigins;  // besides the local ones
+};
+
+// http(s)://localhost, 127.0.0.1 or [::1] with an optional port. Not "null":
+// sandboxed iframes on any site send that too.
+static bool isLocalOrigin(const std::string& origin) {
+    size_t scheme = origin.find("://");
+    if (scheme == std::string::npos) return false;
+    std::string protocol = origin.substr(0, scheme);
+    if (protocol != "http" && protocol != "https") return false;
+    std::string host = origin.substr(scheme + 3);
+    size_t port = host.rfind(':');
+    if (port != std::string::npos && host.find(']', port) == std::string::npos) {
+        if (port + 1 == host.size()) return false;
+        for (size_t i = port + 1; i < host.size(); i++) {
+            if (!isdigit(static_cast<unsigned char>(host[i]))) return false;
+        }
+        host.erase(port);
+    }
+    return host == "localhost" || host == "127.0.0.1" || host == "[::1]";
+}
+
+static bool originAllowed(const std::string& origin, const std::vector<std::string>& allowOrigins) {
+    if (isLocalOrigin(origin)) return true;
+    for (const std::string& allowed : allowOrigins) {
+        if (allowed == "*" || allowed == origin) return true;
+    }
+    return false;
+}
+
+struct Client {
+    int fd;
+    bool upgraded = false;
+    bool closing = false;  // close once `out` has been flushed
+    std::string in;
+    std::string out;
+    std::string message;  // fragments of the message being received
+    int messageOpcode = 0;
+    FrameField field = FrameField::Velocity;
+    bool needMask = true;
+    bool needKey = true;
+    std::vector<uint8_t> previous;  // last quantized frame sent
+    float rangeMin = 0.0f;
+    float rangeMax = 0.0f;
+    int framesSinceKey = 0;
+};
+
+class FrameServer {
+public:
+    explicit FrameServer(const ServerOptions& o) : options(o), solver(o.width, o.height) {
+        options.stride = std::max(1, std::min(options.stride, 65535));
+        solver.setStepConfig(options.step);
+    }
+
+    ~FrameServer() {
+        for (Client& c : clients) close(c.fd);
+        if (listenFd >= 0) close(listenFd);
+    }
+
+    bool listen() {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        if (listenFd < 0) return false;
+        int yes = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(options.port));
+        if (inet_pton(AF_INET, options.bind.c_str(), &addr.sin_addr) != 1) return false;
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) return false;
+        if (::listen(listenFd, 8) < 0) return false;
+        socklen_t len = sizeof(addr);
+        getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len);
+        boundPort = ntohs(addr.sin_port);
+        fcntl(listenFd, F_SETFL, O_NONBLOCK);
+        return true;
+    }
+
+    int port() const { return boundPort; }
+
+    void run(const std::atomic<bool>& stop) {
+        using Clock = std::chrono::steady_clock;
+        auto frameInterval = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(options.fps > 0.0 ? 1.0 / options.fps : 0.0));
+        Clock::time_point nextFrame = Clock::now();
+        Clock::time_point nextStatus = nextFrame;
+        int stepsSinceStatus = 0;
+
+        while (!stop) {
+            bool active = running && hasViewers();
+            if (active) {
+                solver.step();
+                stepsSinceStatus++;
+            }
+
+            Clock::time_point now = Clock::now();
+            if (now >= nextFrame) {
+                sendFrames();
+                nextFrame = now + frameInterval;
+            }
+            if (now >= nextStatus) {
+                double seconds = std::chrono::duration<double>(now - nextStatus).count() + 1.0;
+                stepsPerSecond = stepsSinceStatus / seconds;
+                stepsSinceStatus = 0;
+                broadcastText(statusMessage());
+                nextStatus = now + std::chrono::seconds(1);
+            }
+
+            // Keep stepping while running; otherwise sleep until the next frame or status
+            int timeoutMs = 0;
+            if (!active) {
+                auto wait = std::min(nextFrame, nextStatus) - Clock::now();
+                timeoutMs = static_cast<int>(std::max<long long>(
+                    0, std::min<long long>(100, std::chrono::duration_cast<std::chrono::milliseconds>(wait).count())));
+            }
+            pollSockets(timeoutMs);
+        }
+    }
+
+private:
+    ServerOptions options;
+    LBMSolver solver;
+    std::list<Client> clients;
+    int listenFd = -1;
+    int boundPort = 0;
+    bool running = false;
+    uint32_t frameCount = 0;
+    double stepsPerSecond = 0.0;
+    std::vector<float> values;
+
+    bool hasViewers() const {
+        for (const Client& c : clients) {
+            if (c.upgraded) return true;
+        }
+        return false;
+    }
+
+    std::string statusMessage() const {
+        StepConfig c = solver.getStepConfig();
+        std::string geometry = jsonEscape(solver.getGeometry());
+        char buf[512];
+        snprintf(buf, sizeof(buf),
+                 "{\"type\":\"status\",\"width\":%d,\"height\":%d,\"stride\":%d,\"velocity\":%.17g,"
+                 "\"viscosity\":%.17g,\"geometry\":\"%s\",\"running\":%s,\"step\":%d,"
+                 "\"stepsPerSecond\":%.1f,\"mlups\":%.2f,\"threads\":%d,\"simd\":\"%s\"}",
+                 solver.getWidth(), solver.getHeight(), options.stride, solver.getVelocity(),
+                 solver.getViscosity(), geometry.c_str(), running ? "true" : "false",
+                 solver.getStepCount(), stepsPerSecond,
+                 stepsPerSecond * solver.getWidth() * solver.getHeight() / 1.0e6, c.threads,
+                 lbm_kernels::simdLevelName(c.simd));
+        return buf;
+    }
+
+    void sendText(Client& c, const std::string& text) {
+        if (c.upgraded && !c.closing) appendWebSocketFrame(c.out, 0x1, text);
+    }
+
+    void broadcastText(const std::string& text) {
+        for (Client& c : clients) sendText(c, text);
+    }
+
+    void sendFrames() {
+        frameCount++;
+        // Each field is sampled at most once per frame, whoever watches it
+        bool sampled[3] = {false, false, false};
+        std::vector<float> fieldValues[3];
+        std::vector<uint8_t> mask;
+        bool maskSampled = false;
+
+        for (Client& c : clients) {
+            // Skip clients still draining the previous frame; their next
+            // delta is taken against the last frame they actually received
+            if (!c.upgraded || c.closing || !c.out.empty()) continue;
+
+            if (c.needMask) {
+                if (!maskSampled) {
+                    sampleMask(solver, options.stride, mask);
+                    maskSampled = true;
+                }
+                FrameHeader h = header(FrameType::Mask, c.field, 0.0f, 1.0f);
+                std::string payload;
+                writeHeader(payload, h);
+                packBits(mask.data(), mask.size(), payload);
+                appendWebSocketFrame(c.out, 0x2, payload);
+                c.needMask = false;
+            }
+
+            int f = static_cast<int>(c.field);
+            if (!sampled[f]) {
+                int w, h;
+                sampleField(solver, c.field, options.stride, fieldValues[f], w, h);
+                sampled[f] = true;
+            }
+            sendField(c, fieldValues[f]);
+        }
+    }
+
+    FrameHeader header(FrameType type, FrameField field, float min, float max) const {
+        FrameHeader h;
+        h.type = type;
+        h.field = field;
+        h.stride = options.stride;
+        h.frame = frameCount;
+        h.step = static_cast<uint32_t>(solver.getStepCount());
+        h.width = (solver.getWidth() + options.stride - 1) / options.stride;
+        h.height = (solver.getHeight() + options.stride - 1) / options.stride;
+        h.min = min;
+        h.max = max;
+        return h;
+    }
+
+    void sendField(Client& c, const std::vector<float>& field) {
+        float lo = field.empty() ? 0.0f : field[0];
+        float hi = lo;
+        for (float v : field) {
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+
+        // A new key frame when the range no longer fits the last one (values
+        // would clip) or has shrunk to under a quarter (resolution is wasted)
+        float span = c.rangeMax - c.rangeMin;
+        bool key = c.needKey || c.framesSinceKey >= options.keyInterval || lo < c.rangeMin ||
+                   hi > c.rangeMax || (hi - lo) < 0.25f * span;
+        if (key) {
+            // Headroom so a slowly growing range does not force a key frame every time
+            float margin = 0.1f * (hi - lo);
+            c.rangeMin = lo - margin;
+            c.rangeMax = hi + margin;
+        }
+
+        std::vector<uint8_t> q;
+        quantize(field, c.rangeMin, c.rangeMax, q);
+
+        std::string payload;
+        writeHeader(payload, header(key ? FrameType::Key : FrameType::Delta, c.field, c.rangeMin, c.rangeMax));
+        if (key) {
+            packBits(q.data(), q.size(), payload);
+            c.framesSinceKey = 0;
+            c.needKey = false;
+        } else {
+            std::vector<uint8_t> delta(q.size());
+            for (size_t i = 0; i < q.size(); i++) delta[i] = static_cast<uint8_t>(q[i] - c.previous[i]);
+            packBits(delta.data(), delta.size(), payload);
+            c.framesSinceKey++;
+        }
+        c.previous.swap(q);
+        appendWebSocketFrame(c.out, 0x2, payload);
+    }
+
+    void handleControl(Client& c, const std::string& json) {
+        std::string type, name;
+        double number;
+        bool flag;
+        if (!jsonString(json, "type", type)) return;
+        int step = solver.getStepCount();
+
+        if (type == "velocity" && jsonNumber(json, "value", number) && std::isfinite(number)) {
+            solver.setVelocity(number);
+        } else if (type == "viscosity" && jsonNumber(json, "value", number) && number > 0.0 && std::isfinite(number)) {
+            solver.setViscosity(number);
+        } else if (type == "geometry" && jsonString(json, "value", name)) {
+            // Built-in bodies only; the page calls the flat plate "plate"
+            if (name == "plate") name = "flat_plate";
+            if (name != "none" && LBMSolver::bodyLength(name, 1.0) <= 0.0) return;
+            solver.setGeometry(name);
+            for (Client& other : clients) {
+                other.needMask = true;
+                other.needKey = true;
+            }
+        } else if (type == "visualization" && jsonString(json, "value", name)) {
+            FrameField field;
+            if (!parseField(name, field)) return;
+            c.field = field;
+            c.needKey = true;
+        } else if (type == "run" && jsonBool(json, "value", flag)) {
+            running = flag;
+        } else if (type == "reset") {
+            solver.reset();
+            for (Client& other : clients) other.needKey = true;
+        } else {
+            return;
+        }
+        char ack[128];
+        snprintf(ack, sizeof(ack), "{\"type\":\"ack\",\"control\":\"%s\",\"step\":%d}", type.c_str(), step);
+        broadcastText(ack);
+    }
+
+    void pollSockets(int timeoutMs) {
+        std::vector<pollfd> fds;
+        fds.push_back({listenFd, POLLIN, 0});
+        for (Client& c : clients) {
+            short events = POLLIN;
+            if (!c.out.empty()) events |= POLLOUT;
+            fds.push_back({c.fd, events, 0});
+        }
+        if (poll(fds.data(), fds.size(), timeoutMs) <= 0) return;
+
+        size_t n = 1;
+        for (auto it = clients.begin(); it != clients.end(); n++) {
+            short revents = fds[n].revents;
+            bool alive = true;
+            if (revents & (POLLERR | POLLNVAL)) alive = false;
+            if (alive && (revents & (POLLIN | POLLHUP))) alive = readClient(*it);
+            if (alive && (revents & POLLOUT)) alive = writeClient(*it);
+            if (alive) {
+                ++it;
+            } else {
+                close(it->fd);
+                it = clients.erase(it);
+            }
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd;
+            while ((fd = accept(listenFd, nullptr, nullptr)) >= 0) {
+                fcntl(fd, F_SETFL, O_NONBLOCK);
+                int yes = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+                clients.emplace_back();
+                clients.back().fd = fd;
+            }
+        }
+    }
+
+    bool writeClient(Client& c) {
+        while (!c.out.empty()) {
+            ssize_t sent = send(c.fd, c.out.data(), c.out.size(), MSG_NOSIGNAL);
+            if (sent < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+            c.out.erase(0, static_cast<size_t>(sent));
+        }
+        return !c.closing;
+    }
+
+    bool readClient(Client& c) {
+        char buf[4096];
+        ssize_t got = recv(c.fd, buf, sizeof(buf), 0);
+        if (got == 0) return false;
+        if (got < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        c.in.append(buf, static_cast<size_t>(got));
+        if (!c.upgraded && !handshake(c)) return false;
+        return c.upgraded ? readMessages(c) : true;
+    }
+
+    bool handshake(Client& c) {
+        size_t end = c.in.find("\r\n\r\n");
+        if (end == std::string::npos) return c.in.size() < 16384;
+        std::string request = c.in.substr(0, end + 2);
+        c.in.erase(0, end + 4);
+
+        std::string lower = request;
+        for (char& ch : lower) ch = static_cast<char>(tolower(static_cast<unsigned char>(ch)));
+        size_t pos = lower.find("\r\nsec-websocket-key:");
+        if (pos == std::string::npos) {
+            static const char body[] = "This is the LBM frame server; connect with a WebSocket.\n";
+            char reply[256];
+            snprintf(reply, sizeof(reply),
+                     "HTTP/1.1 426 Upgrade Required\r\nSec-WebSocket-Version: 13\r\n"
+                     "Content-Type: text/plain\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n%s",
+                     sizeof(body) - 1, body);
+            c.out += reply;
+            c.closing = true;
+            return true;
+        }
+        if (!upgradeAllowed(request, lower)) {
+            c.out += "HTTP/1.1 403 Forbidden\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            c.closing = true;
+            return true;
+        }
+        pos += strlen("\r\nsec-websocket-key:");
+        size_t eol = request.find("\r\n", pos);
+        std::string key = request.substr(pos, eol - pos);
+        key.erase(0, key.find_first_not_of(" \t"));
+        key.erase(key.find_last_not_of(" \t") + 1);
+
+        c.out += "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                 "Sec-WebSocket-Accept: " + webSocketAccept(key) + "\r\n\r\n";
+        c.upgraded = true;
+        sendText(c, statusMessage());
+        return true;
+    }
+
+    // Refuses cross-site pages; see the top of the file
+    bool upgradeAllowed(const std::string& request, const std::string& lower) const {
+        size_t pos = lower.find("\r\norigin:");
+        if (pos == std::string::npos) return true;
+        pos += strlen("\r\norigin:");
+        std::string origin = request.substr(pos, request.find("\r\n", pos) - pos);
+        origin.erase(0, origin.find_first_not_of(" \t"));
+        origin.erase(origin.find_last_not_of(" \t") + 1);
+        if (originAllowed(origin, options.allowOrigins)) return true;
+        fprintf(stderr, "Refused WebSocket upgrade from origin %s (see --allow-origin)\n", origin.c_str());
+        return false;
+    }
+
+    // Client frames are always masked; control messages are small
+    bool readMessages(Client& c) {
+        const size_t maxMessage = 1 << 20;
+        for (;;) {
+            if (c.in.size() < 2) return true;
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(c.in.data());
+            bool fin = p[0] & 0x80;
+            int opcode = p[0] & 0x0F;
+            if (!(p[1] & 0x80)) return false;
+            uint64_t length = p[1] & 0x7F;
+            size_t pos = 2;
+            if (length == 126 || length == 127) {
+                size_t bytes = length == 126 ? 2 : 8;
+                if (c.in.size() < pos + bytes) return true;
+                length = 0;
+                for (size_t i = 0; i < bytes; i++) length = length << 8 | p[pos + i];
+                pos += bytes;
+            }
+            if (length > maxMessage) return false;
+            if (c.in.size() < pos + 4 + length) return true;
+            const uint8_t* maskKey = p + pos;
+            pos += 4;
+            std::string payload(length, '\0');
+            for (size_t i = 0; i < length; i++) payload[i] = static_cast<char>(p[pos + i] ^ maskKey[i % 4]);
+            c.in.erase(0, pos + length);
+
+            if (opcode == 0x8) {
+                appendWebSocketFrame(c.out, 0x8, payload.substr(0, 2));
+                c.closing = true;
+                return true;
+            } else if (opcode == 0x9) {
+                appendWebSocketFrame(c.out, 0xA, payload);
+            } else if (opcode == 0x0 || opcode == 0x1 || opcode == 0x2) {
+                if (opcode != 0x0) c.messageOpcode = opcode;
+                c.message += payload;
+                if (c.message.size() > maxMessage) return false;
+                if (fin) {
+                    if (c.messageOpcode == 0x1) handleControl(c, c.message);
+                    c.message.clear();
+                }
+            }
+        }
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Loopback self-test: a client in this process connects over TCP, drives the
+// controls and checks every decoded frame byte for byte against a second
+// solver stepped and quantized the same way
+
+class TestClient {
+public:
+    ~TestClient() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool connectTo(int port) {
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+        timeval timeout = {10, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        return connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+
+    // The status line of the reply is left in `status`
+    bool handshake(const std::string& origin = "http://localhost:8000") {
+        const std::string key = "dGhlIHNhbXBsZSBub25jZQ==";
+        std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\n"
+                              "Connection: Upgrade\r\nSec-WebSocket-Key: " + key +
+                              "\r\nSec-WebSocket-Version: 13\r\nOrigin: " + origin + "\r\n\r\n";
+        if (!sendAll(request)) return false;
+        size_t end;
+        while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+            if (!fill()) return false;
+        }
+        std::string response = buffer.substr(0, end);
+        buffer.erase(0, end + 4);
+        status = response.substr(0, response.find("\r\n"));
+        return response.compare(0, 12, "HTTP/1.1 101") == 0 &&
+               response.find("Sec-WebSocket-Accept: " + webSocketAccept(key)) != std::string::npos;
+    }
+
+    // Client frames must be masked
+    bool sendText(const std::string& text) {
+        const uint8_t mask[4] = {0x12, 0x34, 0x56, 0x78};
+        std::string frame;
+        frame += static_cast<char>(0x81);
+        frame += static_cast<char>(0x80 | text.size());
+        frame.append(reinterpret_cast<const char*>(mask), 4);
+        for (size_t i = 0; i < text.size(); i++) frame += static_cast<char>(text[i] ^ mask[i % 4]);
+        return sendAll(frame);
+    }
+
+    bool receive(int& opcode, std::string& payload) {
+        for (;;) {
+            if (buffer.size() >= 2) {
+                const uint8_t* p = reinterpret_cast<const uint8_t*>(buffer.data());
+                uint64_t length = p[1] & 0x7F;
+                size_t pos = 2;
+                size_t bytes = length == 126 ? 2 : length == 127 ? 8 : 0;
+                if (buffer.size() >= pos + bytes) {
+                    if (bytes) {
+                        length = 0;
+                        for (size_t i = 0; i < bytes; i++) length = length << 8 | p[pos + i];
+                        pos += bytes;
+                    }
+                    if (buffer.size() >= pos + length) {
+                        opcode = p[0] & 0x0F;
+                        payload = buffer.substr(pos, length);
+                        buffer.erase(0, pos + length);
+                        bytesReceived += pos + length;
+                        return true;
+                    }
+                }
+            }
+            if (!fill()) return false;
+        }
+    }
+
+    size_t bytesReceived = 0;
+    std::string status;
+
+private:
+    int fd = -1;
+    std::string buffer;
+
+    bool sendAll(const std::string& data) {
+        return send(fd, data.data(), data.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(data.size());
+    }
+
+    bool fill() {
+        char buf[65536];
+        ssize_t got = recv(fd, buf, sizeof(buf), 0);
+        if (got <= 0) return false;
+        buffer.append(buf, static_cast<size_t>(got));
+        return true;
+    }
+};
+
+static int fail(const char* what) {
+    fprintf(stderr, "Self-test FAILED: %s\n", what);
+    return 1;
+}
+
+static int runSelfTest() {
+    if (webSocketAccept("dGhlIHNhbXBsZSBub25jZQ==") != "s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") {
+        return fail("Sec-WebSocket-Accept does not match RFC 6455");
+    }
+    std::vector<uint8_t> sample(1000), unpacked(1000);
+    for (size_t i = 0; i < sample.size(); i++) sample[i] = static_cast<uint8_t>(i < 400 ? i * 7 : i / 100);
+    std::string packed;
+    packBits(sample.data(), sample.size(), packed);
+    if (!unpackBits(reinterpret_cast<const uint8_t*>(packed.data()), packed.size(), unpacked) || unpacked != sample) {
+        return fail("PackBits round trip");
+    }
+    for (const char* origin : {"http://localhost:8000", "https://127.0.0.1", "http://[::1]:8080"}) {
+        if (!isLocalOrigin(origin)) return fail("local origin refused");
+    }
+    for (const char* origin : {"http://localhost.evil.example", "https://evil.example", "http://127.0.0.1.nip.io:80",
+                               "ws://localhost", "http://localhost:", "null"}) {
+        if (isLocalOrigin(origin)) return fail("foreign origin taken for a local one");
+    }
+    // Origin "null" (file:// pages, sandboxed iframes) only with --allow-origin null
+    if (originAllowed("null", {}) || originAllowed("null", {"https://lbm.example"}) ||
+        !originAllowed("null", {"null"}) || !originAllowed("null", {"*"})) {
+        return fail("Origin null not refused by default and accepted with --allow-origin null");
+    }
+
+    ServerOptions options;
+    options.port = 0;
+    options.width = 160;
+    options.height = 80;
+    options.step.threads = 2;
+    options.stride = 2;
+    options.fps = 0.0;
+    options.keyInterval = 16;
+    options.allowOrigins = {"https://lbm.example"};
+    FrameServer server(options);
+    if (!server.listen()) return fail("cannot listen on 127.0.0.1");
+    std::atomic<bool> stop(false);
+    std::thread serverThread([&] { server.run(stop); });
+
+    LBMSolver reference(options.width, options.height);
+    reference.setStepConfig(options.step);
+
+    TestClient client;
+    int result = 0;
+    int frames = 0, keys = 0;
+    size_t rawBytes = 0;
+    std::vector<uint8_t> frame, decoded, expected, mask;
+    std::vector<float> values;
+
+    // Controls sent once this many frames have arrived; refused ones must
+    // leave the flow alone, which the frame comparison would catch
+    struct ScriptedControl {
+        int afterFrames;
+        const char* json;
+        bool refused = false;
+    };
+    const ScriptedControl script[] = {
+        {0, "{\"type\":\"run\",\"value\":true}"},
+        {10, "{\"type\":\"velocity\",\"value\":0.12}"},
+        {20, "{\"type\":\"visualization\",\"value\":\"vorticity\"}"},
+        {30, "{\"type\":\"geometry\",\"value\":\"square\"}"},
+        {35, "{\"type\":\"geometry\",\"value\":\"bogus\\\\\"}", true},
+        {40, "{\"type\":\"viscosity\",\"value\":0.03}"},
+        {50, "{\"type\":\"visualization\",\"value\":\"pressure\"}"},
+        {60, "{\"type\":\"reset\"}"},
+    };
+    size_t nextControl = 0;
+    const int totalFrames = 80;
+
+    // A foreign page and Origin null are refused, one added with
+    // --allow-origin is not
+    {
+        TestClient foreign, sandboxed, allowed;
+        if (!foreign.connectTo(server.port()) || foreign.handshake("https://evil.example") ||
+            foreign.status.compare(0, 12, "HTTP/1.1 403") != 0) {
+            result = fail("WebSocket upgrade from a foreign origin was not refused");
+        } else if (!sandboxed.connectTo(server.port()) || sandboxed.handshake("null") ||
+                   sandboxed.status.compare(0, 12, "HTTP/1.1 403") != 0) {
+            result = fail("WebSocket upgrade from Origin null was not refused");
+        } else if (!allowed.connectTo(server.port()) || !allowed.handshake("https://lbm.example")) {
+            result = fail("WebSocket upgrade from an --allow-origin origin was refused");
+        }
+    }
+    if (result == 0 && (!client.connectTo(server.port()) || !client.handshake())) {
+        result = fail("WebSocket handshake");
+    }
+    while (result == 0 && frames < totalFrames) {
+        while (nextControl < sizeof(script) / sizeof(script[0]) && script[nextControl].afterFrames <= frames) {
+            client.sendText(script[nextControl++].json);
+        }
+        int opcode;
+        std::string payload;
+        if (!client.receive(opcode, payload)) {
+            result = fail("connection closed or timed out");
+            break;
+        }
+
+        if (opcode == 0x1) {
+            // Replay acknowledged controls on the reference at the same step
+            std::string type, name;
+            double number = 0.0, step = 0.0;
+            if (!jsonString(payload, "type", type) || type != "ack") continue;
+            jsonNumber(payload, "step", step);
+            std::string control;
+            jsonString(payload, "control", control);
+            while (reference.getStepCount() < static_cast<int>(step)) reference.step();
+            for (const ScriptedControl& s : script) {
+                std::string sType;
+                jsonString(s.json, "type", sType);
+                if (sType != control || s.refused) continue;
+                if (control == "velocity" && jsonNumber(s.json, "value", number)) reference.setVelocity(number);
+                if (control == "viscosity" && jsonNumber(s.json, "value", number)) reference.setViscosity(number);
+                if (control == "geometry" && jsonString(s.json, "value", name)) reference.setGeometry(name);
+                if (control == "reset") reference.reset();
+            }
+            continue;
+        }
+
+        FrameHeader h;
+        if (opcode != 0x2 || !readHeader(payload, h)) {
+            result = fail("malformed binary message");
+            break;
+        }
+        if (static_cast<int>(h.step) < reference.getStepCount()) {
+            result = fail("frame step went backwards");
+            break;
+        }
+        while (reference.getStepCount() < static_cast<int>(h.step)) reference.step();
+
+        size_t cells = static_cast<size_t>(h.width) * h.height;
+        decoded.assign(cells, 0);
+        const uint8_t* body = reinterpret_cast<const uint8_t*>(payload.data()) + frameHeaderSize;
+        if (!unpackBits(body, payload.size() - frameHeaderSize, decoded)) {
+            result = fail("PackBits payload does not decode to width * height bytes");
+            break;
+        }
+
+        if (h.type == FrameType::Mask) {
+            sampleMask(reference, h.stride, mask);
+            if (decoded != mask) result = fail("obstacle mask differs from the reference");
+            continue;
+        }
+        if (h.type == FrameType::Key) {
+            frame = decoded;
+            keys++;
+        } else if (h.type == FrameType::Delta && frame.size() == cells) {
+            for (size_t i = 0; i < cells; i++) frame[i] = static_cast<uint8_t>(frame[i] + decoded[i]);
+        } else {
+            result = fail("delta frame without a key frame");
+            break;
+        }
+
+        int w, hgt;
+        sampleField(reference, h.field, h.stride, values, w, hgt);
+        quantize(values, h.min, h.max, expected);
+        if (w != h.width || hgt != h.height || frame != expected) {
+            fprintf(stderr, "frame %u (step %u, %s) differs from the reference\n", h.frame, h.step, fieldName(h.field));
+            result = fail("decoded frame mismatch");
+            break;
+        }
+        frames++;
+        rawBytes += cells * sizeof(float);
+    }
+
+    stop = true;
+    serverThread.join();
+    if (result != 0) return result;
+
+    printf("Self-test passed: %d frames (%d key) decoded and matched the reference solver\n", frames, keys);
+    printf("Received %zu bytes for %zu bytes of float32 fields (%.1fx smaller)\n", client.bytesReceived, rawBytes,
+           static_cast<double>(rawBytes) / client.bytesReceived);
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+
+static std::atomic<bool> stopRequested(false);
+
+static void onSignal(int) { stopRequested = true; }
+
+static SimdLevel parseSimd(const std::string& name) {
+    for (int level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(SimdLevel::SIMD128); level++) {
+        if (name == lbm_kernels::simdLevelName(static_cast<SimdLevel>(level))) return static_cast<SimdLevel>(level);
+    }
+    return SimdLevel::Auto;
+}
+
+int main(int argc, char** argv) {
+    ServerOptions options;
+    options.step.threads = LBMSolver::getHardwareThreads();
+
+    for (int a = 1; a < argc; a++) {
+        if (!strcmp(argv[a], "--selftest")) {
+            return runSelfTest();
+        } else if (!strcmp(argv[a], "--port") && a + 1 < argc) {
+            options.port = atoi(argv[++a]);
+        } else if (!strcmp(argv[a], "--bind") && a + 1 < argc) {
+            options.bind = argv[++a];
+        } else if (!strcmp(argv[a], "--size") && a + 1 < argc) {
+            if (sscanf(argv[++a], "%dx%d", &options.width, &options.height) != 2 || options.width < 3 ||
+                options.height < 3) {
+                fprintf(stderr, "Invalid size '%s'\n", argv[a]);
+                return 1;
+            }
+        } else if (!strcmp(argv[a], "--threads") && a + 1 < argc) {
+            options.step.threads = std::max(1, atoi(argv[++a]));
+        } else if (!strcmp(argv[a], "--simd") && a + 1 < argc) {
+            options.step.simd = parseSimd(argv[++a]);
+        } else if (!strcmp(argv[a], "--stride") && a + 1 < argc) {
+            options.stride = std::max(1, atoi(argv[++a]));
+        } else if (!strcmp(argv[a], "--fps") && a + 1 < argc) {
+            options.fps = atof(argv[++a]);
+        } else if (!strcmp(argv[a], "--keyframe") && a + 1 < argc) {
+            options.keyInterval = std::max(1, atoi(argv[++a]));
+        } else if (!strcmp(argv[a], "--allow-origin") && a + 1 < argc) {
+            options.allowOrigins.push_back(argv[++a]);
+        } else {
+            fprintf(stderr, "Usage: %s [--port 8765] [--bind 127.0.0.1] [--size WxH] [--threads N]\n"
+                            "       [--simd LEVEL] [--stride N] [--fps N] [--keyframe N] [--allow-origin ORIGIN]\n"
+                            "       %s --selftest\n", argv[0], argv[0]);
+            return 1;
+        }
+    }
+
+    FrameServer server(options);
+    if (!server.listen()) {
+        fprintf(stderr, "Cannot listen on %s:%d: %s\n", options.bind.c_str(), options.port, strerror(errno));
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    printf("LBM frame server: %dx%d lattice, %d threads, frames every %d cell(s)\n", options.width,
+           options.height, options.step.threads, options.stride);
+    printf("Open the page with ?lbm-server=ws://localhost:%d\n", server.port());
+    fflush(stdout);
+    server.run(stopRequested);
+    return 0;
+}
@@ -1,8 +1,42 @@
 // JavaScript wrapper for the WebAssembly LBM solver
 // This provides the same interface as the JavaScript version but uses the C++ WASM backend
 
+// Module builds produced by build-wasm.sh, fastest first. The loader picks the
+// first one whose features the browser supports and whose memory cap
+// (MAXIMUM_MEMORY) holds the lattice, and falls back to the next one if it
+// fails to load. The memory64 build is slower (64-bit bounds checks), so it
+// comes last and is only used for lattices beyond the wasm32 builds' cap.
+const LBM_WASM32_MAX_MEMORY = 268435456;
+// Module memory kept for the runtime, stacks and everything but lattices
+const LBM_RUNTIME_RESERVE = 16 * 1024 * 1024;
+const LBM_WASM_VARIANTS = [
+  { name: 'simd-threads', script: 'lbm-solver-wasm-simd-mt.js', factory: 'LBMModuleSIMDThreads', simd: true, threads: true, memory64: false, maxMemory: LBM_WASM32_MAX_MEMORY },
+  { name: 'simd', script: 'lbm-solver-wasm-simd.js', factory: 'LBMModuleSIMD', simd: true, threads: false, memory64: false, maxMemory: LBM_WASM32_MAX_MEMORY },
+  { name: 'baseline', script: 'lbm-solver-wasm.js', factory: 'Module', simd: false, threads: false, memory64: false, maxMemory: LBM_WASM32_MAX_MEMORY },
+  { name: 'memory64', script: 'lbm-solver-wasm-memory64.js', factory: 'LBMModuleMemory64', simd: true, threads: false, memory64: true, maxMemory: 17179869184 }
+];
+
+const LBM_WASM_DIR = 'lbm/';
+
+// Content hashes of the .wasm files, written by build-wasm.sh. Each file is
+// fetched at a URL versioned by its hash, so HTTP caches can keep it for
+// good and the browser's code cache keeps its compiled code under that URL.
+const LBM_WASM_MANIFEST = 'lbm-wasm-manifest.json';
+
 class LBMSolverWASM {
-  constructor(canvas, width, height) {
+  // options.compressedRate: store the lattice block-compressed at this many
+  // bits per value (LBMCompressedSolver, about 7x smaller at 16) instead of
+  // uncompressed; slower per step, for lattices the memory cap cannot hold.
+  // options.fixedPoint: 16 or 32 steps an integer lattice of that width
+  // (LBMFixedSolver16/32) whose results are bit-identical on every machine.
+  // Without either, the layout comes from planMemory(): the fastest one that
+  // fits options.memoryBudget (bytes, default: all the module can get) with
+  // the requested features (options.watchdog, options.reproducible,
+  // options.reducedPrecision). Read the decision from memoryPlan.
+  // options.previewScale (default 0.25, 0 = off): the first frames come from
+  // a lattice this much coarser, swapped for the full one after the first
+  // paint, so the page does not wait for its allocation and autotuning.
+  constructor(canvas, width, height, options = {}) {
     this.canvas = canvas;
     this.ctx = canvas.getContext('2d');
     this.width = width;
@@ -10,35 +44,640 @@ class LBMSolverWASM {
     this.running = false;
     this.visualMode = 'velocity';
     this.showMesh = false;
+    this.compressedRate = options.compressedRate > 0 ? LBMSolverWASM.compressedRate(options.compressedRate) : 0;
+    this.fixedPoint = options.fixedPoint === 16 || options.fixedPoint === 32 ? options.fixedPoint : 0;
+    this.memoryBudget = options.memoryBudget || Infinity;
+    this.memoryRequest = {
+      watchdog: options.watchdog === true,
+      reproducible: options.reproducible === true,
+      reducedPrecision: options.reducedPrecision !== false
+    };
+    this.memoryPlan = null;
+    this.recording = null;
+    this.previewScale = options.previewScale !== undefined ? options.previewScale : 0.25;
+    // Startup milliseconds since navigation (performance.now()), for the
+    // time-to-first-frame metric
+    this.startup = {};
 
-    // The C++ solver instance will be created when WASM loads
+    // The C++ solver instance will be created when WASM loads; its lattice
+    // is width x height except while the preview runs
     this.solver = null;
+    this.latticeWidth = width;
+    this.latticeHeight = height;
     this.wasmReady = false;
+    this.fullResolution = null;
 
     // Initialize when WASM module is ready
     this.initPromise = this.initWASM();
   }
 
+  // WebAssembly is available at all (the page falls back to the JS solver otherwise)
+  static isSupported() {
+    return typeof WebAssembly === 'object' && typeof WebAssembly.instantiate === 'function';
+  }
+
+  // Probe optional WebAssembly features by validating tiny modules
+  // (the same probes as the wasm-feature-detect library)
+  static detectFeatures() {
+    if (LBMSolverWASM.features) return LBMSolverWASM.features;
+
+    const validate = (bytes) => {
+      try {
+        return WebAssembly.validate(new Uint8Array(bytes));
+      } catch (e) {
+        return false;
+      }
+    };
+
+    // (func (result v128) i32.const 0 i8x16.splat i8x16.popcnt)
+    const simd = validate([0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2, 1, 0,
+      10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11]);
+    // Shared memory plus i32.atomic.load; pthreads also need SharedArrayBuffer,
+    // which browsers only expose on cross-origin isolated pages (COOP/COEP headers)
+    const atomics = validate([0, 97, 115, 109, 1, 0, 0, 0, 1, 4, 1, 96, 0, 0, 3, 2, 1, 0,
+      5, 4, 1, 3, 1, 1, 10, 11, 1, 9, 0, 65, 0, 254, 16, 2, 0, 26, 11]);
+    const threads = atomics && typeof SharedArrayBuffer === 'function' &&
+      self.crossOriginIsolated === true;
+    // (memory i64 1): a 64-bit memory
+    const memory64 = validate([0, 97, 115, 109, 1, 0, 0, 0, 5, 3, 1, 4, 1]);
+
+    LBMSolverWASM.features = { simd, threads, memory64 };
+    return LBMSolverWASM.features;
+  }
+
+  // The rate LBMCompressedSolver actually uses: a multiple of 4 in [12, 64];
+  // lower rates diverge on the default wind tunnel
+  static compressedRate(bits) {
+    return Math.max(12, Math.min(64, Math.ceil(bits / 4) * 4));
+  }
+
+  // Lattice bytes of one storage layout, exactly as the module's allocator
+  // counts them (requiredBytes() of LBMSolver, LBMFixedSolver and
+  // LBMCompressedSolver; keep in step with them). Columns are padded to 8
+  // cells and every buffer to 64 bytes.
+  static latticeBytes(layout, width, height, bits = 64, watchdog = false) {
+    const buffer = (count, size) => Math.ceil(count * size / 64) * 64;
+    const colStride = Math.ceil(height / 8) * 8;
+    if (layout === 'compressed') {
+      const rate = LBMSolverWASM.compressedRate(bits);
+      const tiles = Math.ceil(width / 4);
+      const tilePlane = 4 * colStride;
+      const tileWords = 12 * (colStride / 4) * (rate * 16 / 64);
+      const tileF = buffer(9 * tilePlane + 16, 8);
+      const scratch = 3 * (tileF + 3 * buffer(tilePlane, 8)) + 2 * tileF + buffer(9 * tilePlane, 8);
+      return buffer(tileWords * tiles, 8) + buffer(tilePlane * tiles, 1) + scratch;
+    }
+    const plane = colStride * width;
+    if (layout === 'fixed32' || layout === 'fixed16') {
+      return 2 * buffer(9 * plane + 16, bits / 8) + buffer(plane, 1);
+    }
+    const populations = buffer(9 * plane + 16, 8);
+    const fields = 3 * buffer(plane, 8);
+    const bytes = 2 * populations + fields + buffer(plane, 1);
+    return watchdog ? bytes + 2 * (populations + fields) : bytes;
+  }
+
+  // Module memory for one solver: its lattice plus 16 MB for the runtime
+  static estimateBytes(width, height, compressedRate = 0, fixedPoint = 0) {
+    const bytes = compressedRate > 0 ? LBMSolverWASM.latticeBytes('compressed', width, height, compressedRate)
+      : fixedPoint > 0 ? LBMSolverWASM.latticeBytes('fixed' + fixedPoint, width, height, fixedPoint)
+      : LBMSolverWASM.latticeBytes('double', width, height, 64, true);
+    return bytes + LBM_RUNTIME_RESERVE;
+  }
+
+  // Largest module memory this browser can get: the memory64 build's cap
+  // where it is supported, else the wasm32 builds'
+  static memoryCap() {
+    const features = LBMSolverWASM.detectFeatures();
+    let cap = 0;
+    for (const variant of LBM_WASM_VARIANTS) {
+      if ((variant.simd && !features.simd) || (variant.threads && !features.threads) ||
+          (variant.memory64 && !features.memory64)) continue;
+      cap = Math.max(cap, variant.maxMemory);
+    }
+    return cap;
+  }
+
+  // The JavaScript twin of lbm_planner::planMemory(), for deciding before
+  // the module is loaded: every layout's bytes, fastest first, and the first
+  // one with the requested features (watchdog, reproducible,
+  // reducedPrecision) whose lattice plus the runtime reserve fits budgetBytes.
+  static planMemory(width, height, request = {}) {
+    const budgetBytes = request.budgetBytes !== undefined ? request.budgetBytes : LBMSolverWASM.memoryCap();
+    const reserveBytes = request.reserveBytes !== undefined ? request.reserveBytes : LBM_RUNTIME_RESERVE;
+    const reducedPrecision = request.reducedPrecision !== false;
+    const candidates = [
+      { layout: 'double', bits: 64, watchdog: true, reproducible: false, reduced: false },
+      { layout: 'double', bits: 64, watchdog: false, reproducible: false, reduced: false },
+      { layout: 'fixed32', bits: 32, watchdog: false, reproducible: true, reduced: false },
+      { layout: 'fixed16', bits: 16, watchdog: false, reproducible: true, reduced: true },
+      { layout: 'compressed', bits: 24, watchdog: false, reproducible: false, reduced: true },
+      { layout: 'compressed', bits: 16, watchdog: false, reproducible: false, reduced: true }
+    ];
+    const options = candidates.map((c) => {
+      const bytes = LBMSolverWASM.latticeBytes(c.layout, width, height, c.bits, c.watchdog);
+      return {
+        layout: c.layout,
+        bits: c.bits,
+        watchdog: c.watchdog,
+        reproducible: c.reproducible,
+        bytes,
+        eligible: (c.watchdog || !request.watchdog) && (c.reproducible || !request.reproducible) &&
+          (!c.reduced || reducedPrecision),
+        fits: bytes + reserveBytes <= budgetBytes
+      };
+    });
+    const choice = options.find((o) => o.eligible && o.fits) || null;
+    let reason = '';
+    if (!choice) {
+      reason = !options.some((o) => o.eligible)
+        ? 'no layout has both the watchdog and bit-reproducible results'
+        : width + 'x' + height + ' needs more than the ' + Math.round(budgetBytes / 1048576) +
+          ' MB budget in every eligible layout';
+    }
+    return { feasible: choice !== null, reason, choice, options };
+  }
+
+  static loadScript(url) {
+    return new Promise((resolve, reject) => {
+      const script = document.createElement('script');
+      script.src = url;
+      script.async = true;
+      script.onload = resolve;
+      script.onerror = () => reject(new Error('Failed to load ' + url));
+      document.head.appendChild(script);
+    });
+  }
+
+  // The manifest of .wasm hashes, or null for builds without one (those
+  // load the way Emscripten does by default)
+  static async loadManifest() {
+    try {
+      const response = await fetch(LBM_WASM_DIR + LBM_WASM_MANIFEST, { cache: 'no-cache' });
+      return response.ok ? await response.json() : null;
+    } catch (e) {
+      return null;
+    }
+  }
+
+  // Compile while the bytes arrive; servers without the application/wasm
+  // MIME type (and older browsers) get a buffered compile instead
+  static async compileStreaming(url) {
+    if (typeof WebAssembly.compileStreaming === 'function') {
+      try {
+        return await WebAssembly.compileStreaming(fetch(url));
+      } catch (e) {
+        if (!(e instanceof TypeError)) throw e;
+      }
+    }
+    const response = await fetch(url);
+    if (!response.ok) throw new Error('Failed to load ' + url);
+    return WebAssembly.compile(await response.arrayBuffer());
+  }
+
+  // The compiled module of one variant, from its hash-versioned URL. A
+  // repeat visit gets the compiled code from the browser's code cache, which
+  // is keyed by that URL, so a rebuild never reuses stale code.
+  static async compiledModule(file, hash) {
+    const start = performance.now();
+    const module = await LBMSolverWASM.compileStreaming(LBM_WASM_DIR + file + '?v=' + hash.slice(0, 16));
+    LBMSolverWASM.moduleTimings = { file, compileMs: performance.now() - start };
+    return module;
+  }
+
+  // Load and instantiate the best supported module variant once per page;
+  // the first solver's memory need decides, later ones share the module.
+  // With a manifest the .wasm is compiled while the glue script loads, and
+  // handed to Emscripten through instantiateWasm.
+  static loadModule(bytesNeeded = 0) {
+    if (!LBMSolverWASM.modulePromise) {
+      LBMSolverWASM.modulePromise = (async () => {
+        const features = LBMSolverWASM.detectFeatures();
+        const manifest = await LBMSolverWASM.loadManifest();
+        let lastError = null;
+
+        for (const variant of LBM_WASM_VARIANTS) {
+          if ((variant.simd && !features.simd) || (variant.threads && !features.threads) ||
+              (variant.memory64 && !features.memory64) || variant.maxMemory < bytesNeeded) continue;
+          const scriptUrl = LBM_WASM_DIR + variant.script;
+          const wasmFile = variant.script.replace(/\.js$/, '.wasm');
+          const hash = manifest && manifest[wasmFile];
+          try {
+            const compiled = hash ? LBMSolverWASM.compiledModule(wasmFile, hash) : null;
+            // Not unhandled if the script fails first
+            if (compiled) compiled.catch(() => {});
+            if (typeof window[variant.factory] !== 'function') {
+              await LBMSolverWASM.loadScript(scriptUrl);
+            }
+            let failInstantiate = null;
+            const instantiateFailed = new Promise((resolve, reject) => { failInstantiate = reject; });
+            // The factory is a function with MODULARIZE=1
+            const module = await Promise.race([window[variant.factory]({
+              // Load the .wasm (and pthread worker) files from the lbm/ directory
+              locateFile: (path) => LBM_WASM_DIR + path,
+              // Workers re-import the main script by URL
+              mainScriptUrlOrBlob: scriptUrl,
+              // Passing the module on lets pthread workers instantiate it too
+              instantiateWasm: compiled ? (imports, receiveInstance) => {
+                compiled
+                  .then((m) => WebAssembly.instantiate(m, imports).then((instance) => receiveInstance(instance, m)))
+                  .catch(failInstantiate);
+                return {};
+              } : undefined
+            }), instantiateFailed]);
+            module.variant = variant.name;
+            console.log('WASM module variant: ' + variant.name, features, LBMSolverWASM.moduleTimings || {});
+            return module;
+          } catch (e) {
+            console.warn('WASM variant ' + variant.name + ' unavailable:', e);
+            lastError = e;
+          }
+        }
+        throw lastError || new Error('No supported WASM module variant for ' +
+          Math.ceil(bytesNeeded / 1048576) + ' MB' + (features.memory64 ? '' : ' (no memory64 support)'));
+      })();
+      // Allow a later retry if every variant failed
+      LBMSolverWASM.modulePromise.catch(() => { LBMSolverWASM.modulePromise = null; });
+    }
+    return LBMSolverWASM.modulePromise;
+  }
+
+  // Module memory still available to this solver: the loaded module's cap
+  // less the lattices already in it, or before loading the largest cap the
+  // browser supports, less the runtime reserve
+  availableBytes() {
+    const M = window.LBMWASMModule;
+    if (!M) return LBMSolverWASM.memoryCap() - LBM_RUNTIME_RESERVE;
+    const variant = LBM_WASM_VARIANTS.find((v) => v.name === M.variant);
+    const cap = variant ? variant.maxMemory : LBM_WASM32_MAX_MEMORY;
+    const inUse = typeof M.getArenaStats === 'function' ? M.getArenaStats().bytesInUse : 0;
+    return cap - LBM_RUNTIME_RESERVE - inUse;
+  }
+
+  // Lattice layout for this solver, decided before anything is loaded or
+  // allocated. compressedRate/fixedPoint are checked as given; otherwise the
+  // fastest layout with the requested features that fits is chosen.
+  planLayout() {
+    const budgetBytes = Math.min(this.memoryBudget, this.availableBytes());
+    const request = { ...this.memoryRequest, budgetBytes, reserveBytes: 0 };
+    const plan = LBMSolverWASM.planMemory(this.width, this.height, request);
+    if (this.compressedRate > 0 || this.fixedPoint) {
+      const layout = this.compressedRate > 0 ? 'compressed' : 'fixed' + this.fixedPoint;
+      const bits = this.compressedRate > 0 ? this.compressedRate : this.fixedPoint;
+      const bytes = LBMSolverWASM.latticeBytes(layout, this.width, this.height, bits);
+      const fits = bytes <= budgetBytes;
+      plan.feasible = fits;
+      plan.choice = fits ? { layout, bits, watchdog: false, reproducible: layout !== 'compressed', bytes,
+        eligible: true, fits } : null;
+      plan.reason = fits ? '' : this.width + 'x' + this.height + ' as ' + layout + ' needs ' +
+        Math.ceil(bytes / 1048576) + ' MB, over the ' + Math.floor(budgetBytes / 1048576) + ' MB available';
+    }
+    plan.budgetBytes = budgetBytes;
+    return plan;
+  }
+
   async initWASM() {
-    // Initialize the WASM module (it's a factory function with MODULARIZE=1)
+    // Refuse before loading or allocating anything, rather than running the
+    // module out of memory
+    this.memoryPlan = this.planLayout();
+    const choice = this.memoryPlan.choice;
+    if (!this.memoryPlan.feasible) {
+      throw new Error('LBM lattice does not fit in memory: ' + this.memoryPlan.reason);
+    }
+    // The preview and the full lattice coexist during the swap; without room
+    // for both, start at full resolution
+    const previewWidth = Math.round(this.width * this.previewScale);
+    const previewHeight = Math.round(this.height * this.previewScale);
+    let previewBytes = 0;
+    if (this.previewScale > 0 && this.previewScale < 1 && previewWidth >= 32 && previewHeight >= 16) {
+      previewBytes = LBMSolverWASM.latticeBytes(choice.layout, previewWidth, previewHeight, choice.bits, false);
+      if (choice.bytes + previewBytes > this.memoryPlan.budgetBytes) previewBytes = 0;
+    }
     if (!window.LBMWASMModule) {
-      // Call the Module factory function and wait for it to initialize
-      window.LBMWASMModule = await Module({
-        locateFile: (path) => {
-          // Ensure WASM file is loaded from the lbm/ directory
-          if (path.endsWith('.wasm')) {
-            return 'lbm/' + path;
+      window.LBMWASMModule = await LBMSolverWASM.loadModule(choice.bytes + previewBytes + LBM_RUNTIME_RESERVE);
+    }
+    this.startup.moduleReady = performance.now();
+
+    if (previewBytes > 0) {
+      this.solver = this.createSolver(choice, previewWidth, previewHeight);
+      this.latticeWidth = previewWidth;
+      this.latticeHeight = previewHeight;
+      this.wasmReady = true;
+      this.startup.preview = performance.now();
+      // After the page has painted a preview frame
+      this.fullResolution = new Promise((resolve) => {
+        requestAnimationFrame(() => setTimeout(() => resolve(this.swapToFullResolution(choice)), 0));
+      });
+    } else {
+      this.solver = this.createSolver(choice, this.width, this.height);
+      this.configureFullSolver(choice);
+      this.wasmReady = true;
+      this.startup.fullResolution = performance.now();
+      this.fullResolution = Promise.resolve(true);
+    }
+    console.log('WASM LBM Solver initialized (' + choice.layout + ', ' +
+      (choice.bytes / 1048576).toFixed(1) + ' MB lattice' +
+      (this.latticeWidth !== this.width ? ', ' + this.latticeWidth + 'x' + this.latticeHeight + ' preview first' : '') +
+      ')');
+  }
+
+  // Create the C++ solver instance in the planned layout
+  createSolver(choice, width, height) {
+    const M = window.LBMWASMModule;
+    const fixedClass = choice.layout.startsWith('fixed') ? M['LBMFixedSolver' + choice.bits] : null;
+    this.compressed = false;
+    this.compressedRate = 0;
+    this.fixedPoint = 0;
+    if (choice.layout === 'compressed' && typeof M.LBMCompressedSolver === 'function') {
+      this.compressed = true;
+      this.compressedRate = choice.bits;
+      return new M.LBMCompressedSolver(width, height, choice.bits);
+    }
+    if (typeof fixedClass === 'function') {
+      this.fixedPoint = choice.bits;
+      return new fixedClass(width, height);
+    }
+    return new M.LBMSolver(width, height);
+  }
+
+  // The compressed and fixed-point solvers have a fixed single-threaded
+  // sweep and no watchdog, so there is nothing to tune. Tuning measures for
+  // up to 300 ms on the main thread, so it waits until the page is idle
+  // instead of freezing the first frames; until then the module defaults run.
+  configureFullSolver(choice) {
+    if (this.compressed || this.fixedPoint) return;
+    if (choice.watchdog) this.enableWatchdog();
+    const solver = this.solver;
+    const whenIdle = window.requestIdleCallback || ((fn) => setTimeout(fn, 1000));
+    whenIdle(() => {
+      // Not if disposed meanwhile
+      if (this.solver === solver) this.autoTune();
+    }, { timeout: 5000 });
+  }
+
+  // Replace the preview by the full lattice with the same body, velocity
+  // and viscosity. The flow starts over, from a state the preview's coarse
+  // cells could not describe anyway. Keeps the preview if the full lattice
+  // cannot be created; resolves to whether the swap happened.
+  swapToFullResolution(choice) {
+    const preview = this.solver;
+    if (!preview) return false;  // disposed meanwhile
+    let full;
+    try {
+      full = this.createSolver(choice, this.width, this.height);
+    } catch (e) {
+      console.warn('Full-resolution LBM lattice failed, keeping the preview', e);
+      return false;
+    }
+    full.setGeometry(preview.getGeometry());
+    full.setVelocity(preview.getVelocity());
+    full.setViscosity(preview.getViscosity());
+    this.solver = full;
+    this.latticeWidth = this.width;
+    this.latticeHeight = this.height;
+    this.configureFullSolver(choice);
+    preview.delete();
+    this.startup.fullResolution = performance.now();
+
+    const s = this.startup;
+    const timings = LBMSolverWASM.moduleTimings;
+    console.log('WASM startup: module ' + s.moduleReady.toFixed(0) + ' ms' +
+      (timings ? ' (compiled in ' + timings.compileMs.toFixed(0) + ' ms)' : '') +
+      ', first frame ' + (s.firstFrame ? s.firstFrame.toFixed(0) + ' ms' : 'not drawn yet') +
+      ', full resolution ' + s.fullResolution.toFixed(0) + ' ms');
+    if (!this.running) this.render();
+    return true;
+  }
+
+  // Pick the fastest step() configuration (SIMD level, tile width, traversal
+  // order, kernel variant, threads in pthread builds) for this lattice size. The winner is
+  // cached in localStorage per browser/CPU and size, so only the first visit
+  // spends the time budget on measurements.
+  autoTune(budgetMs = 300) {
+    const M = window.LBMWASMModule;
+    if (typeof M.LBMSolver.getHardwareThreads !== 'function') {
+      return null;  // module built before setStepConfig() existed
+    }
+    const hardwareThreads = M.LBMSolver.getHardwareThreads();
+    const key = 'lbm-tuning:v3:' + M.variant + ':' + navigator.userAgent + ':' +
+      (navigator.hardwareConcurrency || 1) + ':' + this.width + 'x' + this.height;
+
+    const toConfig = (c) => ({
+      threads: c.threads,
+      tileWidth: c.tileWidth,
+      traversal: M.Traversal.values[c.traversal],
+      kernel: M.KernelVariant.values[c.kernel],
+      simd: M.SimdLevel.values[c.simd],
+      nonTemporal: false,
+      // Absent from modules built before pinning existed; extra fields are ignored
+      pinning: M.ThreadPinning && M.ThreadPinning.Off
+    });
+
+    try {
+      const cached = JSON.parse(localStorage.getItem(key));
+      if (cached) {
+        this.solver.setStepConfig(toConfig(cached));
+        console.log('Using cached step configuration', cached);
+        return cached;
+      }
+    } catch (e) {
+      // localStorage unavailable (privacy mode) or corrupt entry: tune again
+    }
+
+    const scratch = new M.LBMSolver(this.width, this.height);
+    scratch.setGeometry(this.solver.getGeometry());
+
+    const deadline = performance.now() + budgetMs;
+    const sliceMs = budgetMs / 40;
+
+    // Milliseconds per step for one candidate
+    const measure = (c) => {
+      scratch.setStepConfig(toConfig(c));
+      scratch.step();
+      let steps = 0;
+      const start = performance.now();
+      let elapsed = 0;
+      do {
+        scratch.step();
+        steps++;
+        elapsed = performance.now() - start;
+      } while (elapsed < sliceMs);
+      return elapsed / steps;
+    };
+
+    const bestSimd = M.LBMSolver.getBestSimdLevel().value;
+    let best = { threads: hardwareThreads, tileWidth: 0, traversal: 0, kernel: 0, simd: bestSimd };
+    let bestTime = measure(best);
+    let tried = 1;
+
+    const tryCandidate = (c) => {
+      if (performance.now() > deadline) return;
+      const t = measure(c);
+      tried++;
+      if (t < bestTime) {
+        bestTime = t;
+        best = c;
+      }
+    };
+
+    // Coordinate descent: SIMD level (kernel/traversal for the scalar path),
+    // then tile width, then threads. A module has at most one vector level
+    // (SIMD128), so the only alternative is the scalar path.
+    let base = best;
+    if (bestSimd !== 0) {
+      tryCandidate({ ...base, simd: 0 });
+    }
+
+    if (best.simd === 0) {
+      for (let kernel = 0; kernel < 2; kernel++) {
+        for (let traversal = 0; traversal < 2; traversal++) {
+          if (kernel !== best.kernel || traversal !== best.traversal) {
+            tryCandidate({ ...best, kernel, traversal });
           }
-          return 'lbm/' + path;
         }
+      }
+    }
+
+    base = best;
+    for (const tileWidth of [8, 16, 32, 64, 128]) {
+      if (tileWidth >= this.width) break;
+      tryCandidate({ ...base, tileWidth });
+    }
+
+    base = best;
+    for (let threads = 1; threads < hardwareThreads; threads *= 2) {
+      tryCandidate({ ...base, threads });
+    }
+
+    scratch.delete();
+    this.solver.setStepConfig(toConfig(best));
+    console.log('Tuned step configuration (' + tried + ' candidates, ' +
+      bestTime.toFixed(2) + ' ms/step)', best);
+
+    try {
+      localStorage.setItem(key, JSON.stringify(best));
+    } catch (e) {
+      // Not persisted; the next visit tunes again
+    }
+    return best;
+  }
+
+  // Roll back and slow down instead of running on after the flow diverges
+  // (e.g. velocity slider high, viscosity low). onWatchdog(event), if set, is
+  // called for every intervention so the UI can show the backed-off values.
+  enableWatchdog() {
+    const M = window.LBMWASMModule;
+    if (typeof this.solver.setWatchdog !== 'function') {
+      return;  // module built before the watchdog existed
+    }
+    this.solver.setWatchdog({
+      enabled: true,
+      checkpointInterval: 250,
+      maxMach: 0.6,
+      minDensity: 0.05,
+      backoff: M.WatchdogBackoff.Velocity,
+      backoffFactor: 0.8,
+      maxRetries: 5
+    });
+    this.watchdogEnabled = true;
+  }
+
+  checkWatchdog() {
+    if (!this.watchdogEnabled || this.solver.getWatchdogEventCount() === 0) return;
+
+    const events = this.solver.getWatchdogEvents();
+    for (let n = 0; n < events.size(); n++) {
+      const e = events.get(n);
+      console.warn('LBM watchdog at step ' + e.step + ': ' + e.reason +
+        (e.halted ? ', retries exhausted, simulation halted'
+          : ', rolled back to step ' + e.restoredStep + ', velocity ' + e.previousVelocity.toFixed(3) +
+            ' -> ' + e.velocity.toFixed(3) + ', viscosity ' + e.previousViscosity.toFixed(4) +
+            ' -> ' + e.viscosity.toFixed(4)));
+      if (this.onWatchdog) this.onWatchdog(e);
+    }
+    events.delete();
+    this.solver.clearWatchdogEvents();
+  }
+
+  // Cp and wall shear along the obstacle contour as plain objects
+  // {i, j, arcLength, nx, ny, cp, cf}; averaged = the mean since
+  // setSurfaceAveraging(true). The double-precision solver only.
+  getSurface(averaged = false) {
+    if (!this.solver || typeof this.solver.computeSurface !== 'function') return [];
+    const list = this.solver.computeSurface(averaged);
+    const points = [];
+    for (let n = 0; n < list.size(); n++) points.push(list.get(n));
+    list.delete();
+    return points;
+  }
+
+  setSurfaceAveraging(enabled) {
+    if (this.solver && typeof this.solver.setSurfaceAveraging === 'function') {
+      this.solver.setSurfaceAveraging(enabled);
+    }
+  }
+
+  // Dashboards running several instances can let them share one worker pool
+  // through the module's LBMScheduler instead of stepping each in turn:
+  // attach every instance, then call LBMSolverWASM.stepAll(ms) once per
+  // animation frame. Time is shared by weight, and canvases scrolled out of
+  // view get a tenth of their share.
+  static getScheduler() {
+    const M = window.LBMWASMModule;
+    if (!LBMSolverWASM.scheduler && M && typeof M.LBMScheduler === 'function') {
+      // Keep up to 64 MB of freed lattices for the next instance
+      LBMSolverWASM.scheduler = new M.LBMScheduler(M.LBMSolver.getHardwareThreads(), 64);
+      LBMSolverWASM.scheduled = [];
+    }
+    return LBMSolverWASM.scheduler || null;
+  }
+
+  async attachToScheduler(weight = 1) {
+    await this.ensureFullResolution();
+    const scheduler = LBMSolverWASM.getScheduler();
+    if (!scheduler || this.schedulerId || this.compressed || this.fixedPoint) return false;
+    this.schedulerWeight = weight;
+    this.schedulerId = scheduler.add(this.solver, weight);
+    LBMSolverWASM.scheduled.push(this);
+
+    if (typeof IntersectionObserver === 'function') {
+      this.visibilityObserver = new IntersectionObserver((entries) => {
+        scheduler.setVisible(this.schedulerId, entries[entries.length - 1].isIntersecting);
       });
-      console.log('WASM Module factory initialized');
+      this.visibilityObserver.observe(this.canvas);
     }
+    return true;
+  }
 
-    // Create the C++ solver instance
-    this.solver = new window.LBMWASMModule.LBMSolver(this.width, this.height);
-    this.wasmReady = true;
-    console.log('WASM LBM Solver initialized');
+  detachFromScheduler() {
+    if (!this.schedulerId) return;
+    LBMSolverWASM.scheduler.remove(this.schedulerId);
+    LBMSolverWASM.scheduled = LBMSolverWASM.scheduled.filter((s) => s !== this);
+    if (this.visibilityObserver) this.visibilityObserver.disconnect();
+    this.visibilityObserver = null;
+    this.schedulerId = 0;
+  }
+
+  // Step every attached instance that is running for about budgetMs;
+  // returns the number of steps taken
+  static stepAll(budgetMs) {
+    const scheduler = LBMSolverWASM.scheduler;
+    if (!scheduler) return 0;
+    for (const s of LBMSolverWASM.scheduled) {
+      scheduler.setWeight(s.schedulerId, s.running ? s.schedulerWeight : 0);
+    }
+    const steps = scheduler.run(budgetMs);
+    for (const s of LBMSolverWASM.scheduled) s.checkWatchdog();
+    return steps;
+  }
+
+  // Free the C++ solver (its lattice goes back to the module's arena)
+  dispose() {
+    if (!this.solver) return;
+    this.detachFromScheduler();
+    this.solver.delete();
+    this.solver = null;
+    this.wasmReady = false;
   }
 
   async ensureReady() {
@@ -47,51 +686,145 @@ class LBMSolverWASM {
     }
   }
 
+  // Past the preview (for recordings, checksums and the scheduler)
+  async ensureFullResolution() {
+    await this.ensureReady();
+    await this.fullResolution;
+  }
+
   async setVelocity(velocity) {
+    this.record('setVelocity', { value: velocity });
     await this.ensureReady();
     this.solver.setVelocity(velocity);
   }
 
   async setViscosity(viscosity) {
+    this.record('setViscosity', { value: viscosity });
     await this.ensureReady();
     this.solver.setViscosity(viscosity);
   }
 
   async setGeometry(geometry) {
+    this.record('setGeometry', { value: geometry });
     await this.ensureReady();
     this.solver.setGeometry(geometry);
   }
 
   setVisualization(mode) {
+    this.record('setVisualization', { value: mode });
     this.visualMode = mode;
+    // 'strain' (double-precision solver only) turns the stored field on
+    // when it is first drawn; other views stop its updates (the buffer is
+    // kept until the solver is destroyed)
+    if (mode !== 'strain' && this.solver && typeof this.solver.setStrainRateOutput === 'function') {
+      this.solver.setStrainRateOutput(false);
+    }
   }
 
   toggleMesh(show) {
+    this.record('toggleMesh', { value: show });
     this.showMesh = show;
   }
 
   async reset() {
+    this.record('reset');
     await this.ensureReady();
     this.solver.reset();
   }
 
   async step() {
+    this.record('step');
     await this.ensureReady();
     this.solver.step();
+    this.checkWatchdog();
+  }
+
+  // Session recording: a log of the calls the page makes, with milliseconds
+  // since the start, for replaying headlessly with lbm-replay-node.js.
+  // Consecutive step() calls are one event with a count. The log opens with
+  // the current geometry, velocity, viscosity and view, so a replay starts
+  // where the recording did.
+  async startRecording() {
+    await this.ensureFullResolution();
+    const choice = this.memoryPlan ? this.memoryPlan.choice : null;
+    this.recording = {
+      version: 1,
+      width: this.width,
+      height: this.height,
+      layout: choice ? choice.layout : 'double',
+      bits: choice ? choice.bits : 64,
+      module: window.LBMWASMModule.variant,
+      userAgent: navigator.userAgent,
+      started: new Date().toISOString(),
+      events: []
+    };
+    this.recordingStart = performance.now();
+    this.record('setGeometry', { value: this.solver.getGeometry() });
+    this.record('setVelocity', { value: this.solver.getVelocity() });
+    this.record('setViscosity', { value: this.solver.getViscosity() });
+    this.record('setVisualization', { value: this.visualMode });
+    this.record('toggleMesh', { value: this.showMesh });
+  }
+
+  record(op, fields = {}) {
+    if (!this.recording) return;
+    const events = this.recording.events;
+    const last = events[events.length - 1];
+    if (op === 'step' && last && last.op === 'step') {
+      last.count++;
+      return;
+    }
+    const t = Math.round((performance.now() - this.recordingStart) * 10) / 10;
+    events.push(op === 'step' ? { t, op, count: 1 } : { t, op, ...fields });
+  }
+
+  // Ends the recording and returns it (null if none was running)
+  stopRecording() {
+    const session = this.recording || null;
+    this.recording = null;
+    if (session) session.duration = Math.round(performance.now() - this.recordingStart);
+    return session;
+  }
+
+  // Ends the recording and downloads it as JSON
+  saveRecording(filename = 'lbm-session.json') {
+    const session = this.stopRecording();
+    if (!session) return null;
+    const blob = new Blob([JSON.stringify(session)], { type: 'application/json' });
+    const link = document.createElement('a');
+    link.href = URL.createObjectURL(blob);
+    link.download = filename;
+    link.click();
+    URL.revokeObjectURL(link.href);
+    return session;
+  }
+
+  // 16 hex digits identifying the fixed-point lattice bit for bit (equal on
+  // every browser and CPU after the same steps), or null for other solvers
+  async getChecksum() {
+    await this.ensureFullResolution();
+    return this.fixedPoint ? this.solver.getChecksum() : null;
   }
 
   async render() {
+    this.record('render');
     await this.ensureReady();
 
-    if (!this.imageData) {
-      this.imageData = this.ctx.createImageData(this.width, this.height);
+    // The preview lattice is coarser than the canvas
+    const lw = this.latticeWidth;
+    const lh = this.latticeHeight;
+    if (!this.imageData || this.imageData.width !== lw || this.imageData.height !== lh) {
+      this.imageData = this.ctx.createImageData(lw, lh);
     }
     const data = this.imageData.data;
 
     // Get data from C++ solver
     let values, maxVal;
+    // Solvers without the strain export (fixed-point, compressed) show velocity
+    const view = this.visualMode === 'strain' && typeof this.solver.getStrainRate !== 'function'
+      ? 'velocity' : this.visualMode;
 
-    if (this.visualMode === 'velocity') {
+    if (view === 'velocity') {
       const velocityArray = this.solver.getVelocityMagnitude();
       values = [];
       maxVal = 0.01;
@@ -104,7 +837,7 @@ class LBMSolverWASM {
         if (val > maxVal) maxVal = val;
       }
       if (velocityArray.delete) velocityArray.delete(); // Clean up if it's a C++ vector
-    } else if (this.visualMode === 'vorticity') {
+    } else if (view === 'vorticity') {
       const vorticityArray = this.solver.getVorticity();
       values = [];
       maxVal = 0.01;
@@ -116,7 +849,21 @@ class LBMSolverWASM {
         if (val > maxVal) maxVal = val;
       }
       if (vorticityArray.delete) vorticityArray.delete();
-    } else if (this.visualMode === 'pressure') {
+    } else if (view === 'strain') {
+      // Stored by the collision pass from the first strain frame on
+      if (!this.solver.getStrainRateOutput()) this.solver.setStrainRateOutput(true);
+      const strainArray = this.solver.getStrainRate();
+      values = [];
+      maxVal = 0.001;
+
+      const arraySize = strainArray.size ? strainArray.size() : strainArray.length;
+      for (let i = 0; i < arraySize; i++) {
+        const val = strainArray.get ? strainArray.get(i) : strainArray[i];
+        values.push(val);
+        if (val > maxVal) maxVal = val;
+      }
+      if (strainArray.delete) strainArray.delete();
+    } else if (view === 'pressure') {
       const pressureArray = this.solver.getPressure();
       values = [];
       maxVal = 0.01;
@@ -142,10 +889,10 @@ class LBMSolverWASM {
     const invMaxVal = 1.0 / maxVal;
 
     // Colorize directly into imageData
-    for (let i = 0; i < this.width; i++) {
-      for (let j = 0; j < this.height; j++) {
-        const idx = (j * this.width + i) * 4;
-        const dataIdx = j * this.width + i;
+    for (let i = 0; i < lw; i++) {
+      for (let j = 0; j < lh; j++) {
+        const idx = (j * lw + i) * 4;
+        const dataIdx = j * lw + i;
 
         if (obstacles[dataIdx]) {
           // Solid objects in dark gray
@@ -188,7 +935,15 @@ class LBMSolverWASM {
       }
     }
 
-    this.ctx.putImageData(this.imageData, 0, 0);
+    if (lw === this.width && lh === this.height) {
+      this.ctx.putImageData(this.imageData, 0, 0);
+    } else {
+      if (!this.previewCanvas) this.previewCanvas = document.createElement('canvas');
+      this.previewCanvas.width = lw;
+      this.previewCanvas.height = lh;
+      this.previewCanvas.getContext('2d').putImageData(this.imageData, 0, 0);
+      this.ctx.drawImage(this.previewCanvas, 0, 0, this.width, this.height);
+    }
 
     // Draw streamlines for velocity visualization
     if (this.visualMode === 'velocity') {
@@ -221,11 +976,21 @@ class LBMSolverWASM {
 
     // Draw colorbar
     this.drawColorbar(maxVal);
+
+    if (!this.startup.firstFrame) {
+      this.startup.firstFrame = performance.now();
+      console.log('LBM first frame at ' + this.startup.firstFrame.toFixed(0) + ' ms (' + lw + 'x' + lh + ')');
+    }
   }
 
   drawStreamlines() {
-    const spacing = 20;  // Distance between streamline seed points
-    const stepSize = 1.5;  // Integration step size
+    // Traced in lattice cells, drawn in canvas pixels
+    const lw = this.latticeWidth;
+    const lh = this.latticeHeight;
+    const sx = this.width / lw;
+    const sy = this.height / lh;
+    const spacing = 20 / sx;  // Distance between streamline seed points
+    const stepSize = 1.5 / sx;  // Integration step size
     const maxSteps = 200;  // Maximum steps per streamline
 
     this.ctx.strokeStyle = 'rgba(255, 255, 255, 0.4)';
@@ -251,9 +1016,9 @@ class LBMSolverWASM {
     if (obstacleArray.delete) obstacleArray.delete();
 
     // Create seed points in a regular grid
-    for (let x0 = spacing; x0 < this.width; x0 += spacing) {
-      for (let y0 = spacing / 2; y0 < this.height; y0 += spacing) {
-        const idx0 = Math.floor(y0) * this.width + Math.floor(x0);
+    for (let x0 = spacing; x0 < lw; x0 += spacing) {
+      for (let y0 = spacing / 2; y0 < lh; y0 += spacing) {
+        const idx0 = Math.floor(y0) * lw + Math.floor(x0);
         if (obstacle[idx0]) continue;
 
         this.ctx.beginPath();
@@ -266,9 +1031,9 @@ class LBMSolverWASM {
           const j = Math.floor(y);
 
           // Check bounds
-          if (i < 1 || i >= this.width - 1 || j < 1 || j >= this.height - 1) break;
+          if (i < 1 || i >= lw - 1 || j < 1 || j >= lh - 1) break;
 
-          const idx = j * this.width + i;
+          const idx = j * lw + i;
           if (obstacle[idx]) break;
 
           // Get velocity at current position
@@ -279,9 +1044,9 @@ class LBMSolverWASM {
           if (speed < 0.001) break;  // Stop in stagnant regions
 
           if (step === 0) {
-            this.ctx.moveTo(x, y);
+            this.ctx.moveTo(x * sx, y * sy);
           } else {
-            this.ctx.lineTo(x, y);
+            this.ctx.lineTo(x * sx, y * sy);
           }
 
           // Integrate forward (Euler method)
@@ -378,6 +1143,8 @@ class LBMSolverWASM {
       title = 'Velocity (m/s)';
     } else if (this.visualMode === 'vorticity') {
       title = 'Vorticity (1/s)';
+    } else if (this.visualMode === 'strain') {
+      title = 'Strain rate (1/s)';
     } else if (this.visualMode === 'pressure') {
       title = 'Density';
     }
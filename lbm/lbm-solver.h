@@ -0,0 +1,1773 @@
+// D2Q9 Lattice Boltzmann solver core
+// Shared by the Emscripten build (lbm-solver.cpp) and the native tools (lbm-bench.cpp)
+#pragma once
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/val.h>
+#endif
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "lbm-aligned-buffer.h"
+#include "lbm-kernels.h"
+#include "lbm-thread-pool.h"
+
+#ifdef __EMSCRIPTEN__
+using emscripten::val;
+#endif
+
+// Order in which cells are visited inside a tile (scalar kernels only)
+enum class Traversal {
+    Columns = 0,  // i outer, j inner (contiguous in memory)
+    Rows = 1      // j outer, i inner
+};
+
+// How the scalar streaming pass writes the new populations
+enum class KernelVariant {
+    TwoPass = 0,  // copy every population to fTemp, then overwrite with pulled values
+    Fused = 1     // write each population of fTemp exactly once
+};
+
+// Execution settings for step(). The scalar settings reproduce the original
+// sweep bit for bit; the SIMD kernels agree to rounding (FMA contraction).
+struct StepConfig {
+    int threads = 1;
+    int tileWidth = 0;  // columns per tile, 0 = one tile per thread
+    Traversal traversal = Traversal::Columns;
+    KernelVariant kernel = KernelVariant::TwoPass;
+    SimdLevel simd = SimdLevel::Auto;
+    bool nonTemporal = false;  // stream stores past the cache (lattices >> LLC)
+    ThreadPinning pinning = ThreadPinning::Off;  // pool threads, native Linux only
+};
+
+// Flow summary over the fluid cells. Every field is reduced per column in
+// index order and then combined pairwise across columns, so the values are
+// bit-identical whatever the thread count or tile width.
+struct Diagnostics {
+    double mass = 0.0;       // sum of all populations
+    double momentumX = 0.0;
+    double momentumY = 0.0;
+    double maxSpeed = 0.0;   // largest |u| (lattice units)
+    double minDensity = 0.0;
+    double maxDensity = 0.0;
+    double forceX = 0.0;     // momentum exchange on the obstacle (drag)
+    double forceY = 0.0;     // lift
+    int fluidCells = 0;
+};
+
+// One fluid cell next to the obstacle, in contour order. Cp and cf are
+// normalised by the dynamic pressure 0.5 * u0^2; Cp is relative to the mean
+// pressure just inside the inlet, the free stream as far as the lattice goes.
+struct SurfacePoint {
+    int i = 0, j = 0;
+    double arcLength = 0.0;  // lattice units along the contour from the first point
+    double nx = 0.0, ny = 0.0;  // unit normal pointing out of the body
+    double cp = 0.0;         // pressure coefficient (rho - rhoInlet) / 3 / (0.5 u0^2)
+    double cf = 0.0;         // wall shear coefficient, positive along increasing arcLength
+};
+
+// What the watchdog changes after rolling back a diverging run
+enum class WatchdogBackoff {
+    Velocity = 0,  // scale the inlet velocity by backoffFactor
+    Viscosity = 1  // divide the viscosity by backoffFactor
+};
+
+// Divergence watchdog. Every step the collision pass also records the
+// smallest density, largest Mach number and whether any population went
+// NaN/Inf. A failed check restores a checkpoint, backs off the flow
+// parameters and records a WatchdogEvent. Two checkpoints are kept and the
+// older one is restored, because the newest may already be past the point of
+// no return. After maxRetries failures without a checkpoint surviving a full
+// interval, the solver halts (step() does nothing until reset()).
+// Mach violations always back off the velocity; the backoff setting applies
+// to non-finite populations and densities below minDensity.
+struct WatchdogConfig {
+    bool enabled = false;
+    int checkpointInterval = 250;  // steps between checkpoints of a healthy state
+    double maxMach = 0.6;          // |u| / c_s with c_s = 1/sqrt(3)
+    double minDensity = 0.05;
+    WatchdogBackoff backoff = WatchdogBackoff::Velocity;
+    double backoffFactor = 0.8;
+    int maxRetries = 5;
+};
+
+struct WatchdogEvent {
+    int step;           // step whose check failed
+    int restoredStep;   // step of the restored checkpoint
+    std::string reason;
+    double previousVelocity;
+    double previousViscosity;
+    double velocity;    // after backoff
+    double viscosity;
+    bool halted;        // retries exhausted, stepping stopped
+};
+
+// Activity tracking. Every checkInterval steps the columns are grouped into
+// blocks of blockWidth and each block's largest |f_k - feq_k| is measured
+// against the equilibrium of the free stream (the mean density and velocity
+// just inside the inlet). A block below the threshold whose neighbours are
+// below it too is frozen at that equilibrium: collision and streaming skip
+// it until a neighbour goes above the threshold again. The inlet and outlet
+// blocks and blocks with obstacle cells never freeze, nor does anything
+// during the ramp or with edges other than the default wind tunnel. With
+// verify set the blocks are chosen the same way but still stepped, and the
+// largest deviation found in them is recorded instead.
+struct ActivityConfig {
+    bool enabled = false;
+    double threshold = 1e-6;  // per population, relative to a density of 1
+    int blockWidth = 16;      // columns per block
+    int checkInterval = 8;    // steps between checks; at most blockWidth, as a
+                              // disturbance moves one column per step at most
+    bool verify = false;
+};
+
+// What activity tracking skipped since it was configured
+struct ActivityStats {
+    int blocks = 0;
+    int frozenBlocks = 0;            // at the last check
+    int thawedBlocks = 0;            // frozen blocks a neighbour has woken up
+    double skippedFraction = 0.0;    // column updates skipped (would be, with verify)
+    double maxFrozenDeviation = 0.0; // verify: largest |f - feq| seen in a frozen block
+};
+
+// Result of the checks fused into the last collision pass
+struct StepHealth {
+    double minDensity;
+    double maxMach;
+    bool finite;
+};
+
+// Treatment of the left/right edges
+enum class FlowBoundary {
+    InletOutlet = 0,  // equilibrium inlet at i = 0, zero-gradient outlet
+    Periodic = 1,
+    NoSlip = 2        // half-way bounce-back
+};
+
+// Treatment of the top (j = 0) and bottom (j = height - 1) edges
+enum class WallBoundary {
+    FreeSlip = 0,
+    Periodic = 1,
+    NoSlip = 2        // half-way bounce-back; the j = 0 wall may move
+};
+
+enum class InletProfile {
+    Uniform = 0,
+    Parabolic = 1     // fully developed channel flow, u0 on the centreline
+};
+
+enum class OutletCondition {
+    ZeroGradient = 0,  // copy the last interior column
+    Pressure = 1       // equilibrium at density 1 with the interior velocity; the
+                       // inlet then takes its density from the interior so a
+                       // pressure drop can build up (needed with no-slip walls)
+};
+
+// Domain edges. The defaults are the wind tunnel of the web page; the other
+// settings exist for the validation cases in lbm-validate.cpp (channels,
+// periodic boxes, the lid-driven cavity).
+struct BoundaryConfig {
+    FlowBoundary flow = FlowBoundary::InletOutlet;
+    WallBoundary walls = WallBoundary::FreeSlip;
+    InletProfile inlet = InletProfile::Uniform;
+    OutletCondition outlet = OutletCondition::ZeroGradient;
+    double lidVelocity = 0.0;  // x velocity of the j = 0 wall when walls are NoSlip
+};
+
+class LBMSolver {
+private:
+    int width, height;
+    double nu, tau, omega, u0;
+
+    // D2Q9 lattice velocities
+    static constexpr int ex[9] = {0, 1, 0, -1, 0, 1, -1, -1, 1};
+    static constexpr int ey[9] = {0, 0, 1, 0, -1, 1, 1, -1, -1};
+    static constexpr double w[9] = {4.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0, 1.0/9.0,
+                                     1.0/36.0, 1.0/36.0, 1.0/36.0, 1.0/36.0};
+
+    // Lattice layout: structure of arrays, one plane per population, columns
+    // contiguous (index i * colStride + j). colStride is the height rounded up
+    // to 8 cells so every column starts on a 64-byte boundary; the padding
+    // cells are marked as obstacles and never read by real cells.
+    static constexpr size_t padCells = 8;
+    size_t colStride;
+    size_t planeStride;
+
+    // Distribution functions (current and temporary), 9 planes each, with
+    // padCells of slack on both ends for the shifted vector loads
+    AlignedBuffer<double> fBuffer;
+    AlignedBuffer<double> fTempBuffer;
+    double* f;
+    double* fTemp;
+
+    // Macroscopic fields
+    AlignedBuffer<double> rho;
+    AlignedBuffer<double> ux;
+    AlignedBuffer<double> uy;
+
+    // Obstacle array (1 = solid)
+    AlignedBuffer<uint8_t> obstacle;
+
+    // Strain-rate magnitude written by the collision pass, allocated on the
+    // first setStrainRateOutput(true) and kept so existing views stay valid
+    AlignedBuffer<double> strain;
+    bool strainOutput = false;
+
+    size_t idx(int i, int j) const { return static_cast<size_t>(i) * colStride + j; }
+    double* plane(double* base, int k) const { return base + k * planeStride; }
+
+    // Parameters
+    bool running;
+    double currentVelocity;
+    int stepCount;
+    int rampUpSteps;
+    std::string currentGeometry;
+    BoundaryConfig boundary;
+
+    // Threading, tiling and kernel selection
+    StepConfig config;
+    std::shared_ptr<ThreadPool> pool;
+    bool sharedPool = false;  // pool belongs to an LBMScheduler
+    int privateThreads = 1;   // threads requested for a pool of its own
+    lbm_kernels::KernelTable kernels;
+
+    // Per-column partial results of computeDiagnostics()
+    std::vector<Diagnostics> columnDiagnostics;
+
+    // Watchdog state: per-column collision health, the last good states and
+    // what has been done so far
+    std::vector<lbm_kernels::ColumnHealth> columnHealth;
+    WatchdogConfig watchdog;
+    struct Checkpoint {
+        AlignedBuffer<double> f;
+        AlignedBuffer<double> rho, ux, uy;
+        int steps = -1;  // -1 = empty
+        int stepCount = 0;
+        double currentVelocity = 0.0;
+    };
+    Checkpoint latestCheckpoint;
+    Checkpoint olderCheckpoint;
+    std::vector<WatchdogEvent> watchdogEvents;
+    int watchdogRetries;
+    int totalSteps;
+    bool halted;
+
+    // Fluid cells next to the obstacle in contour order, rebuilt on demand
+    // after the geometry changes, and the running sums of the surface average
+    std::vector<SurfacePoint> surface;
+    bool surfaceValid = false;
+    bool surfaceAveraging = false;
+    int surfaceAverageSteps = 0;
+    std::vector<double> cpSum, cfSum;
+
+    // Activity tracking: frozen flag and last measured deviation per column,
+    // the free-stream equilibrium of the last check and the one frozen
+    // columns hold
+    ActivityConfig activity;
+    ActivityStats activityStats;
+    std::vector<uint8_t> columnFrozen;
+    std::vector<double> columnDeviation;
+    double freeStreamEq[9] = {};
+    double frozenEq[9] = {};
+    double frozenRho = 1.0, frozenUx = 0.0;
+    double frozenDrift = 0.0;       // max |frozenEq - freeStreamEq|
+    double activityVelocity = 0.0;  // inlet velocity at the last check
+    int frozenColumns = 0;
+    bool skipFrozen = false;        // frozen columns exist and are skipped
+    long long steppedColumns = 0, skippedColumns = 0;
+
+    static bool threadsSupported() {
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+        return false;
+#else
+        return true;
+#endif
+    }
+
+    int tileWidthInUse() const {
+        if (config.tileWidth > 0) return std::min(config.tileWidth, width);
+        return (width + config.threads - 1) / config.threads;
+    }
+
+    int tileCount() const {
+        int tw = tileWidthInUse();
+        return (width + tw - 1) / tw;
+    }
+
+    void runTiles(void (LBMSolver::*kernel)(int, int)) {
+        int tw = tileWidthInUse();
+        int tiles = tileCount();
+        if (!pool) {
+            for (int t = 0; t < tiles; t++) {
+                (this->*kernel)(t * tw, std::min(width, (t + 1) * tw));
+            }
+            return;
+        }
+        pool->run(tiles, [this, kernel, tw](int t) {
+            (this->*kernel)(t * tw, std::min(width, (t + 1) * tw));
+        });
+    }
+
+    // Pinned pool threads (and the calling thread, participant 0) go back to
+    // the process CPU mask before a private pool is replaced or dropped
+    void unpinPool() {
+        if (pool && !sharedPool && !pool->pinnedCpus().empty()) pool->pin({});
+    }
+
+public:
+    // The lattice is initialised with config's tile partition, so pass the
+    // threaded configuration here rather than to setStepConfig() later: on
+    // a NUMA machine each page then lives on the node of the thread that
+    // steps it (pages stay where they were first touched)
+    LBMSolver(int w, int h, StepConfig c = StepConfig()) : width(w), height(h), running(false),
+                               stepCount(0), rampUpSteps(500), currentGeometry("circle"),
+                               watchdogRetries(0), totalSteps(0), halted(false) {
+        // All cell offsets are size_t: 64-bit natively and in the memory64
+        // WASM build. Refuse lattices whose 9 planes would not be addressable
+        // (wasm32) instead of wrapping.
+        if (width <= 0 || height <= 0) throw std::bad_alloc();
+        colStride = (static_cast<size_t>(height) + padCells - 1) / padCells * padCells;
+        if (colStride > SIZE_MAX / sizeof(double) / 9 / static_cast<size_t>(width)) throw std::bad_alloc();
+
+        // Initialize arrays
+        columnDiagnostics.resize(width);
+        columnHealth.resize(width);
+        columnFrozen.resize(width);
+        columnDeviation.resize(width);
+        planeStride = colStride * width;
+        fBuffer = AlignedBuffer<double>(9 * planeStride + 2 * padCells);
+        fTempBuffer = AlignedBuffer<double>(9 * planeStride + 2 * padCells);
+        f = fBuffer.data() + padCells;
+        fTemp = fTempBuffer.data() + padCells;
+        rho = AlignedBuffer<double>(planeStride);
+        ux = AlignedBuffer<double>(planeStride);
+        uy = AlignedBuffer<double>(planeStride);
+        obstacle = AlignedBuffer<uint8_t>(planeStride);
+
+        setStepConfig(c);
+
+        // Default parameters
+        setViscosity(0.02);
+        setVelocity(0.15);
+        currentVelocity = 0.0;
+
+        reset();
+    }
+
+    ~LBMSolver() { unpinPool(); }
+
+    // Arena bytes of a width x height solver (AlignedBuffer planes only); the
+    // watchdog adds its two checkpoints once it has stored them
+    static uint64_t requiredBytes(int width, int height, bool watchdog) {
+        uint64_t plane = (static_cast<uint64_t>(height) + padCells - 1) / padCells * padCells * width;
+        uint64_t populations = AlignedBuffer<double>::bytesFor(9 * plane + 2 * padCells);
+        uint64_t fields = 3 * AlignedBuffer<double>::bytesFor(plane);
+        uint64_t bytes = 2 * populations + fields + AlignedBuffer<uint8_t>::bytesFor(plane);
+        return watchdog ? bytes + 2 * (populations + fields) : bytes;
+    }
+
+    LBMSolver(const LBMSolver&) = delete;
+    LBMSolver& operator=(const LBMSolver&) = delete;
+
+    void setViscosity(double viscosity) {
+        nu = viscosity;
+        tau = 3.0 * nu + 0.5;
+        omega = 1.0 / tau;
+    }
+
+    void setVelocity(double velocity) {
+        u0 = velocity;
+    }
+
+    double getViscosity() const { return nu; }
+    double getVelocity() const { return u0; }
+
+    void setStepConfig(StepConfig c) {
+        c.threads = threadsSupported() ? std::max(1, std::min(c.threads, 256)) : 1;
+        c.tileWidth = std::max(0, c.tileWidth);
+        kernels = lbm_kernels::selectKernels(c.simd);
+        c.simd = kernels.level;
+        config = c;
+        privateThreads = c.threads;
+        if (sharedPool) {
+            // The thread count is the shared pool's
+            config.threads = pool->size();
+        } else if (config.threads > 1) {
+            if (!pool || pool->size() != config.threads) {
+                unpinPool();
+                pool.reset(new ThreadPool(config.threads));
+            }
+        } else {
+            unpinPool();
+            pool.reset();
+        }
+
+        // Pinning belongs to the pool's owner; a shared pool is left alone
+        if (pool && !sharedPool) {
+            std::vector<int> cpus =
+                lbm_numa::pinningCpus(config.pinning, pool->size(), lbm_numa::systemTopology());
+            if (cpus != pool->pinnedCpus()) pool->pin(cpus);
+        }
+    }
+
+    StepConfig getStepConfig() const { return config; }
+
+    // Step on a pool shared with other solvers (see LBMScheduler) instead of
+    // one of its own; nullptr goes back to a private pool of config.threads
+    void attachPool(std::shared_ptr<ThreadPool> shared) {
+        unpinPool();
+        StepConfig c = config;
+        c.threads = privateThreads;
+        sharedPool = shared != nullptr;
+        if (sharedPool) {
+            pool = std::move(shared);
+        } else {
+            pool.reset();
+        }
+        setStepConfig(c);
+    }
+
+    // Widest SIMD level this CPU can run
+    static SimdLevel getBestSimdLevel() { return lbm_kernels::detectSimdLevel(); }
+
+    // Threads the tuner should consider (1 in a WASM build without pthreads)
+    static int getHardwareThreads() {
+        return threadsSupported() ? static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) : 1;
+    }
+
+    std::string getGeometry() const { return currentGeometry; }
+
+    void setBoundary(BoundaryConfig b) {
+        boundary = b;
+        thawAll();
+    }
+    BoundaryConfig getBoundary() const { return boundary; }
+
+    void setGeometry(std::string geom) {
+        currentGeometry = geom;
+        reset();
+    }
+
+    void reset() {
+        stepCount = 0;
+        currentVelocity = 0.0;
+        totalSteps = 0;
+        halted = false;
+        watchdogRetries = 0;
+        latestCheckpoint.steps = -1;
+        olderCheckpoint.steps = -1;
+        invalidateSurface();
+        resetActivity();
+
+        // Clear obstacle and initialize distribution functions, tile by tile
+        // on the threads that will step them
+        runTiles(&LBMSolver::resetTile);
+
+        // Create geometry
+        rasterizeGeometry(currentGeometry, width, height, [this](int i, int j) { obstacle[idx(i, j)] = 1; });
+
+        if (watchdog.enabled) saveCheckpoint();
+    }
+
+    void resetTile(int i0, int i1) {
+        for (int i = i0; i < i1; i++) {
+            // Column padding stays solid
+            for (size_t j = 0; j < colStride; j++) {
+                obstacle[idx(i, 0) + j] = j < static_cast<size_t>(height) ? 0 : 1;
+            }
+
+            // Padding included
+            for (size_t j = 0; j < colStride; j++) {
+                size_t c = idx(i, 0) + j;
+                double rho0 = 1.0;
+                double ux0 = 0.0;
+                double uy0 = 0.0;
+
+                for (int k = 0; k < 9; k++) {
+                    double cu = 3.0 * (ex[k] * ux0 + ey[k] * uy0);
+                    double u2 = 1.5 * (ux0 * ux0 + uy0 * uy0);
+                    plane(f, k)[c] = w[k] * rho0 * (1.0 + cu + 0.5 * cu * cu - u2);
+                    plane(fTemp, k)[c] = plane(f, k)[c];
+                }
+
+                rho[c] = rho0;
+                ux[c] = ux0;
+                uy[c] = uy0;
+                if (strainOutput) strain[c] = 0.0;
+            }
+        }
+    }
+
+    // Length of the body in cells at a lattice height, as used for the
+    // Reynolds number: circle diameter, square side, airfoil chord, plate
+    // and triangle length. 0 for unknown geometries.
+    static double bodyLength(const std::string& geom, double latticeHeight) {
+        if (geom == "circle") return 2.0 * 0.16 * latticeHeight;
+        if (geom == "airfoil") return latticeHeight / 1.5;
+        if (geom == "square") return 2.0 * 0.15 * latticeHeight;
+        if (geom == "flat_plate") return 2.0 * 0.25 * latticeHeight;
+        if (geom == "triangle") return 2.0 * 0.125 * latticeHeight;
+        return 0.0;
+    }
+
+    // Call mark(i, j) for every solid cell of a built-in body on a
+    // width x height lattice (nothing for "none" or unknown names). Also used
+    // by the out-of-core solver, which has no in-memory obstacle array.
+    template <typename Mark>
+    static void rasterizeGeometry(const std::string& geom, int width, int height, Mark mark) {
+        if (geom == "circle") {
+            createCircle(width, height, mark);
+        } else if (geom == "airfoil") {
+            createAirfoil(width, height, mark);
+        } else if (geom == "square") {
+            createSquare(width, height, mark);
+        } else if (geom == "flat_plate") {
+            createFlatPlate(width, height, mark);
+        } else if (geom == "triangle") {
+            createTriangle(width, height, mark);
+        }
+    }
+
+    template <typename Mark>
+    static void createCircle(int width, int height, Mark mark) {
+        double cx = width * 0.25;
+        double cy = (height - 1) * 0.5;
+        double radius = height * 0.16;  // Larger for vortex shedding
+
+        for (int i = 0; i < width; i++) {
+            for (int j = 0; j < height; j++) {
+                double dx = i - cx;
+                double dy = j - cy;
+                if (dx * dx + dy * dy < radius * radius) {
+                    mark(i, j);
+                }
+            }
+        }
+    }
+
+    template <typename Mark>
+    static void createAirfoil(int width, int height, Mark mark) {
+        double cx = width * 0.25;
+        double cy = (height - 1) * 0.5;
+        double chord = height / 1.5;
+        double thickness = 0.12;
+        double angle = 5.0 * M_PI / 180.0;
+
+        for (int i = 0; i < width; i++) {
+            for (int j = 0; j < height; j++) {
+                double dx = i - cx;
+                double dy = j - cy;
+
+                double xRot = dx * cos(-angle) - dy * sin(-angle);
+                double yRot = dx * sin(-angle) + dy * cos(-angle);
+
+                if (xRot >= 0 && xRot <= chord) {
+                    double x_c = xRot / chord;
+                    double yt = 5.0 * thickness * chord *
+                               (0.2969 * sqrt(x_c) - 0.126 * x_c -
+                                0.3516 * x_c * x_c + 0.2843 * x_c * x_c * x_c -
+                                0.1015 * x_c * x_c * x_c * x_c);
+
+                    if (std::abs(yRot) <= yt) {
+                        mark(i, j);
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename Mark>
+    static void createSquare(int width, int height, Mark mark) {
+        double cx = width * 0.25;
+        double cy = (height - 1) * 0.5;
+        double size = height * 0.15;
+
+        for (int i = 0; i < width; i++) {
+            for (int j = 0; j < height; j++) {
+                if (std::abs(i - cx) < size && std::abs(j - cy) < size) {
+                    mark(i, j);
+                }
+            }
+        }
+    }
+
+    template <typename Mark>
+    static void createFlatPlate(int width, int height, Mark mark) {
+        double cx = width * 0.25;
+        double cy = (height - 1) * 0.5;
+        double length = height * 0.25;
+        double thickness = 2.5;
+
+        for (int i = 0; i < width; i++) {
+            for (int j = 0; j < height; j++) {
+                if (std::abs(i - cx) < length && std::abs(j - cy) < thickness) {
+                    mark(i, j);
+                }
+            }
+        }
+    }
+
+    template <typename Mark>
+    static void createTriangle(int width, int height, Mark mark) {
+        double cx = width * 0.25;
+        double cy = (height - 1) * 0.5;
+        double triSize = height * 0.125;
+
+        for (int i = 0; i < width; i++) {
+            for (int j = 0; j < height; j++) {
+                double dx = i - cx;
+                double dy = j - cy;
+
+                if (std::abs(dx) < triSize) {
+                    double width_at_x = dx < 0 ? (triSize + dx) * 0.8 : (triSize - dx) * 0.8;
+                    if (std::abs(dy) < width_at_x) {
+                        mark(i, j);
+                    }
+                }
+            }
+        }
+    }
+
+    void step() {
+        if (halted) return;
+
+        // Velocity ramp-up
+        if (stepCount < rampUpSteps) {
+            currentVelocity = u0 * static_cast<double>(stepCount) / rampUpSteps;
+            stepCount++;
+        } else {
+            currentVelocity = u0;
+        }
+
+        if (kernels.collide) {
+            // Vectorised column kernels
+            runTiles(&LBMSolver::collideTileSimd);
+            runTiles(&LBMSolver::streamTileSimd);
+        } else {
+            // Collision step
+            runTiles(&LBMSolver::collideTile);
+
+            // Streaming step (pull scheme) into fTemp; reads only post-collision f
+            if (config.kernel == KernelVariant::Fused) {
+                runTiles(&LBMSolver::streamTileFused);
+            } else {
+                runTiles(&LBMSolver::streamTileTwoPass);
+            }
+        }
+
+        // Swap arrays
+        std::swap(f, fTemp);
+
+        // Boundary conditions
+        applyBoundaryConditions();
+
+        totalSteps++;
+        if (watchdog.enabled) checkHealth();
+        if (activity.enabled) trackActivity();
+        if (surfaceAveraging) accumulateSurface();
+    }
+
+    void collideCell(int i, int j) {
+        size_t c = idx(i, j);
+        if (obstacle[c]) return;
+        lbm_kernels::ColumnHealth& health = columnHealth[i];
+
+        // Compute macroscopic quantities
+        double rho_local = 0.0;
+        double ux_local = 0.0;
+        double uy_local = 0.0;
+        double fc[9];
+
+        for (int k = 0; k < 9; k++) {
+            double fk = plane(f, k)[c];
+            fc[k] = fk;
+            rho_local += fk;
+            ux_local += ex[k] * fk;
+            uy_local += ey[k] * fk;
+        }
+
+        ux_local /= rho_local;
+        uy_local /= rho_local;
+
+        rho[c] = rho_local;
+        ux[c] = ux_local;
+        uy[c] = uy_local;
+
+        // Collision with BGK operator
+        double u2 = 1.5 * (ux_local * ux_local + uy_local * uy_local);
+
+        health.minRho = std::min(health.minRho, rho_local);
+        health.maxU2 = std::max(health.maxU2, u2 / 1.5);
+        health.probe += rho_local + u2;
+
+        for (int k = 0; k < 9; k++) {
+            double cu = 3.0 * (ex[k] * ux_local + ey[k] * uy_local);
+            double feq = w[k] * rho_local * (1.0 + cu + 0.5 * cu * cu - u2);
+            plane(f, k)[c] += omega * (feq - plane(f, k)[c]);
+        }
+        if (strainOutput) strain[c] = strainMagnitude(fc, rho_local, ux_local, uy_local);
+    }
+
+    // |S| = sqrt(2 S:S) with S = -3 omega / (2 rho) * sum (f - feq) e e
+    // (Chapman-Enskog, BGK); the same arithmetic as the SIMD kernels
+    double strainMagnitude(const double* fc, double density, double vx, double vy) const {
+        double diagonal = fc[5] + fc[6] + fc[7] + fc[8];
+        double pxx = fc[1] + fc[3] + diagonal - density * (vx * vx + 1.0 / 3.0);
+        double pyy = fc[2] + fc[4] + diagonal - density * (vy * vy + 1.0 / 3.0);
+        double pxy = fc[5] - fc[6] + fc[7] - fc[8] - density * vx * vy;
+        double scale = (-1.5 * omega) / density;
+        double sxx = scale * pxx, syy = scale * pyy, sxy = scale * pxy;
+        return std::sqrt(2.0 * (sxx * sxx + syy * syy + 2.0 * sxy * sxy));
+    }
+
+    // Same quantity from the current populations, for when the collision
+    // pass does not store it
+    double strainFromPopulations(size_t c) const {
+        if (obstacle[c]) return 0.0;
+        double fc[9];
+        double r = 0.0, vx = 0.0, vy = 0.0;
+        for (int k = 0; k < 9; k++) {
+            fc[k] = plane(f, k)[c];
+            r += fc[k];
+            vx += ex[k] * fc[k];
+            vy += ey[k] * fc[k];
+        }
+        vx /= r;
+        vy /= r;
+        return strainMagnitude(fc, r, vx, vy);
+    }
+
+    void collideTile(int i0, int i1) {
+        for (int i = i0; i < i1; i++) columnHealth[i] = {INFINITY, 0.0, 0.0};
+        if (config.traversal == Traversal::Rows) {
+            for (int j = 0; j < height; j++)
+                for (int i = i0; i < i1; i++)
+                    if (!frozen(i)) collideCell(i, j);
+        } else {
+            for (int i = i0; i < i1; i++)
+                if (!frozen(i))
+                    for (int j = 0; j < height; j++) collideCell(i, j);
+        }
+    }
+
+    // Original streaming: copy the post-collision state, then pull from neighbours
+    void streamCellTwoPass(int i, int j) {
+        size_t c = idx(i, j);
+        for (int k = 0; k < 9; k++) {
+            plane(fTemp, k)[c] = plane(f, k)[c];
+        }
+
+        if (obstacle[c]) {
+            // Bounce-back for obstacles
+            std::swap(plane(fTemp, 1)[c], plane(fTemp, 3)[c]);
+            std::swap(plane(fTemp, 2)[c], plane(fTemp, 4)[c]);
+            std::swap(plane(fTemp, 5)[c], plane(fTemp, 7)[c]);
+            std::swap(plane(fTemp, 6)[c], plane(fTemp, 8)[c]);
+        } else {
+            // Stream from neighbors using pull scheme
+            for (int k = 0; k < 9; k++) {
+                int iprev = i - ex[k];
+                int jprev = j - ey[k];
+
+                if (iprev >= 0 && iprev < width && jprev >= 0 && jprev < height) {
+                    plane(fTemp, k)[c] = plane(f, k)[idx(iprev, jprev)];
+                }
+            }
+        }
+    }
+
+    // Same result as streamCellTwoPass with a single write per population
+    void streamCellFused(int i, int j) {
+        size_t c = idx(i, j);
+
+        if (obstacle[c]) {
+            for (int k = 0; k < 9; k++) {
+                plane(fTemp, k)[c] = plane(f, lbm_kernels::opp[k])[c];
+            }
+        } else {
+            for (int k = 0; k < 9; k++) {
+                int iprev = i - ex[k];
+                int jprev = j - ey[k];
+
+                if (iprev >= 0 && iprev < width && jprev >= 0 && jprev < height) {
+                    plane(fTemp, k)[c] = plane(f, k)[idx(iprev, jprev)];
+                } else {
+                    plane(fTemp, k)[c] = plane(f, k)[c];
+                }
+            }
+        }
+    }
+
+    void streamTileTwoPass(int i0, int i1) {
+        if (config.traversal == Traversal::Rows) {
+            for (int j = 0; j < height; j++)
+                for (int i = i0; i < i1; i++)
+                    if (!frozen(i)) streamCellTwoPass(i, j);
+        } else {
+            for (int i = i0; i < i1; i++)
+                if (!frozen(i))
+                    for (int j = 0; j < height; j++) streamCellTwoPass(i, j);
+        }
+    }
+
+    void streamTileFused(int i0, int i1) {
+        if (config.traversal == Traversal::Rows) {
+            for (int j = 0; j < height; j++)
+                for (int i = i0; i < i1; i++)
+                    if (!frozen(i)) streamCellFused(i, j);
+        } else {
+            for (int i = i0; i < i1; i++)
+                if (!frozen(i))
+                    for (int j = 0; j < height; j++) streamCellFused(i, j);
+        }
+    }
+
+    void collideTileSimd(int i0, int i1) {
+        for (int i = i0; i < i1; i++) {
+            if (frozen(i)) {
+                columnHealth[i] = {INFINITY, 0.0, 0.0};
+                continue;
+            }
+            size_t c = idx(i, 0);
+            double* cols[9];
+            for (int k = 0; k < 9; k++) cols[k] = plane(f, k) + c;
+            kernels.collide(cols, &rho[c], &ux[c], &uy[c], strainOutput ? &strain[c] : nullptr, &obstacle[c], colStride,
+                            omega, &columnHealth[i]);
+        }
+    }
+
+    void streamTileSimd(int i0, int i1) {
+        lbm_kernels::StreamFn stream = config.nonTemporal ? kernels.streamNT : kernels.stream;
+
+        for (int i = i0; i < i1; i++) {
+            if (frozen(i)) continue;
+            size_t c = idx(i, 0);
+            double* dst[9];
+            const double* src[9];
+            const double* own[9];
+            for (int k = 0; k < 9; k++) {
+                int iprev = i - ex[k];
+                dst[k] = plane(fTemp, k) + c;
+                own[k] = plane(f, k) + c;
+                // Whole column keeps its own value when the upstream column is outside
+                src[k] = iprev >= 0 && iprev < width ? plane(f, k) + idx(iprev, 0) - ey[k] : own[k];
+            }
+            stream(dst, src, own, &obstacle[c], colStride);
+        }
+
+        if (config.nonTemporal) lbm_kernels::storeFence();
+
+        // The vector loop pulled across the top/bottom edge for these
+        // populations; out-of-range sources keep the cell's own value
+        for (int i = i0; i < i1; i++) {
+            if (frozen(i)) continue;
+            size_t bottom = idx(i, 0);
+            size_t top = idx(i, height - 1);
+            if (!obstacle[bottom]) {
+                for (int k : {2, 5, 6}) plane(fTemp, k)[bottom] = plane(f, k)[bottom];
+            }
+            if (!obstacle[top]) {
+                for (int k : {4, 7, 8}) plane(fTemp, k)[top] = plane(f, k)[top];
+            }
+        }
+    }
+
+    bool columnHasObstacle(int i) const {
+        if (i < 0 || i >= width) return false;
+        for (int j = 0; j < height; j++) {
+            if (obstacle[idx(i, j)]) return true;
+        }
+        return false;
+    }
+
+    // Fixed-order reduction of one tile of columns into columnDiagnostics
+    void diagnosticsTile(int i0, int i1) {
+        for (int i = i0; i < i1; i++) {
+            Diagnostics d;
+            double maxSpeed2 = 0.0;
+            d.minDensity = INFINITY;
+            d.maxDensity = -INFINITY;
+            // Fluid-solid links only exist next to columns containing obstacle cells
+            bool nearObstacle = columnHasObstacle(i - 1) || columnHasObstacle(i) || columnHasObstacle(i + 1);
+
+            for (int j = 0; j < height; j++) {
+                size_t c = idx(i, j);
+                if (obstacle[c]) continue;
+
+                double fc[9];
+                for (int k = 0; k < 9; k++) fc[k] = plane(f, k)[c];
+
+                d.fluidCells++;
+                d.mass += fc[0] + fc[1] + fc[2] + fc[3] + fc[4] + fc[5] + fc[6] + fc[7] + fc[8];
+                d.momentumX += fc[1] - fc[3] + fc[5] - fc[6] - fc[7] + fc[8];
+                d.momentumY += fc[2] - fc[4] + fc[5] + fc[6] - fc[7] - fc[8];
+                maxSpeed2 = std::max(maxSpeed2, ux[c] * ux[c] + uy[c] * uy[c]);
+                d.minDensity = std::min(d.minDensity, rho[c]);
+                d.maxDensity = std::max(d.maxDensity, rho[c]);
+
+                if (!nearObstacle) continue;
+
+                // Momentum exchange across each fluid-solid link
+                for (int k = 1; k < 9; k++) {
+                    int in = i + ex[k];
+                    int jn = j + ey[k];
+                    if (in < 0 || in >= width || jn < 0 || jn >= height || !obstacle[idx(in, jn)]) continue;
+                    double exchanged = fc[k] + fc[lbm_kernels::opp[k]];
+                    d.forceX += ex[k] * exchanged;
+                    d.forceY += ey[k] * exchanged;
+                }
+            }
+            d.maxSpeed = std::sqrt(maxSpeed2);
+            columnDiagnostics[i] = d;
+        }
+    }
+
+    static Diagnostics combine(const Diagnostics& a, const Diagnostics& b) {
+        Diagnostics d;
+        d.mass = a.mass + b.mass;
+        d.momentumX = a.momentumX + b.momentumX;
+        d.momentumY = a.momentumY + b.momentumY;
+        d.maxSpeed = std::max(a.maxSpeed, b.maxSpeed);
+        d.minDensity = std::min(a.minDensity, b.minDensity);
+        d.maxDensity = std::max(a.maxDensity, b.maxDensity);
+        d.forceX = a.forceX + b.forceX;
+        d.forceY = a.forceY + b.forceY;
+        d.fluidCells = a.fluidCells + b.fluidCells;
+        return d;
+    }
+
+    // Pairwise tree over columns [lo, hi): the shape depends only on width
+    Diagnostics combineColumns(int lo, int hi) const {
+        if (hi - lo == 1) return columnDiagnostics[lo];
+        int mid = lo + (hi - lo) / 2;
+        return combine(combineColumns(lo, mid), combineColumns(mid, hi));
+    }
+
+    // Collect the fluid cells with a link into the obstacle (the cells the
+    // momentum exchange runs over) and order them by angle around the
+    // obstacle's centroid, starting on the upstream side and going towards +j.
+    // That is the contour order for one star-shaped body such as the built-in
+    // geometries; separate bodies get interleaved.
+    void buildSurface() {
+        if (surfaceValid) return;
+        surfaceValid = true;
+        surface.clear();
+
+        double ci = 0.0, cj = 0.0;
+        long solidCells = 0;
+        for (int i = 0; i < width; i++) {
+            for (int j = 0; j < height; j++) {
+                if (!obstacle[idx(i, j)]) continue;
+                ci += i;
+                cj += j;
+                solidCells++;
+            }
+        }
+        if (solidCells == 0) return;
+        ci /= solidCells;
+        cj /= solidCells;
+
+        std::vector<std::pair<double, double>> keys;  // (angle, distance) per cell
+        for (int i = 0; i < width; i++) {
+            if (!columnHasObstacle(i - 1) && !columnHasObstacle(i) && !columnHasObstacle(i + 1)) continue;
+            for (int j = 0; j < height; j++) {
+                if (obstacle[idx(i, j)]) continue;
+                // Weighted sum of the solid link directions points into the body
+                double gx = 0.0, gy = 0.0;
+                bool linked = false;
+                for (int k = 1; k < 9; k++) {
+                    int in = i + ex[k];
+                    int jn = j + ey[k];
+                    if (in < 0 || in >= width || jn < 0 || jn >= height || !obstacle[idx(in, jn)]) continue;
+                    gx += w[k] * ex[k];
+                    gy += w[k] * ey[k];
+                    linked = true;
+                }
+                if (!linked) continue;
+
+                double di = i - ci, dj = j - cj;
+                double norm = std::sqrt(gx * gx + gy * gy);
+                SurfacePoint p;
+                p.i = i;
+                p.j = j;
+                if (norm > 1e-12) {
+                    p.nx = -gx / norm;
+                    p.ny = -gy / norm;
+                } else {
+                    // Links cancel (a cell in a one-cell gap): fall back to the radial direction
+                    double r = std::max(std::sqrt(di * di + dj * dj), 1e-12);
+                    p.nx = di / r;
+                    p.ny = dj / r;
+                }
+                surface.push_back(p);
+                keys.push_back({M_PI - std::atan2(dj, di), di * di + dj * dj});
+            }
+        }
+
+        std::vector<size_t> order(surface.size());
+        for (size_t s = 0; s < order.size(); s++) order[s] = s;
+        std::sort(order.begin(), order.end(), [&keys](size_t a, size_t b) { return keys[a] < keys[b]; });
+
+        std::vector<SurfacePoint> sorted;
+        sorted.reserve(surface.size());
+        for (size_t s : order) sorted.push_back(surface[s]);
+        for (size_t s = 1; s < sorted.size(); s++) {
+            double di = sorted[s].i - sorted[s - 1].i;
+            double dj = sorted[s].j - sorted[s - 1].j;
+            sorted[s].arcLength = sorted[s - 1].arcLength + std::sqrt(di * di + dj * dj);
+        }
+        surface.swap(sorted);
+    }
+
+    // Cp from the cell density and wall shear from the non-equilibrium
+    // momentum flux: sigma = -(1 - omega / 2) * sum_k (f_k - feq_k) e_k e_k,
+    // taken as the tangential traction t . sigma . n with t = (ny, -nx)
+    void surfaceValues(const SurfacePoint& p, double rhoInlet, double& cp, double& cf) const {
+        size_t c = idx(p.i, p.j);
+        double fc[9];
+        for (int k = 0; k < 9; k++) fc[k] = plane(f, k)[c];
+        double r = fc[0] + fc[1] + fc[2] + fc[3] + fc[4] + fc[5] + fc[6] + fc[7] + fc[8];
+        double vx = (fc[1] - fc[3] + fc[5] - fc[6] - fc[7] + fc[8]) / r;
+        double vy = (fc[2] - fc[4] + fc[5] + fc[6] - fc[7] - fc[8]) / r;
+
+        double u2 = 1.5 * (vx * vx + vy * vy);
+        double pxx = 0.0, pyy = 0.0, pxy = 0.0;
+        for (int k = 0; k < 9; k++) {
+            double cu = 3.0 * (ex[k] * vx + ey[k] * vy);
+            double neq = fc[k] - w[k] * r * (1.0 + cu + 0.5 * cu * cu - u2);
+            pxx += neq * ex[k] * ex[k];
+            pyy += neq * ey[k] * ey[k];
+            pxy += neq * ex[k] * ey[k];
+        }
+        double scale = -(1.0 - 0.5 * omega);
+        double tx = scale * (pxx * p.nx + pxy * p.ny);
+        double ty = scale * (pxy * p.nx + pyy * p.ny);
+        double shear = tx * p.ny - ty * p.nx;
+
+        double q = 0.5 * u0 * u0;
+        cp = q > 0.0 ? (r - rhoInlet) / 3.0 / q : 0.0;
+        cf = q > 0.0 ? shear / q : 0.0;
+    }
+
+    // d/dx (di = 1) or d/dy (dj = 1) of a field at (i, j); n cells along that axis
+    double derivative(const AlignedBuffer<double>& v, int i, int j, int di, int dj, int n) const {
+        if (n < 3) return 0.0;
+        int p = di ? i : j;
+        if (p == 0) return (-3.0 * v[idx(i, j)] + 4.0 * v[idx(i + di, j + dj)] - v[idx(i + 2 * di, j + 2 * dj)]) / 2.0;
+        if (p == n - 1) {
+            return (3.0 * v[idx(i, j)] - 4.0 * v[idx(i - di, j - dj)] + v[idx(i - 2 * di, j - 2 * dj)]) / 2.0;
+        }
+        return (v[idx(i + di, j + dj)] - v[idx(i - di, j - dj)]) / 2.0;
+    }
+
+    // Mean density and x velocity of the fluid cells in the first column the
+    // collision updates; column 0 holds whatever the inlet condition imposes
+    void inletState(double& density, double& velocityX) const {
+        int i = std::min(1, width - 1);
+        double sum = 0.0, momentum = 0.0;
+        int cells = 0;
+        for (int j = 0; j < height; j++) {
+            size_t c = idx(i, j);
+            if (obstacle[c]) continue;
+            for (int k = 0; k < 9; k++) {
+                sum += plane(f, k)[c];
+                momentum += ex[k] * plane(f, k)[c];
+            }
+            cells++;
+        }
+        density = cells > 0 ? sum / cells : 1.0;
+        velocityX = cells > 0 ? momentum / sum : 0.0;
+    }
+
+    double inletDensity() const {
+        double density, velocityX;
+        inletState(density, velocityX);
+        return density;
+    }
+
+    // The surface cells and their averages belong to the old geometry
+    void invalidateSurface() {
+        surfaceValid = false;
+        surfaceAverageSteps = 0;
+        cpSum.clear();
+        cfSum.clear();
+    }
+
+    void accumulateSurface() {
+        buildSurface();
+        if (cpSum.size() != surface.size()) {
+            cpSum.assign(surface.size(), 0.0);
+            cfSum.assign(surface.size(), 0.0);
+            surfaceAverageSteps = 0;
+        }
+        double rhoInlet = inletDensity();
+        for (size_t s = 0; s < surface.size(); s++) {
+            double cp, cf;
+            surfaceValues(surface[s], rhoInlet, cp, cf);
+            cpSum[s] += cp;
+            cfSum[s] += cf;
+        }
+        surfaceAverageSteps++;
+    }
+
+    // Whether the stepping passes leave column i alone
+    bool frozen(int i) const { return skipFrozen && columnFrozen[i]; }
+
+    // Only the wind tunnel has a free stream to freeze at: a uniform
+    // equilibrium inlet, and free-slip walls, whose swaps leave a uy = 0
+    // equilibrium unchanged
+    bool activityApplies() const {
+        return boundary.flow == FlowBoundary::InletOutlet && boundary.walls == WallBoundary::FreeSlip &&
+               boundary.inlet == InletProfile::Uniform;
+    }
+
+    // Frozen columns start stepping again from the state they hold
+    void thawAll() {
+        if (frozenColumns == 0) return;
+        std::fill(columnFrozen.begin(), columnFrozen.end(), 0);
+        frozenColumns = 0;
+        skipFrozen = false;
+        activityStats.frozenBlocks = 0;
+    }
+
+    void resetActivity() {
+        thawAll();
+        activityStats = ActivityStats();
+        activityVelocity = currentVelocity;
+        steppedColumns = skippedColumns = 0;
+    }
+
+    void trackActivity() {
+        steppedColumns += width;
+        skippedColumns += frozenColumns;
+        // Inlet velocity changes (the ramp, a new setVelocity) reach every column
+        if (!activityApplies() || stepCount < rampUpSteps || currentVelocity != activityVelocity) {
+            if (frozenColumns > 0) thawAll();
+            activityVelocity = currentVelocity;
+            return;
+        }
+        if (totalSteps % activity.checkInterval == 0) updateActivity();
+    }
+
+    // Largest |f_k - feq_k| of the free stream over one tile of columns;
+    // skipped columns hold frozenEq, so theirs is the drift of the free stream
+    void activityTile(int i0, int i1) {
+        for (int i = i0; i < i1; i++) {
+            if (frozen(i)) {
+                columnDeviation[i] = frozenDrift;
+                continue;
+            }
+            if (columnHasObstacle(i)) {
+                columnDeviation[i] = INFINITY;
+                continue;
+            }
+            // Only whether it is below the threshold matters, so stop at the
+            // first population plane that is not
+            double deviation = 0.0;
+            for (int k = 0; k < 9 && deviation < activity.threshold; k++) {
+                const double* column = plane(f, k) + idx(i, 0);
+                for (int j = 0; j < height; j++) deviation = std::max(deviation, std::abs(column[j] - freeStreamEq[k]));
+            }
+            columnDeviation[i] = deviation;
+        }
+    }
+
+    void equilibriumAt(double density, double velocityX, double* feq) const {
+        double u2 = 1.5 * velocityX * velocityX;
+        for (int k = 0; k < 9; k++) {
+            double cu = 3.0 * ex[k] * velocityX;
+            feq[k] = w[k] * density * (1.0 + cu + 0.5 * cu * cu - u2);
+        }
+    }
+
+    // Both population buffers hold frozenEq, so the skipped passes would
+    // have rewritten what is there
+    void freezeColumn(int i) {
+        for (int j = 0; j < height; j++) {
+            size_t c = idx(i, j);
+            for (int k = 0; k < 9; k++) plane(f, k)[c] = plane(fTemp, k)[c] = frozenEq[k];
+            rho[c] = frozenRho;
+            ux[c] = frozenUx;
+            uy[c] = 0.0;
+            if (strainOutput) strain[c] = 0.0;
+        }
+    }
+
+    void updateActivity() {
+        double density, velocityX;
+        inletState(density, velocityX);
+        equilibriumAt(density, velocityX, freeStreamEq);
+
+        frozenDrift = 0.0;
+        for (int k = 0; k < 9; k++) frozenDrift = std::max(frozenDrift, std::abs(frozenEq[k] - freeStreamEq[k]));
+        runTiles(&LBMSolver::activityTile);
+
+        // Frozen columns follow a free stream that moved by more than half
+        // the threshold; otherwise they keep the state they were frozen at
+        bool refreeze = frozenColumns == 0 || frozenDrift > 0.5 * activity.threshold;
+        if (refreeze) {
+            std::copy(freeStreamEq, freeStreamEq + 9, frozenEq);
+            frozenRho = density;
+            frozenUx = velocityX;
+        }
+
+        int bw = activity.blockWidth;
+        int blocks = (width + bw - 1) / bw;
+        std::vector<double> blockDeviation(blocks, 0.0);
+        for (int i = 0; i < width; i++) {
+            blockDeviation[i / bw] = std::max(blockDeviation[i / bw], columnDeviation[i]);
+        }
+
+        frozenColumns = 0;
+        activityStats.blocks = blocks;
+        activityStats.frozenBlocks = 0;
+        for (int b = 0; b < blocks; b++) {
+            int i0 = b * bw, i1 = std::min(width, i0 + bw);
+            bool freeze = b > 0 && b < blocks - 1 && blockDeviation[b - 1] < activity.threshold &&
+                          blockDeviation[b] < activity.threshold && blockDeviation[b + 1] < activity.threshold;
+            bool wasFrozen = columnFrozen[i0] != 0;
+            if (!freeze) {
+                if (wasFrozen) activityStats.thawedBlocks++;
+                std::fill(columnFrozen.begin() + i0, columnFrozen.begin() + i1, 0);
+                continue;
+            }
+            if (activity.verify) {
+                activityStats.maxFrozenDeviation = std::max(activityStats.maxFrozenDeviation, blockDeviation[b]);
+            } else if (!wasFrozen || refreeze) {
+                for (int i = i0; i < i1; i++) freezeColumn(i);
+            }
+            std::fill(columnFrozen.begin() + i0, columnFrozen.begin() + i1, 1);
+            frozenColumns += i1 - i0;
+            activityStats.frozenBlocks++;
+        }
+        skipFrozen = frozenColumns > 0 && !activity.verify;
+    }
+
+    // Rotate the checkpoints and store the current state as the latest one
+    void saveCheckpoint() {
+        std::swap(latestCheckpoint, olderCheckpoint);
+        // The promoted checkpoint survived a whole interval
+        if (olderCheckpoint.steps >= 0) watchdogRetries = 0;
+
+        Checkpoint& checkpoint = latestCheckpoint;
+        size_t n = 9 * planeStride + 2 * padCells;
+        if (checkpoint.f.size() != n) {
+            checkpoint.f = AlignedBuffer<double>(n);
+            checkpoint.rho = AlignedBuffer<double>(planeStride);
+            checkpoint.ux = AlignedBuffer<double>(planeStride);
+            checkpoint.uy = AlignedBuffer<double>(planeStride);
+        }
+        std::memcpy(checkpoint.f.data(), f - padCells, n * sizeof(double));
+        std::memcpy(checkpoint.rho.data(), rho.data(), planeStride * sizeof(double));
+        std::memcpy(checkpoint.ux.data(), ux.data(), planeStride * sizeof(double));
+        std::memcpy(checkpoint.uy.data(), uy.data(), planeStride * sizeof(double));
+        checkpoint.steps = totalSteps;
+        checkpoint.stepCount = stepCount;
+        checkpoint.currentVelocity = currentVelocity;
+    }
+
+    void restoreCheckpoint(const Checkpoint& checkpoint) {
+        std::memcpy(f - padCells, checkpoint.f.data(), checkpoint.f.size() * sizeof(double));
+        std::memcpy(rho.data(), checkpoint.rho.data(), planeStride * sizeof(double));
+        std::memcpy(ux.data(), checkpoint.ux.data(), planeStride * sizeof(double));
+        std::memcpy(uy.data(), checkpoint.uy.data(), planeStride * sizeof(double));
+        totalSteps = checkpoint.steps;
+        stepCount = checkpoint.stepCount;
+        currentVelocity = checkpoint.currentVelocity;
+        thawAll();
+    }
+
+    // Scale the velocity of every fluid cell by factor, keeping density and
+    // the non-equilibrium part of the populations
+    void scaleFlow(double factor) {
+        for (int i = 0; i < width; i++) {
+            for (int j = 0; j < height; j++) {
+                size_t c = idx(i, j);
+                if (obstacle[c]) continue;
+
+                double r = 0.0, mx = 0.0, my = 0.0;
+                for (int k = 0; k < 9; k++) {
+                    double fk = plane(f, k)[c];
+                    r += fk;
+                    mx += ex[k] * fk;
+                    my += ey[k] * fk;
+                }
+                double vx = mx / r, vy = my / r;
+                double sx = vx * factor, sy = vy * factor;
+                double u2 = 1.5 * (vx * vx + vy * vy);
+                double s2 = 1.5 * (sx * sx + sy * sy);
+                for (int k = 0; k < 9; k++) {
+                    double cu = 3.0 * (ex[k] * vx + ey[k] * vy);
+                    double cs = 3.0 * (ex[k] * sx + ey[k] * sy);
+                    plane(f, k)[c] += w[k] * r * ((cs + 0.5 * cs * cs - s2) - (cu + 0.5 * cu * cu - u2));
+                }
+                ux[c] = sx;
+                uy[c] = sy;
+            }
+        }
+        currentVelocity *= factor;
+    }
+
+    void checkHealth() {
+        StepHealth h = getStepHealth();
+        const char* reason = nullptr;
+        bool machLimit = false;
+        if (!h.finite) {
+            reason = "non-finite populations";
+        } else if (h.minDensity < watchdog.minDensity) {
+            reason = "density below limit";
+        } else if (h.maxMach > watchdog.maxMach) {
+            reason = "Mach number above limit";
+            machLimit = true;
+        }
+
+        if (!reason) {
+            if (totalSteps - latestCheckpoint.steps >= watchdog.checkpointInterval) {
+                saveCheckpoint();
+            }
+            return;
+        }
+
+        WatchdogEvent e;
+        e.step = totalSteps;
+        e.reason = reason;
+        e.previousVelocity = u0;
+        e.previousViscosity = nu;
+        e.halted = latestCheckpoint.steps < 0 || watchdogRetries >= watchdog.maxRetries;
+
+        if (e.halted) {
+            halted = true;
+            e.restoredStep = totalSteps;
+        } else {
+            // Prefer the older checkpoint; the restored state becomes the latest
+            if (olderCheckpoint.steps >= 0) {
+                std::swap(latestCheckpoint, olderCheckpoint);
+                olderCheckpoint.steps = -1;
+            }
+            restoreCheckpoint(latestCheckpoint);
+            watchdogRetries++;
+            e.restoredStep = totalSteps;
+            // The Mach number is kinematic: only a lower velocity brings it down
+            if (watchdog.backoff == WatchdogBackoff::Viscosity && !machLimit) {
+                setViscosity(nu / watchdog.backoffFactor);
+            } else {
+                // Slow the developed flow too, or it diverges again regardless of the inlet
+                u0 *= watchdog.backoffFactor;
+                scaleFlow(watchdog.backoffFactor);
+            }
+        }
+        e.velocity = u0;
+        e.viscosity = nu;
+
+        // Keep the most recent events only
+        if (watchdogEvents.size() >= 64) watchdogEvents.erase(watchdogEvents.begin());
+        watchdogEvents.push_back(e);
+    }
+
+    // Wrap a row index for periodic walls; -1 if the source is outside
+    int sourceRow(int j) const {
+        if (j >= 0 && j < height) return j;
+        if (boundary.walls != WallBoundary::Periodic) return -1;
+        return j < 0 ? j + height : j - height;
+    }
+
+    // Populations entering column i (0 or width - 1) across a periodic edge,
+    // pulled from the post-collision state of the opposite column
+    void periodicColumn(int i) {
+        int source = i == 0 ? width - 1 : 0;
+        int dir = i == 0 ? 1 : -1;
+        for (int j = 0; j < height; j++) {
+            size_t c = idx(i, j);
+            if (obstacle[c]) continue;
+            for (int k = 1; k < 9; k++) {
+                if (ex[k] != dir) continue;
+                int js = sourceRow(j - ey[k]);
+                if (js >= 0) plane(f, k)[c] = plane(fTemp, k)[idx(source, js)];
+            }
+        }
+    }
+
+    // Same for row j (0 or height - 1); sources beyond the left/right edge
+    // wrap only when those edges are periodic too
+    void periodicRow(int j) {
+        int source = j == 0 ? height - 1 : 0;
+        int dir = j == 0 ? 1 : -1;
+        for (int i = 0; i < width; i++) {
+            size_t c = idx(i, j);
+            if (obstacle[c]) continue;
+            for (int k = 1; k < 9; k++) {
+                if (ey[k] != dir) continue;
+                int is = i - ex[k];
+                if (is < 0 || is >= width) {
+                    if (boundary.flow != FlowBoundary::Periodic) continue;
+                    is = is < 0 ? is + width : is - width;
+                }
+                plane(f, k)[c] = plane(fTemp, k)[idx(is, source)];
+            }
+        }
+    }
+
+    // Half-way bounce-back: a population that left the cell towards the
+    // wall returns reversed, plus the momentum of a moving wall
+    void bounceBackColumn(int i) {
+        int dir = i == 0 ? 1 : -1;
+        for (int j = 0; j < height; j++) {
+            size_t c = idx(i, j);
+            if (obstacle[c]) continue;
+            for (int k = 1; k < 9; k++) {
+                if (ex[k] == dir) plane(f, k)[c] = plane(fTemp, lbm_kernels::opp[k])[c];
+            }
+        }
+    }
+
+    void bounceBackRow(int j, double wallVelocity) {
+        int dir = j == 0 ? 1 : -1;
+        for (int i = 0; i < width; i++) {
+            size_t c = idx(i, j);
+            if (obstacle[c]) continue;
+            for (int k = 1; k < 9; k++) {
+                if (ey[k] != dir) continue;
+                plane(f, k)[c] = plane(fTemp, lbm_kernels::opp[k])[c] + 6.0 * w[k] * ex[k] * wallVelocity;
+            }
+        }
+    }
+
+    void applyBoundaryConditions() {
+        if (boundary.flow == FlowBoundary::InletOutlet) {
+            applyInletOutlet();
+        } else if (boundary.flow == FlowBoundary::Periodic) {
+            periodicColumn(0);
+            periodicColumn(width - 1);
+        } else {
+            bounceBackColumn(0);
+            bounceBackColumn(width - 1);
+        }
+
+        if (boundary.walls == WallBoundary::FreeSlip) {
+            applyFreeSlipWalls();
+        } else if (boundary.walls == WallBoundary::Periodic) {
+            periodicRow(0);
+            periodicRow(height - 1);
+        } else {
+            bounceBackRow(0, boundary.lidVelocity);
+            bounceBackRow(height - 1, 0.0);
+        }
+    }
+
+    void applyInletOutlet() {
+        // Inlet (left boundary) - constant velocity
+        bool pressureOutlet = boundary.outlet == OutletCondition::Pressure;
+        for (int j = 0; j < height; j++) {
+            double rho_in = pressureOutlet ? rho[idx(1, j)] : 1.0;
+            double ux_in = currentVelocity;
+            if (boundary.inlet == InletProfile::Parabolic) {
+                // Walls half a cell outside the first and last rows
+                double y = (j + 0.5) / height;
+                ux_in = 4.0 * currentVelocity * y * (1.0 - y);
+            }
+            double uy_in = 0.0;
+            double u2 = 1.5 * (ux_in * ux_in + uy_in * uy_in);
+
+            for (int k = 0; k < 9; k++) {
+                double cu = 3.0 * (ex[k] * ux_in + ey[k] * uy_in);
+                plane(f, k)[idx(0, j)] = w[k] * rho_in * (1.0 + cu + 0.5 * cu * cu - u2);
+            }
+        }
+
+        // Outlet (right boundary) - zero gradient
+        if (!pressureOutlet) {
+            for (int j = 0; j < height; j++) {
+                for (int k = 0; k < 9; k++) {
+                    plane(f, k)[idx(width - 1, j)] = plane(f, k)[idx(width - 2, j)];
+                }
+            }
+            return;
+        }
+
+        // Fixed-pressure outlet
+        for (int j = 0; j < height; j++) {
+            size_t c = idx(width - 2, j);
+            double ux_out = ux[c];
+            double uy_out = uy[c];
+            double u2 = 1.5 * (ux_out * ux_out + uy_out * uy_out);
+            for (int k = 0; k < 9; k++) {
+                double cu = 3.0 * (ex[k] * ux_out + ey[k] * uy_out);
+                plane(f, k)[idx(width - 1, j)] = w[k] * (1.0 + cu + 0.5 * cu * cu - u2);
+            }
+        }
+    }
+
+    void applyFreeSlipWalls() {
+        // Top and bottom walls - free-slip (specular reflection - only vertical component reflected)
+        for (int i = 0; i < width; i++) {
+            // Top wall (j=0) - bounce back only vertical components
+            size_t c = idx(i, 0);
+            std::swap(plane(f, 2)[c], plane(f, 4)[c]);  // swap 2 <-> 4 (vertical)
+            std::swap(plane(f, 5)[c], plane(f, 8)[c]);  // swap 5 <-> 8 (northeast <-> southeast)
+            std::swap(plane(f, 6)[c], plane(f, 7)[c]);  // swap 6 <-> 7 (northwest <-> southwest)
+
+            // Bottom wall (j=height-1) - bounce back only vertical components
+            c = idx(i, height - 1);
+            std::swap(plane(f, 2)[c], plane(f, 4)[c]);
+            std::swap(plane(f, 5)[c], plane(f, 8)[c]);
+            std::swap(plane(f, 6)[c], plane(f, 7)[c]);
+        }
+    }
+
+#ifdef __EMSCRIPTEN__
+    // Export data for visualization
+    val getVelocityMagnitude() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                double mag = sqrt(ux[idx(i, j)] * ux[idx(i, j)] + uy[idx(i, j)] * uy[idx(i, j)]);
+                result.call<void>("push", mag);
+            }
+        }
+        return result;
+    }
+
+    val getVorticity() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                result.call<void>("push", vorticity(i, j));
+            }
+        }
+        return result;
+    }
+
+    // Strain-rate magnitude, see strainRate()
+    val getStrainRate() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                result.call<void>("push", strainRate(i, j));
+            }
+        }
+        return result;
+    }
+
+    val getPressure() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                double p = rho[idx(i, j)] / 3.0;
+                result.call<void>("push", p);
+            }
+        }
+        return result;
+    }
+
+    val getObstacle() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                result.call<void>("push", obstacle[idx(i, j)] != 0);
+            }
+        }
+        return result;
+    }
+
+    val getUx() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                result.call<void>("push", ux[idx(i, j)]);
+            }
+        }
+        return result;
+    }
+
+    val getUy() {
+        val result = val::array();
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                result.call<void>("push", uy[idx(i, j)]);
+            }
+        }
+        return result;
+    }
+#endif
+
+    void setWatchdog(WatchdogConfig c) {
+        c.checkpointInterval = std::max(1, c.checkpointInterval);
+        c.maxRetries = std::max(0, c.maxRetries);
+        if (!(c.backoffFactor > 0.0 && c.backoffFactor < 1.0)) c.backoffFactor = 0.8;
+        watchdog = c;
+        // Start from the current state
+        halted = false;
+        watchdogRetries = 0;
+        latestCheckpoint.steps = -1;
+        olderCheckpoint.steps = -1;
+        if (watchdog.enabled) {
+            saveCheckpoint();
+        } else {
+            latestCheckpoint = Checkpoint();
+            olderCheckpoint = Checkpoint();
+        }
+    }
+
+    WatchdogConfig getWatchdog() const { return watchdog; }
+
+    // Interventions since construction, oldest first (at most 64 kept)
+    std::vector<WatchdogEvent> getWatchdogEvents() const { return watchdogEvents; }
+    int getWatchdogEventCount() const { return static_cast<int>(watchdogEvents.size()); }
+    void clearWatchdogEvents() { watchdogEvents.clear(); }
+
+    // Skip quiescent free-stream blocks (see ActivityConfig); takes effect
+    // from the current state, with nothing frozen yet
+    void setActivity(ActivityConfig c) {
+        c.threshold = std::max(0.0, c.threshold);
+        c.blockWidth = std::max(1, c.blockWidth);
+        c.checkInterval = std::max(1, std::min(c.checkInterval, c.blockWidth));
+        activity = c;
+        resetActivity();
+    }
+
+    ActivityConfig getActivity() const { return activity; }
+
+    ActivityStats getActivityStats() const {
+        ActivityStats s = activityStats;
+        s.skippedFraction = steppedColumns > 0 ? static_cast<double>(skippedColumns) / steppedColumns : 0.0;
+        return s;
+    }
+
+    bool isHalted() const { return halted; }
+
+    // Steps since reset(), rewound by rollbacks
+    int getStepCount() const { return totalSteps; }
+
+    // Density/Mach/finiteness summary of the last collision pass
+    StepHealth getStepHealth() const {
+        StepHealth h = {INFINITY, 0.0, true};
+        double maxU2 = 0.0;
+        double probe = 0.0;
+        for (const lbm_kernels::ColumnHealth& c : columnHealth) {
+            h.minDensity = std::min(h.minDensity, c.minRho);
+            maxU2 = std::max(maxU2, c.maxU2);
+            probe += c.probe;
+        }
+        h.finite = std::isfinite(probe);
+        h.maxMach = std::sqrt(3.0 * maxU2);
+        return h;
+    }
+
+    // Mass, momentum, extremes and obstacle force of the current state
+    Diagnostics computeDiagnostics() {
+        runTiles(&LBMSolver::diagnosticsTile);
+        Diagnostics d = combineColumns(0, width);
+        if (d.fluidCells == 0) d.minDensity = d.maxDensity = 0.0;
+        return d;
+    }
+
+    // Have the collision pass store the strain-rate magnitude of every fluid
+    // cell as well: local, so it needs no neighbour stencil and is as accurate
+    // next to walls as inside. The field is allocated the first time and never
+    // freed; disabling only stops the updates, leaving the last values.
+    void setStrainRateOutput(bool enabled) {
+        if (enabled && !strainOutput) {
+            // Filled from the current populations until the next step
+            if (!strain.data()) strain = AlignedBuffer<double>(planeStride);
+            for (size_t c = 0; c < planeStride; c++) strain[c] = strainFromPopulations(c);
+        }
+        strainOutput = enabled;
+    }
+    bool getStrainRateOutput() const { return strainOutput; }
+
+    // Pressure and wall shear at every fluid cell next to the obstacle,
+    // ordered along the contour; averaged = the mean over the steps since
+    // setSurfaceAveraging(true). Costs O(surface cells), not O(lattice).
+    std::vector<SurfacePoint> computeSurface(bool averaged = false) {
+        buildSurface();
+        std::vector<SurfacePoint> points = surface;
+        bool useSums = averaged && surfaceAveraging && surfaceAverageSteps > 0 && cpSum.size() == points.size();
+        double rhoInlet = useSums ? 0.0 : inletDensity();
+        for (size_t s = 0; s < points.size(); s++) {
+            if (useSums) {
+                points[s].cp = cpSum[s] / surfaceAverageSteps;
+                points[s].cf = cfSum[s] / surfaceAverageSteps;
+            } else {
+                surfaceValues(points[s], rhoInlet, points[s].cp, points[s].cf);
+            }
+        }
+        return points;
+    }
+
+    // Start (or stop) accumulating the surface average; either way the sums
+    // restart from zero
+    void setSurfaceAveraging(bool enabled) {
+        surfaceAveraging = enabled;
+        surfaceAverageSteps = 0;
+        cpSum.clear();
+        cfSum.clear();
+    }
+    bool getSurfaceAveraging() const { return surfaceAveraging; }
+    int getSurfaceAverageSteps() const { return surfaceAverageSteps; }
+
+    // Per-cell read access for the native tools
+    double distribution(int i, int j, int k) const { return f[k * planeStride + idx(i, j)]; }
+    double density(int i, int j) const { return rho[idx(i, j)]; }
+    double velocityX(int i, int j) const { return ux[idx(i, j)]; }
+    double velocityY(int i, int j) const { return uy[idx(i, j)]; }
+    // Strain-rate magnitude; from the last collision pass with
+    // setStrainRateOutput(true), else from the current populations
+    double strainRate(int i, int j) const {
+        return strainOutput ? strain[idx(i, j)] : strainFromPopulations(idx(i, j));
+    }
+    // duy/dx - dux/dy: central differences, second-order one-sided ones on
+    // the outermost rows and columns
+    double vorticity(int i, int j) const {
+        return derivative(uy, i, j, 1, 0, width) - derivative(ux, i, j, 0, 1, height);
+    }
+    bool solid(int i, int j) const { return obstacle[idx(i, j)] != 0; }
+
+    // Mark or clear a single obstacle cell; cleared again by reset(), so use
+    // setGeometry("none") first for a custom body
+    void setSolid(int i, int j, bool solid) {
+        obstacle[idx(i, j)] = solid ? 1 : 0;
+        invalidateSurface();
+        thawAll();
+    }
+
+    // Replace a fluid cell's populations by the equilibrium of (rho, ux, uy),
+    // e.g. to start from an analytic field
+    void setCellState(int i, int j, double density, double velocityX, double velocityY) {
+        size_t c = idx(i, j);
+        double u2 = 1.5 * (velocityX * velocityX + velocityY * velocityY);
+        for (int k = 0; k < 9; k++) {
+            double cu = 3.0 * (ex[k] * velocityX + ey[k] * velocityY);
+            plane(f, k)[c] = w[k] * density * (1.0 + cu + 0.5 * cu * cu - u2);
+            plane(fTemp, k)[c] = plane(f, k)[c];
+        }
+        rho[c] = density;
+        ux[c] = velocityX;
+        uy[c] = velocityY;
+        thawAll();
+    }
+
+    // Raw field storage for zero-copy views in native bindings. Column i
+    // starts at i * getColumnStride(); rows from the height up are padding.
+    // rho/ux/uy are written by the collision pass, so they describe the state
+    // before the last streaming step. The population planes (getPlaneStride()
+    // apart) swap buffers every step: fetch populationData() again after step().
+    double* densityData() { return rho.data(); }
+    double* velocityXData() { return ux.data(); }
+    double* velocityYData() { return uy.data(); }
+    double* strainRateData() { return strainOutput ? strain.data() : nullptr; }
+    uint8_t* obstacleData() { return obstacle.data(); }
+    double* populationData() { return f; }
+    size_t getColumnStride() const { return colStride; }
+    size_t getPlaneStride() const { return planeStride; }
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    void setRunning(bool r) { running = r; }
+    bool isRunning() const { return running; }
+};
@@ -0,0 +1,116 @@
+// Minimal fork-join thread pool used to split the lattice sweep across cores
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lbm-numa.h"
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::mutex runMutex;  // one job at a time when solvers share the pool
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+
+    std::function<void(int)> job;
+    int jobTasks;
+    std::vector<int> pinned;
+    unsigned generation;
+    int pending;
+    bool stopping;
+
+    int threadCount() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Static partition: participant p always gets the same contiguous block of
+    // tasks, so a given thread keeps touching the same part of the lattice
+    void runShare(int participant, int tasks, const std::function<void(int)>& body) {
+        int n = threadCount();
+        int begin = static_cast<int>(static_cast<long long>(tasks) * participant / n);
+        int end = static_cast<int>(static_cast<long long>(tasks) * (participant + 1) / n);
+        for (int t = begin; t < end; t++) body(t);
+    }
+
+    void workerLoop(int participant) {
+        unsigned seen = 0;
+        for (;;) {
+            std::function<void(int)> body;
+            int tasks;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) return;
+                seen = generation;
+                body = job;
+                tasks = jobTasks;
+            }
+
+            runShare(participant, tasks, body);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) done.notify_one();
+        }
+    }
+
+public:
+    explicit ThreadPool(int threads) : jobTasks(0), generation(0), pending(0), stopping(false) {
+        for (int p = 1; p < threads; p++) {
+            workers.emplace_back(&ThreadPool::workerLoop, this, p);
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& t : workers) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const { return threadCount(); }
+
+    // Pin participant p to cpus[p]; an empty list unpins. Participant 0 is
+    // the thread calling run(), so that thread is pinned as well.
+    void pin(const std::vector<int>& cpus) {
+        pinned = cpus;
+        run(threadCount(), [&cpus](int p) {
+            lbm_numa::pinCurrentThread(p < static_cast<int>(cpus.size()) ? cpus[p] : -1);
+        });
+    }
+
+    const std::vector<int>& pinnedCpus() const { return pinned; }
+
+    // Run body(task) for every task in [0, tasks) and wait for all of them.
+    // The calling thread takes part as participant 0. Calls from different
+    // threads (solvers sharing the pool) are serialised.
+    void run(int tasks, const std::function<void(int)>& body) {
+        if (workers.empty()) {
+            for (int t = 0; t < tasks; t++) body(t);
+            return;
+        }
+
+        std::lock_guard<std::mutex> serial(runMutex);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = body;
+            jobTasks = tasks;
+            pending = static_cast<int>(workers.size());
+            generation++;
+        }
+        wake.notify_all();
+
+        runShare(0, tasks, body);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return pending == 0; });
+        job = nullptr;
+    }
+};
@@ -0,0 +1,646 @@
+// Accuracy-versus-cost validation suite
+// Runs standard benchmark flows at several resolutions and step()
+// configurations, measures the error against analytic or published reference
+// values together with the wall time spent stepping, and reports the observed
+// order of convergence and a Richardson-extrapolated value per quantity:
+//
+//   poiseuille    channel between no-slip walls, parabolic inlet;
+//                 L2 errors of the mid-channel profile and of the strain
+//                 rate from the collision pass
+//   taylor-green  decaying periodic vortex array; L2 velocity error after
+//                 one half-life
+//   cavity        lid-driven cavity at Re = 100 against Ghia, Ghia & Shin
+//                 (1982); RMS centreline velocity error in lid speeds (no
+//                 order: the error levels off at the data's own accuracy)
+//   st-2d1        Schaefer-Turek 2D-1, steady cylinder at Re = 20; drag and
+//                 lift coefficients and front-to-back pressure difference
+//   st-2d2        Schaefer-Turek 2D-2, vortex shedding at Re = 100; maximum
+//                 drag and lift coefficients and Strouhal number
+//
+// Results go to a CSV file and an SVG plot of error against wall time, one
+// line per quantity and configuration.
+//
+// Build: ./build-native.sh
+// Usage: ./lbm-validate [--cases poiseuille,taylor-green,cavity,st-2d1,st-2d2]
+//                       [--levels N] [--simd scalar,avx2] [--threads N]
+//                       [--csv validation.csv] [--svg validation.svg]
+
+#include "lbm-solver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// One measured quantity of one case at one resolution and configuration
+struct Sample {
+    std::string caseName;
+    std::string quantity;
+    std::string variant;
+    int resolution;      // cells across the characteristic length
+    long long cells;
+    long long steps;
+    double seconds;      // wall time spent in step()
+    double value;
+    double reference;
+    double error;        // relative error against the reference
+    bool order;          // false where the reference's own accuracy bounds the error
+};
+
+struct RunStats {
+    long long steps = 0;
+    double seconds = 0.0;
+};
+
+static double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Step n times and account for the wall time
+static void advance(LBMSolver& solver, int n, RunStats& stats) {
+    double start = now();
+    for (int s = 0; s < n; s++) solver.step();
+    stats.seconds += now() - start;
+    stats.steps += n;
+}
+
+// Velocity of the current populations (the solver's ux/uy lag one step)
+static void velocityAt(const LBMSolver& solver, int i, int j, double& ux, double& uy) {
+    static const int ex[9] = {0, 1, 0, -1, 0, 1, -1, -1, 1};
+    static const int ey[9] = {0, 0, 1, 0, -1, 1, 1, -1, -1};
+    double rho = 0.0;
+    ux = uy = 0.0;
+    for (int k = 0; k < 9; k++) {
+        double fk = solver.distribution(i, j, k);
+        rho += fk;
+        ux += ex[k] * fk;
+        uy += ey[k] * fk;
+    }
+    ux /= rho;
+    uy /= rho;
+}
+
+static double relativeError(double value, double reference) {
+    return std::abs(value - reference) / std::abs(reference);
+}
+
+// Linear interpolation in a profile sorted by position
+static double interpolate(const std::vector<std::pair<double, double>>& profile, double x) {
+    for (size_t n = 1; n < profile.size(); n++) {
+        if (x <= profile[n].first) {
+            double t = (x - profile[n - 1].first) / (profile[n].first - profile[n - 1].first);
+            return profile[n - 1].second + t * (profile[n].second - profile[n - 1].second);
+        }
+    }
+    return profile.back().second;
+}
+
+struct CaseContext {
+    StepConfig config;
+    std::string variant;
+    std::vector<Sample>* samples;
+
+    void record(const std::string& caseName, const std::string& quantity, int resolution,
+                const LBMSolver& solver, const RunStats& stats, double value, double reference,
+                double error, bool order = true) const {
+        samples->push_back({caseName, quantity, variant, resolution,
+                            static_cast<long long>(solver.getWidth()) * solver.getHeight(), stats.steps,
+                            stats.seconds, value, reference, error, order});
+    }
+};
+
+// Poiseuille channel: height n, Re = umax * n / nu = 10 with tau = 0.8
+// (diffusive scaling), profile compared halfway down the channel
+static void runPoiseuille(const CaseContext& ctx, int n) {
+    const double nu = 0.1;
+    const double umax = 10.0 * nu / n;
+    LBMSolver solver(4 * n, n);
+    solver.setStepConfig(ctx.config);
+    BoundaryConfig b;
+    b.walls = WallBoundary::NoSlip;
+    b.inlet = InletProfile::Parabolic;
+    b.outlet = OutletCondition::Pressure;
+    solver.setBoundary(b);
+    solver.setViscosity(nu);
+    solver.setVelocity(umax);
+    solver.setGeometry("none");
+    solver.setStrainRateOutput(true);
+
+    int column = 2 * n;
+    std::vector<double> previous(n, 0.0);
+    RunStats stats;
+    double error = 0.0;
+    // Converged when the profile changes by less than 1e-9 umax per check
+    for (int check = 0; check < 2000; check++) {
+        advance(solver, 100, stats);
+        double change = 0.0, num = 0.0, den = 0.0;
+        for (int j = 0; j < n; j++) {
+            double ux, uy;
+            velocityAt(solver, column, j, ux, uy);
+            double y = (j + 0.5) / n;
+            double exact = 4.0 * umax * y * (1.0 - y);
+            num += (ux - exact) * (ux - exact);
+            den += exact * exact;
+            change = std::max(change, std::abs(ux - previous[j]));
+            previous[j] = ux;
+        }
+        error = std::sqrt(num / den);
+        if (stats.steps > 1000 && change < 1e-9 * umax) break;
+    }
+    ctx.record("poiseuille", "profile", n, solver, stats, error, 0.0, error);
+
+    // |du/dy| = 4 umax |1 - 2y| / n, including the cells next to the walls
+    double num = 0.0, den = 0.0;
+    for (int j = 0; j < n; j++) {
+        double y = (j + 0.5) / n;
+        double exact = 4.0 * umax * std::abs(1.0 - 2.0 * y) / n;
+        double strain = solver.strainRate(column, j);
+        num += (strain - exact) * (strain - exact);
+        den += exact * exact;
+    }
+    double strainError = std::sqrt(num / den);
+    ctx.record("poiseuille", "strain", n, solver, stats, strainError, 0.0, strainError);
+}
+
+// Taylor-Green vortices in a periodic n x n box, tau = 0.8, u0 * n = 0.64
+static void runTaylorGreen(const CaseContext& ctx, int n) {
+    const double nu = 0.1;
+    const double u0 = 0.64 / n;
+    const double k = 2.0 * M_PI / n;
+    LBMSolver solver(n, n);
+    solver.setStepConfig(ctx.config);
+    BoundaryConfig b;
+    b.flow = FlowBoundary::Periodic;
+    b.walls = WallBoundary::Periodic;
+    solver.setBoundary(b);
+    solver.setViscosity(nu);
+    solver.setGeometry("none");
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            double x = k * i, y = k * j;
+            double p = -0.25 * u0 * u0 * (std::cos(2.0 * x) + std::cos(2.0 * y));
+            solver.setCellState(i, j, 1.0 + 3.0 * p, -u0 * std::cos(x) * std::sin(y),
+                                u0 * std::sin(x) * std::cos(y));
+        }
+    }
+
+    int steps = static_cast<int>(std::lround(std::log(2.0) / (2.0 * nu * k * k)));
+    RunStats stats;
+    advance(solver, steps, stats);
+
+    double decay = std::exp(-2.0 * nu * k * k * steps);
+    double num = 0.0, den = 0.0;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            double x = k * i, y = k * j;
+            double ex = -u0 * std::cos(x) * std::sin(y) * decay;
+            double ey = u0 * std::sin(x) * std::cos(y) * decay;
+            double ux, uy;
+            velocityAt(solver, i, j, ux, uy);
+            num += (ux - ex) * (ux - ex) + (uy - ey) * (uy - ey);
+            den += ex * ex + ey * ey;
+        }
+    }
+    double error = std::sqrt(num / den);
+    ctx.record("taylor-green", "velocity", n, solver, stats, error, 0.0, error);
+}
+
+// Ghia, Ghia & Shin (1982), Re = 100: u on the vertical centreline and v on
+// the horizontal one, y and x measured from the bottom-left corner
+static const double ghiaY[] = {0.9766, 0.9688, 0.9609, 0.9531, 0.8516, 0.7344, 0.6172,
+                               0.5000, 0.4531, 0.2813, 0.1719, 0.1016, 0.0703, 0.0625, 0.0547};
+static const double ghiaU[] = {0.84123, 0.78871, 0.73722, 0.68717, 0.23151, 0.00332, -0.13641,
+                               -0.20581, -0.21090, -0.15662, -0.10150, -0.06434, -0.04775, -0.04192, -0.03717};
+static const double ghiaX[] = {0.9688, 0.9609, 0.9531, 0.9453, 0.9063, 0.8594, 0.8047,
+                               0.5000, 0.2344, 0.2266, 0.1563, 0.0938, 0.0781, 0.0703, 0.0625};
+static const double ghiaV[] = {-0.05906, -0.07391, -0.10313, -0.08864, -0.16914, -0.22445, -0.24533,
+                               0.05454, 0.17527, 0.17507, 0.16077, 0.12317, 0.10890, 0.10091, 0.09233};
+
+// Lid-driven cavity, n x n, lid speed 3.2 / n along j = 0 (the top; 0.1 at
+// 32 cells), Re = 100. Diffusive scaling as in the other cases: with a fixed
+// lid speed the O(Ma^2) compressibility error would not fall with n.
+static void runCavity(const CaseContext& ctx, int n) {
+    const double lid = 3.2 / n;
+    LBMSolver solver(n, n);
+    solver.setStepConfig(ctx.config);
+    BoundaryConfig b;
+    b.flow = FlowBoundary::NoSlip;
+    b.walls = WallBoundary::NoSlip;
+    b.lidVelocity = lid;
+    solver.setBoundary(b);
+    solver.setViscosity(lid * n / 100.0);
+    solver.setGeometry("none");
+
+    // Centreline profiles in Ghia's coordinates, walls included
+    auto profiles = [&](std::vector<std::pair<double, double>>& u, std::vector<std::pair<double, double>>& v) {
+        u = {{0.0, 0.0}};
+        v = {{0.0, 0.0}};
+        for (int m = 0; m < n; m++) {
+            double ua, ub, va, vb, unused;
+            // Vertical centreline between columns n/2 - 1 and n/2; j = n - 1 is the bottom
+            int j = n - 1 - m;
+            velocityAt(solver, (n - 1) / 2, j, ua, unused);
+            velocityAt(solver, n / 2, j, ub, unused);
+            u.push_back({(m + 0.5) / n, 0.5 * (ua + ub) / lid});
+            // Horizontal centreline; the solver's y axis points down
+            velocityAt(solver, m, (n - 1) / 2, unused, va);
+            velocityAt(solver, m, n / 2, unused, vb);
+            v.push_back({(m + 0.5) / n, -0.5 * (va + vb) / lid});
+        }
+        u.push_back({1.0, 1.0});
+        v.push_back({1.0, 0.0});
+    };
+
+    std::vector<std::pair<double, double>> u, v;
+    RunStats stats;
+    double previous = 0.0;
+    // Converged when the centre velocity changes by less than 1e-8 lid speeds
+    // per 500 steps at 32 cells; the flow evolves over n^2 / nu steps, so the
+    // tolerance shrinks and the step limit grows with n^2
+    const double scale = (32.0 / n) * (32.0 / n);
+    for (int check = 0; check < 100000 && stats.steps < static_cast<long long>(64000 / scale); check++) {
+        advance(solver, 500, stats);
+        profiles(u, v);
+        double centre = interpolate(u, 0.5);
+        if (std::abs(centre - previous) < 1e-8 * scale) break;
+        previous = centre;
+    }
+
+    // RMS rather than maximum: Ghia's v at x = 0.9453 is off its own profile
+    size_t points = sizeof(ghiaY) / sizeof(ghiaY[0]);
+    double sum = 0.0;
+    for (size_t p = 0; p < points; p++) {
+        double du = interpolate(u, ghiaY[p]) - ghiaU[p];
+        double dv = interpolate(v, ghiaX[p]) - ghiaV[p];
+        sum += du * du + dv * dv;
+    }
+    double error = std::sqrt(sum / (2 * points));
+    // From 64 cells the error sits at the scatter of Ghia's tabulated values
+    // (a 129 x 129 solution), so an order from it would mean nothing
+    ctx.record("cavity", "centreline", n, solver, stats, error, 0.0, error, false);
+}
+
+// Schaefer-Turek channel: 2.2 x 0.41 with a cylinder of diameter 0.1 centred
+// at (0.2, 0.2); d lattice cells across the cylinder, mean inflow 0.05
+struct CylinderChannel {
+    int d;
+    double mean = 0.05;
+    LBMSolver solver;
+
+    CylinderChannel(int diameter, double reynolds, const StepConfig& config)
+        : d(diameter), solver(22 * diameter, static_cast<int>(std::lround(4.1 * diameter))) {
+        solver.setStepConfig(config);
+        BoundaryConfig b;
+        b.walls = WallBoundary::NoSlip;
+        b.inlet = InletProfile::Parabolic;
+        b.outlet = OutletCondition::Pressure;
+        solver.setBoundary(b);
+        solver.setViscosity(mean * d / reynolds);
+        solver.setVelocity(1.5 * mean);
+        solver.setGeometry("none");
+
+        // Rows run top to bottom; the walls sit half a cell outside
+        double ci = 2.0 * d;
+        double cj = solver.getHeight() - 0.5 - 2.0 * d;
+        double r = 0.5 * d;
+        for (int i = 0; i < solver.getWidth(); i++) {
+            for (int j = 0; j < solver.getHeight(); j++) {
+                if ((i - ci) * (i - ci) + (j - cj) * (j - cj) < r * r) solver.setSolid(i, j, true);
+            }
+        }
+    }
+
+    // Drag and lift coefficients; lift points up, against the row index
+    void coefficients(double& cd, double& cl) {
+        Diagnostics diag = solver.computeDiagnostics();
+        double scale = 2.0 / (mean * mean * d);
+        cd = diag.forceX * scale;
+        cl = -diag.forceY * scale;
+    }
+
+    // Pressure difference between the front and back of the cylinder on the
+    // centre line, in units of mean^2, from the surface cells of the two rows
+    // either side of the centre
+    double pressureDifference() {
+        double cj = solver.getHeight() - 0.5 - 2.0 * d;
+        int j0 = static_cast<int>(std::floor(cj));
+        double t = cj - j0;
+        double front[2] = {0.0, 0.0}, back[2] = {0.0, 0.0};
+        int frontI[2] = {solver.getWidth(), solver.getWidth()}, backI[2] = {-1, -1};
+        for (const SurfacePoint& p : solver.computeSurface()) {
+            if (p.j != j0 && p.j != j0 + 1) continue;
+            int r = p.j - j0;
+            if (p.i < frontI[r]) {
+                frontI[r] = p.i;
+                front[r] = p.cp;
+            }
+            if (p.i > backI[r]) {
+                backI[r] = p.i;
+                back[r] = p.cp;
+            }
+        }
+        double q = 0.5 * solver.getVelocity() * solver.getVelocity();
+        double cpFront = (1.0 - t) * front[0] + t * front[1];
+        double cpBack = (1.0 - t) * back[0] + t * back[1];
+        return (cpFront - cpBack) * q / (mean * mean);
+    }
+};
+
+static void runSchaeferTurek1(const CaseContext& ctx, int d) {
+    const double cdRef = 5.57953523384;
+    const double clRef = 0.010618948146;
+    const double dpRef = 0.11752016697 / (0.2 * 0.2);  // published for mean inflow 0.2, density 1
+    CylinderChannel channel(d, 20.0, ctx.config);
+
+    RunStats stats;
+    double cd = 0.0, cl = 0.0, previous = 0.0;
+    int interval = 20 * d;
+    // Steady once the drag changes by less than 1e-7 per interval
+    for (int check = 0; check < 5000; check++) {
+        advance(channel.solver, interval, stats);
+        channel.coefficients(cd, cl);
+        if (stats.steps > 2000 && std::abs(cd - previous) < 1e-7 * std::abs(cd)) break;
+        previous = cd;
+    }
+    ctx.record("st-2d1", "cd", d, channel.solver, stats, cd, cdRef, relativeError(cd, cdRef));
+    ctx.record("st-2d1", "cl", d, channel.solver, stats, cl, clRef, relativeError(cl, clRef));
+    double dp = channel.pressureDifference();
+    ctx.record("st-2d1", "dp", d, channel.solver, stats, dp, dpRef, relativeError(dp, dpRef));
+}
+
+static void runSchaeferTurek2(const CaseContext& ctx, int d) {
+    // Centres of the published ranges cd_max 3.22-3.24, cl_max 0.99-1.01, St 0.295-0.305
+    const double cdRef = 3.23, clRef = 1.00, stRef = 0.300;
+    CylinderChannel channel(d, 100.0, ctx.config);
+
+    RunStats stats;
+    int convective = static_cast<int>(std::lround(d / channel.mean));  // steps per D / U
+    std::vector<double> cdHistory, clHistory;
+    std::vector<long long> crossings;  // steps of upward lift zero crossings
+    double cd = 0.0, cl = 0.0, lastCl = 0.0;
+    double cdMax = 0.0, clMax = 0.0, strouhal = 0.0;
+
+    // Periodic once three consecutive periods have the same length and
+    // amplitude; give up after 400 convective times
+    for (long long s = 0; s < 400LL * convective; s++) {
+        advance(channel.solver, 1, stats);
+        channel.coefficients(cd, cl);
+        cdHistory.push_back(cd);
+        clHistory.push_back(cl);
+        if (s > 20LL * convective && lastCl < 0.0 && cl >= 0.0) crossings.push_back(s);
+        lastCl = cl;
+        if (crossings.size() < 4) continue;
+
+        size_t c = crossings.size();
+        double periodA = static_cast<double>(crossings[c - 1] - crossings[c - 2]);
+        double periodB = static_cast<double>(crossings[c - 2] - crossings[c - 3]);
+        auto peak = [&](const std::vector<double>& h, long long from, long long to) {
+            return *std::max_element(h.begin() + from, h.begin() + to);
+        };
+        double clA = peak(clHistory, crossings[c - 2], crossings[c - 1]);
+        double clB = peak(clHistory, crossings[c - 3], crossings[c - 2]);
+        if (std::abs(periodA - periodB) <= 1.0 && std::abs(clA - clB) < 1e-3 * std::abs(clA)) {
+            cdMax = peak(cdHistory, crossings[c - 2], crossings[c - 1]);
+            clMax = clA;
+            strouhal = d / (channel.mean * periodA);
+            break;
+        }
+    }
+
+    ctx.record("st-2d2", "cd_max", d, channel.solver, stats, cdMax, cdRef, relativeError(cdMax, cdRef));
+    ctx.record("st-2d2", "cl_max", d, channel.solver, stats, clMax, clRef, relativeError(clMax, clRef));
+    ctx.record("st-2d2", "strouhal", d, channel.solver, stats, strouhal, stRef, relativeError(strouhal, stRef));
+}
+
+struct CaseDef {
+    const char* name;
+    int baseResolution;  // doubled per level
+    int defaultLevels;
+    std::function<void(const CaseContext&, int)> run;
+};
+
+static std::vector<std::string> splitList(const char* arg) {
+    std::vector<std::string> items;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static SimdLevel parseSimd(const std::string& name) {
+    for (int level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(SimdLevel::SIMD128); level++) {
+        if (name == lbm_kernels::simdLevelName(static_cast<SimdLevel>(level))) return static_cast<SimdLevel>(level);
+    }
+    return SimdLevel::Auto;
+}
+
+// Observed order between consecutive resolutions (not for errors against a
+// reference of limited accuracy) and a Richardson estimate from the three
+// finest: p = log(|q1 - q2| / |q2 - q3|) / log 2,
+// q = q3 + (q3 - q2) / (2^p - 1)
+static void printConvergence(const std::vector<Sample>& samples) {
+    printf("\n%-13s %-11s %-8s %10s %10s %12s %12s\n", "case", "quantity", "simd", "order", "rich. p",
+           "extrapolated", "extrap. err");
+    std::vector<std::string> seen;
+    for (const Sample& s : samples) {
+        std::string key = s.caseName + "/" + s.quantity + "/" + s.variant;
+        if (std::find(seen.begin(), seen.end(), key) != seen.end()) continue;
+        seen.push_back(key);
+
+        std::vector<const Sample*> series;
+        for (const Sample& t : samples) {
+            if (t.caseName == s.caseName && t.quantity == s.quantity && t.variant == s.variant) series.push_back(&t);
+        }
+        size_t m = series.size();
+        double order = NAN, richardsonP = NAN, extrapolated = NAN, extrapolatedError = NAN;
+        if (m >= 2 && s.order) {
+            order = std::log(series[m - 2]->error / series[m - 1]->error) /
+                    std::log(static_cast<double>(series[m - 1]->resolution) / series[m - 2]->resolution);
+        }
+        // Only quantities with a value to extrapolate (not error norms)
+        if (m >= 3 && series[m - 1]->reference != 0.0) {
+            double q1 = series[m - 3]->value, q2 = series[m - 2]->value, q3 = series[m - 1]->value;
+            richardsonP = std::log(std::abs(q1 - q2) / std::abs(q2 - q3)) / std::log(2.0);
+            extrapolated = q3 + (q3 - q2) / (std::pow(2.0, richardsonP) - 1.0);
+            extrapolatedError = relativeError(extrapolated, series[m - 1]->reference);
+        }
+        printf("%-13s %-11s %-8s %10.2f %10.2f %12.6g %12.3g\n", s.caseName.c_str(), s.quantity.c_str(),
+               s.variant.c_str(), order, richardsonP, extrapolated, extrapolatedError);
+    }
+}
+
+static bool writeCSV(const char* path, const std::vector<Sample>& samples) {
+    FILE* out = fopen(path, "w");
+    if (!out) return false;
+    fprintf(out, "case,quantity,simd,resolution,cells,steps,seconds,mlups,value,reference,error\n");
+    for (const Sample& s : samples) {
+        fprintf(out, "%s,%s,%s,%d,%lld,%lld,%.6f,%.3f,%.10g,%.10g,%.6g\n", s.caseName.c_str(),
+                s.quantity.c_str(), s.variant.c_str(), s.resolution, s.cells, s.steps, s.seconds,
+                s.cells * static_cast<double>(s.steps) * 1e-6 / s.seconds, s.value, s.reference, s.error);
+    }
+    fclose(out);
+    return true;
+}
+
+// Log-log plot of error against wall time, one polyline per series
+static bool writeSVG(const char* path, const std::vector<Sample>& samples) {
+    FILE* out = fopen(path, "w");
+    if (!out) return false;
+
+    const double plotW = 640, plotH = 420, left = 70, top = 20, legendW = 240;
+    double tMin = INFINITY, tMax = 0.0, eMin = INFINITY, eMax = 0.0;
+    for (const Sample& s : samples) {
+        if (!(s.seconds > 0.0) || !(s.error > 0.0) || !std::isfinite(s.error)) continue;
+        tMin = std::min(tMin, s.seconds);
+        tMax = std::max(tMax, s.seconds);
+        eMin = std::min(eMin, s.error);
+        eMax = std::max(eMax, s.error);
+    }
+    if (!(tMax > 0.0)) tMin = 1e-3, tMax = 1.0, eMin = 1e-3, eMax = 1.0;
+    double lt0 = std::floor(std::log10(tMin)), lt1 = std::ceil(std::log10(tMax));
+    double le0 = std::floor(std::log10(eMin)), le1 = std::ceil(std::log10(eMax));
+    if (lt1 <= lt0) lt1 = lt0 + 1;
+    if (le1 <= le0) le1 = le0 + 1;
+    auto px = [&](double t) { return left + (std::log10(t) - lt0) / (lt1 - lt0) * plotW; };
+    auto py = [&](double e) { return top + (le1 - std::log10(e)) / (le1 - le0) * plotH; };
+
+    fprintf(out, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%.0f\" height=\"%.0f\" "
+                 "font-family=\"sans-serif\" font-size=\"11\">\n",
+            left + plotW + legendW, top + plotH + 50);
+    fprintf(out, "<rect x=\"%.0f\" y=\"%.0f\" width=\"%.0f\" height=\"%.0f\" fill=\"none\" stroke=\"#000\"/>\n",
+            left, top, plotW, plotH);
+    for (double d = lt0; d <= lt1; d++) {
+        fprintf(out, "<line x1=\"%.1f\" y1=\"%.0f\" x2=\"%.1f\" y2=\"%.0f\" stroke=\"#ddd\"/>"
+                     "<text x=\"%.1f\" y=\"%.0f\" text-anchor=\"middle\">1e%.0f</text>\n",
+                px(std::pow(10.0, d)), top, px(std::pow(10.0, d)), top + plotH,
+                px(std::pow(10.0, d)), top + plotH + 15, d);
+    }
+    for (double d = le0; d <= le1; d++) {
+        fprintf(out, "<line x1=\"%.0f\" y1=\"%.1f\" x2=\"%.0f\" y2=\"%.1f\" stroke=\"#ddd\"/>"
+                     "<text x=\"%.0f\" y=\"%.1f\" text-anchor=\"end\">1e%.0f</text>\n",
+                left, py(std::pow(10.0, d)), left + plotW, py(std::pow(10.0, d)),
+                left - 5, py(std::pow(10.0, d)) + 4, d);
+    }
+    fprintf(out, "<text x=\"%.0f\" y=\"%.0f\" text-anchor=\"middle\">wall time in step() (s)</text>\n",
+            left + plotW / 2, top + plotH + 35);
+    fprintf(out, "<text transform=\"translate(15,%.0f) rotate(-90)\" text-anchor=\"middle\">relative error</text>\n",
+            top + plotH / 2);
+
+    static const char* const colours[] = {"#1f77b4", "#ff7f0e", "#2ca02c", "#d62728", "#9467bd",
+                                          "#8c564b", "#e377c2", "#7f7f7f", "#bcbd22", "#17becf"};
+    std::vector<std::string> seen;
+    for (const Sample& s : samples) {
+        std::string key = s.caseName + " " + s.quantity + " (" + s.variant + ")";
+        if (std::find(seen.begin(), seen.end(), key) != seen.end()) continue;
+        const char* colour = colours[seen.size() % 10];
+        double legendY = top + 10 + 16 * seen.size();
+        seen.push_back(key);
+
+        std::string points;
+        for (const Sample& t : samples) {
+            if (t.caseName != s.caseName || t.quantity != s.quantity || t.variant != s.variant) continue;
+            if (!(t.seconds > 0.0) || !(t.error > 0.0) || !std::isfinite(t.error)) continue;
+            char buf[64];
+            snprintf(buf, sizeof(buf), "%.1f,%.1f ", px(t.seconds), py(t.error));
+            points += buf;
+            fprintf(out, "<circle cx=\"%.1f\" cy=\"%.1f\" r=\"3\" fill=\"%s\"/>\n", px(t.seconds), py(t.error),
+                    colour);
+        }
+        fprintf(out, "<polyline points=\"%s\" fill=\"none\" stroke=\"%s\"/>\n", points.c_str(), colour);
+        fprintf(out, "<line x1=\"%.0f\" y1=\"%.0f\" x2=\"%.0f\" y2=\"%.0f\" stroke=\"%s\" stroke-width=\"2\"/>"
+                     "<text x=\"%.0f\" y=\"%.0f\">%s</text>\n",
+                left + plotW + 15, legendY, left + plotW + 35, legendY, colour, left + plotW + 40, legendY + 4,
+                key.c_str());
+    }
+    fprintf(out, "</svg>\n");
+    fclose(out);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<CaseDef> cases = {
+        {"poiseuille", 16, 3, runPoiseuille},
+        {"taylor-green", 16, 4, runTaylorGreen},
+        {"cavity", 32, 3, runCavity},
+        {"st-2d1", 10, 3, runSchaeferTurek1},
+        {"st-2d2", 10, 2, runSchaeferTurek2},
+    };
+    std::vector<std::string> selected;
+    for (const CaseDef& c : cases) selected.push_back(c.name);
+    int levels = 0;  // 0 = each case's default
+    int threads = 1;
+    // Scalar runs take several times longer; add them with --simd scalar,...
+    std::vector<SimdLevel> simdLevels = {LBMSolver::getBestSimdLevel()};
+    const char* csvPath = "validation.csv";
+    const char* svgPath = "validation.svg";
+
+    for (int a = 1; a < argc; a++) {
+        if (!strcmp(argv[a], "--cases") && a + 1 < argc) {
+            selected = splitList(argv[++a]);
+        } else if (!strcmp(argv[a], "--levels") && a + 1 < argc) {
+            levels = std::max(1, atoi(argv[++a]));
+        } else if (!strcmp(argv[a], "--simd") && a + 1 < argc) {
+            simdLevels.clear();
+            for (const std::string& name : splitList(argv[++a])) {
+                SimdLevel level = parseSimd(name);
+                if (level == SimdLevel::Auto || !lbm_kernels::simdSupported(level)) {
+                    fprintf(stderr, "SIMD level '%s' is not available on this CPU\n", name.c_str());
+                    return 1;
+                }
+                simdLevels.push_back(level);
+            }
+        } else if (!strcmp(argv[a], "--threads") && a + 1 < argc) {
+            threads = std::max(1, atoi(argv[++a]));
+        } else if (!strcmp(argv[a], "--csv") && a + 1 < argc) {
+            csvPath = argv[++a];
+        } else if (!strcmp(argv[a], "--svg") && a + 1 < argc) {
+            svgPath = argv[++a];
+        } else {
+            fprintf(stderr, "Usage: %s [--cases NAME,...] [--levels N] [--simd LEVEL,...] [--threads N]\n"
+                            "       [--csv FILE] [--svg FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Sample> samples;
+    printf("%-13s %-11s %-8s %6s %10s %9s %9s %14s %12s\n", "case", "quantity", "simd", "res", "cells",
+           "steps", "time (s)", "value", "error");
+    for (const CaseDef& c : cases) {
+        if (std::find(selected.begin(), selected.end(), c.name) == selected.end()) continue;
+        for (SimdLevel simd : simdLevels) {
+            CaseContext ctx;
+            ctx.config.simd = simd;
+            ctx.config.threads = threads;
+            ctx.variant = lbm_kernels::simdLevelName(simd);
+            ctx.samples = &samples;
+            int count = levels > 0 ? levels : c.defaultLevels;
+            for (int level = 0; level < count; level++) {
+                size_t first = samples.size();
+                c.run(ctx, c.baseResolution << level);
+                for (size_t n = first; n < samples.size(); n++) {
+                    const Sample& s = samples[n];
+                    printf("%-13s %-11s %-8s %6d %10lld %9lld %9.2f %14.8g %12.4g\n", s.caseName.c_str(),
+                           s.quantity.c_str(), s.variant.c_str(), s.resolution, s.cells, s.steps, s.seconds,
+                           s.value, s.error);
+                }
+                fflush(stdout);
+            }
+        }
+    }
+
+    printConvergence(samples);
+
+    if (!writeCSV(csvPath, samples)) fprintf(stderr, "Cannot write %s\n", csvPath);
+    if (!writeSVG(svgPath, samples)) fprintf(stderr, "Cannot write %s\n", svgPath);
+    printf("\nWrote %s and %s\n", csvPath, svgPath);
+    return 0;
+}
@@ -0,0 +1,563 @@
+// Differential check of every step() configuration against the original solver
+// Runs the frozen reference implementation (lbm-reference.h) and each
+// optimised configuration of LBMSolver on all built-in geometries, then
+// compares distributions and macroscopic fields with a tolerance that depends
+// on the variant's arithmetic, plus total mass and momentum. It also checks
+// that distributions and computeDiagnostics() are bit-identical for every
+// thread count and tile width, and that the out-of-core solver
+// (lbm-outofcore.h) reproduces the in-core populations bit for bit for
+// several slab widths and temporal blocking depths. The fixed-point solvers
+// (lbm-fixed.h) must give the same lattice checksum at every SIMD level and
+// thread count, and a pinned checksum on every machine. The memory planner's
+// byte counts (lbm-planner.h) must equal what each layout takes from the
+// lattice arena. Turning on the strain-rate output must not change the flow,
+// and its field must agree across SIMD levels. Activity tracking must leave
+// the flow bit-identical in verify mode, and keep it within its threshold
+// (identically for any thread count) when it skips. The stability limit must
+// not fall as the inlet velocity rises, and neither may the resolution
+// planned for a rising flow speed. Exits non-zero if any check fails, so it
+// can gate new fast paths.
+//
+// Build: ./build-native.sh
+// Usage: ./lbm-verify [--sizes 123x61,64x40] [--steps 600] [--geometry circle,square]
+//                     [--tmp DIR] [--verbose]
+
+#include "lbm-solver.h"
+#include "lbm-fixed.h"
+#include "lbm-outofcore.h"
+#include "lbm-planner.h"
+#include "lbm-reference.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Expected agreement with the reference after the run
+struct Precision {
+    const char* name;
+    double fTolerance;      // max |f - f_ref|
+    double fieldTolerance;  // max |rho - rho_ref|, |u - u_ref|
+    double totalTolerance;  // relative error of total mass and momentum
+};
+
+// Same operations in the same order: bit-identical
+static const Precision exactPrecision = {"exact", 0.0, 0.0, 0.0};
+// FMA contraction changes rounding only; allow growth over a few hundred steps
+static const Precision fmaPrecision = {"fma", 1e-10, 1e-10, 1e-12};
+
+struct Variant {
+    std::string name;
+    StepConfig config;
+    Precision precision;
+};
+
+struct Size {
+    int width;
+    int height;
+};
+
+struct Comparison {
+    double fError = 0.0;
+    double fieldError = 0.0;
+    double massError = 0.0;
+    double momentumError = 0.0;
+    bool finite = true;
+};
+
+static const char* const allGeometries[] = {"circle", "airfoil", "square", "flat_plate", "triangle"};
+
+static std::vector<std::string> splitList(const char* arg) {
+    std::vector<std::string> items;
+    std::stringstream ss(arg);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static std::vector<Size> parseSizes(const char* arg) {
+    std::vector<Size> sizes;
+    for (const std::string& s : splitList(arg)) {
+        Size size;
+        if (sscanf(s.c_str(), "%dx%d", &size.width, &size.height) == 2 && size.width > 2 && size.height > 2) {
+            sizes.push_back(size);
+        }
+    }
+    return sizes;
+}
+
+static std::string describe(const StepConfig& c) {
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s threads=%d tile=%d %s %s%s", lbm_kernels::simdLevelName(c.simd), c.threads,
+             c.tileWidth, c.kernel == KernelVariant::Fused ? "fused" : "twopass",
+             c.traversal == Traversal::Rows ? "rows" : "columns", c.nonTemporal ? " nt" : "");
+    return buf;
+}
+
+// Every scalar kernel/traversal/tiling/threading combination, and for each
+// SIMD level this CPU runs: tiling, threading and non-temporal stores
+static std::vector<Variant> buildVariants() {
+    std::vector<Variant> variants;
+    int threadCounts[] = {1, 3};
+
+    for (int kernel = 0; kernel < 2; kernel++) {
+        for (int traversal = 0; traversal < 2; traversal++) {
+            for (int threads : threadCounts) {
+                for (int tile : {0, 7}) {
+                    StepConfig c;
+                    c.simd = SimdLevel::Scalar;
+                    c.kernel = static_cast<KernelVariant>(kernel);
+                    c.traversal = static_cast<Traversal>(traversal);
+                    c.threads = threads;
+                    c.tileWidth = tile;
+                    variants.push_back({describe(c), c, exactPrecision});
+                }
+            }
+        }
+    }
+
+    for (int level = static_cast<int>(SimdLevel::SSE42); level <= static_cast<int>(SimdLevel::SIMD128); level++) {
+        SimdLevel simd = static_cast<SimdLevel>(level);
+        if (!lbm_kernels::simdSupported(simd)) continue;
+        // SSE4.2 has no FMA; the wider x86 levels are compiled with it
+        bool fma = simd == SimdLevel::AVX2 || simd == SimdLevel::AVX512;
+        for (int threads : threadCounts) {
+            for (int tile : {0, 16}) {
+                for (bool nonTemporal : {false, true}) {
+                    StepConfig c;
+                    c.simd = simd;
+                    c.threads = threads;
+                    c.tileWidth = tile;
+                    c.nonTemporal = nonTemporal;
+                    variants.push_back({describe(c), c, fma ? fmaPrecision : exactPrecision});
+                }
+            }
+        }
+    }
+    return variants;
+}
+
+static Comparison compare(const LBMReferenceSolver& ref, const LBMSolver& solver) {
+    Comparison r;
+    double refMass = 0.0, mass = 0.0;
+    double refMomentum = 0.0, momentum = 0.0;
+    static const int ex[9] = {0, 1, 0, -1, 0, 1, -1, -1, 1};
+
+    for (int i = 0; i < ref.getWidth(); i++) {
+        for (int j = 0; j < ref.getHeight(); j++) {
+            for (int k = 0; k < 9; k++) {
+                double a = ref.distribution(i, j, k);
+                double b = solver.distribution(i, j, k);
+                if (!std::isfinite(b)) r.finite = false;
+                r.fError = std::max(r.fError, std::abs(a - b));
+                refMass += a;
+                mass += b;
+                refMomentum += ex[k] * a;
+                momentum += ex[k] * b;
+            }
+            r.fieldError = std::max({r.fieldError, std::abs(ref.density(i, j) - solver.density(i, j)),
+                                     std::abs(ref.velocityX(i, j) - solver.velocityX(i, j)),
+                                     std::abs(ref.velocityY(i, j) - solver.velocityY(i, j))});
+        }
+    }
+    r.massError = std::abs(mass - refMass) / std::abs(refMass);
+    r.momentumError = std::abs(momentum - refMomentum) / std::max(std::abs(refMomentum), 1e-300);
+    // NaN never compares greater, so poison the errors explicitly
+    if (!r.finite) r.fError = r.fieldError = r.massError = r.momentumError = INFINITY;
+    return r;
+}
+
+static bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+static bool sameDiagnostics(const Diagnostics& a, const Diagnostics& b) {
+    return sameBits(a.mass, b.mass) && sameBits(a.momentumX, b.momentumX) &&
+           sameBits(a.momentumY, b.momentumY) && sameBits(a.maxSpeed, b.maxSpeed) &&
+           sameBits(a.minDensity, b.minDensity) && sameBits(a.maxDensity, b.maxDensity) &&
+           sameBits(a.forceX, b.forceX) && sameBits(a.forceY, b.forceY) && a.fluidCells == b.fluidCells;
+}
+
+static bool sameDistributions(const LBMSolver& a, const LBMSolver& b) {
+    for (int i = 0; i < a.getWidth(); i++) {
+        for (int j = 0; j < a.getHeight(); j++) {
+            for (int k = 0; k < 9; k++) {
+                if (!sameBits(a.distribution(i, j, k), b.distribution(i, j, k))) return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool sameDistributions(const LBMSolver& a, const LBMOutOfCore& b) {
+    for (int i = 0; i < a.getWidth(); i++) {
+        for (int j = 0; j < a.getHeight(); j++) {
+            for (int k = 0; k < 9; k++) {
+                if (!sameBits(a.distribution(i, j, k), b.distribution(i, j, k))) return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Lattice checksums of the fixed-point solvers for 123x61, circle, 600 steps,
+// identical on every platform
+static const uint64_t fixedBaseline16 = 0x20d41349cee3ed29ull;
+static const uint64_t fixedBaseline32 = 0xc19d1a749b051ba4ull;
+
+template <typename T>
+static uint64_t fixedChecksum(int width, int height, const std::string& geometry, int steps, SimdLevel simd,
+                              int threads) {
+    LBMFixedSolver<T> solver(width, height);
+    solver.setGeometry(geometry);
+    solver.setSimdLevel(simd);
+    solver.setThreads(threads);
+    for (int s = 0; s < steps; s++) solver.step();
+    return solver.checksum();
+}
+
+// Every SIMD level this CPU runs, single- and multi-threaded, against the
+// scalar single-threaded checksum
+template <typename T>
+static void checkFixed(const Size& size, const std::string& geometry, int steps, bool verbose, int& checks,
+                       int& failures) {
+    const int bits = 8 * sizeof(T);
+    uint64_t expected = fixedChecksum<T>(size.width, size.height, geometry, steps, SimdLevel::Scalar, 1);
+    for (int level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(SimdLevel::SIMD128); level++) {
+        SimdLevel simd = static_cast<SimdLevel>(level);
+        if (!lbm_kernels::simdSupported(simd)) continue;
+        for (int threads : {1, 3}) {
+            if (simd == SimdLevel::Scalar && threads == 1) continue;
+            uint64_t sum = fixedChecksum<T>(size.width, size.height, geometry, steps, simd, threads);
+            bool ok = sum == expected;
+            checks++;
+            if (!ok) failures++;
+            if (!ok || verbose) {
+                printf("%-4s %dx%d %-10s fixed%d %s threads=%d %016llx [exact]\n", ok ? "ok" : "FAIL",
+                       size.width, size.height, geometry.c_str(), bits, lbm_kernels::simdLevelName(simd), threads,
+                       static_cast<unsigned long long>(sum));
+            }
+        }
+    }
+}
+
+// Storing the strain rate must leave the flow bit-identical at every SIMD
+// level, and each level's field must match the scalar pass up to FMA rounding
+static void checkStrain(const Size& size, const std::string& geometry, int steps, bool verbose, int& checks,
+                        int& failures) {
+    auto run = [&](SimdLevel simd, bool strain, LBMSolver& solver) {
+        StepConfig c;
+        c.simd = simd;
+        solver.setGeometry(geometry);
+        solver.setStepConfig(c);
+        solver.setStrainRateOutput(strain);
+        for (int s = 0; s < steps; s++) solver.step();
+    };
+    LBMSolver scalar(size.width, size.height);
+    run(SimdLevel::Scalar, true, scalar);
+
+    for (int level = static_cast<int>(SimdLevel::Scalar); level <= static_cast<int>(SimdLevel::SIMD128); level++) {
+        SimdLevel simd = static_cast<SimdLevel>(level);
+        if (simd != SimdLevel::Scalar && !lbm_kernels::simdSupported(simd)) continue;
+        LBMSolver plain(size.width, size.height), solver(size.width, size.height);
+        run(simd, false, plain);
+        run(simd, true, solver);
+
+        double error = 0.0, largest = 0.0;
+        for (int i = 0; i < size.width; i++) {
+            for (int j = 0; j < size.height; j++) {
+                error = std::max(error, std::abs(solver.strainRate(i, j) - scalar.strainRate(i, j)));
+                largest = std::max(largest, scalar.strainRate(i, j));
+            }
+        }
+        bool ok = sameDistributions(plain, solver) && error <= 1e-9 * largest;
+        checks++;
+        if (!ok) failures++;
+        if (!ok || verbose) {
+            printf("%-4s %dx%d %-10s strain rate %s max %.3g, error %.3g [exact flow]\n", ok ? "ok" : "FAIL",
+                   size.width, size.height, geometry.c_str(), lbm_kernels::simdLevelName(simd), largest, error);
+        }
+    }
+}
+
+// On a channel with a long upstream section, verify mode must leave the flow
+// bit-identical, and skipping frozen blocks must stay within the threshold of
+// the full run, give the same bits for any thread count and skip something
+static void checkActivity(bool verbose, int& checks, int& failures) {
+    const int width = 320, height = 24, steps = 2000;
+    auto run = [&](SimdLevel simd, int threads, const ActivityConfig* a, LBMSolver& solver) {
+        StepConfig c;
+        c.simd = simd;
+        c.threads = threads;
+        c.tileWidth = threads > 1 ? 40 : 0;
+        solver.setStepConfig(c);
+        if (a) solver.setActivity(*a);
+        for (int s = 0; s < steps; s++) solver.step();
+    };
+    ActivityConfig a;
+    a.enabled = true;
+    a.threshold = 1e-3;
+    a.blockWidth = 8;
+    a.checkInterval = 4;
+
+    for (SimdLevel simd : {SimdLevel::Scalar, SimdLevel::Auto}) {
+        LBMSolver plain(width, height), verify(width, height), skipping(width, height), threaded(width, height);
+        run(simd, 1, nullptr, plain);
+        a.verify = true;
+        run(simd, 1, &a, verify);
+        a.verify = false;
+        run(simd, 1, &a, skipping);
+        run(simd, 3, &a, threaded);
+
+        double error = 0.0;
+        for (int i = 0; i < width; i++) {
+            for (int j = 0; j < height; j++) {
+                for (int k = 0; k < 9; k++) {
+                    error = std::max(error, std::abs(skipping.distribution(i, j, k) - plain.distribution(i, j, k)));
+                }
+            }
+        }
+        ActivityStats v = verify.getActivityStats(), s = skipping.getActivityStats();
+        struct Result {
+            const char* what;
+            bool ok;
+        };
+        for (Result r : {Result{"verify mode [exact]", sameDistributions(plain, verify) && v.skippedFraction > 0.0},
+                         Result{"skipping", error <= a.threshold && s.skippedFraction > 0.0},
+                         Result{"skipping threads=3 [exact]", sameDistributions(skipping, threaded)}}) {
+            checks++;
+            if (!r.ok) failures++;
+            if (!r.ok || verbose) {
+                printf("%-4s %dx%d circle     activity %s %s skipped %.3f, max deviation %.3g, error %.3g\n",
+                       r.ok ? "ok" : "FAIL", width, height, lbm_kernels::simdLevelName(skipping.getStepConfig().simd),
+                       r.what, s.skippedFraction, v.maxFrozenDeviation, error);
+            }
+        }
+    }
+}
+
+// The interpolated stability limit may not fall as the lattice velocity rises,
+// and a faster physical flow may not get a coarser lattice
+static void checkPlanner(bool verbose, int& checks, int& failures) {
+    double worstDrop = 0.0, previous = 0.0;
+    for (double u = 0.02; u <= 0.17 + 1e-12; u += 0.0025) {
+        double nu = lbm_planner::minStableViscosity(u);
+        worstDrop = std::max(worstDrop, previous - nu);
+        previous = nu;
+    }
+
+    int previousHeight = 0, decreases = 0, plans = 0;
+    for (double velocity = 0.01; velocity <= 10.0; velocity *= 1.05) {
+        PhysicalFlow flow;
+        flow.velocity = velocity;
+        ResolutionPlan plan = lbm_planner::planResolution(flow);
+        if (!plan.feasible) continue;
+        if (plan.height < previousHeight) decreases++;
+        previousHeight = plan.height;
+        plans++;
+    }
+
+    struct Result {
+        const char* what;
+        bool ok;
+    };
+    for (Result r : {Result{"stability limit non-decreasing in u0", worstDrop <= 0.0},
+                     Result{"planned height non-decreasing in flow speed", decreases == 0 && plans > 0}}) {
+        checks++;
+        if (!r.ok) failures++;
+        if (!r.ok || verbose) {
+            printf("%-4s planner %s (largest drop %.3g, %d of %d plans coarser)\n", r.ok ? "ok" : "FAIL", r.what,
+                   worstDrop, decreases, plans);
+        }
+    }
+}
+
+// Arena bytes held by the solver planMemory() describes in one option
+static size_t allocatedBytes(int width, int height, const MemoryOption& o) {
+    size_t before = LatticeArena::instance().stats().bytesInUse;
+    size_t after = before;
+    if (o.layout == LatticeLayout::Double) {
+        LBMSolver solver(width, height);
+        WatchdogConfig c;
+        c.enabled = o.watchdog;
+        c.checkpointInterval = 1;
+        solver.setWatchdog(c);
+        for (int s = 0; s < 3; s++) solver.step();  // both checkpoints stored
+        after = LatticeArena::instance().stats().bytesInUse;
+    } else if (o.layout == LatticeLayout::Fixed32) {
+        LBMFixedSolver32 solver(width, height);
+        after = LatticeArena::instance().stats().bytesInUse;
+    } else if (o.layout == LatticeLayout::Fixed16) {
+        LBMFixedSolver16 solver(width, height);
+        after = LatticeArena::instance().stats().bytesInUse;
+    } else {
+        LBMCompressedSolver solver(width, height, o.bits);
+        after = LatticeArena::instance().stats().bytesInUse;
+    }
+    return after - before;
+}
+
+static bool withinTolerance(const Comparison& c, const Precision& p) {
+    return c.finite && c.fError <= p.fTolerance && c.fieldError <= p.fieldTolerance &&
+           c.massError <= p.totalTolerance && c.momentumError <= p.totalTolerance;
+}
+
+int main(int argc, char** argv) {
+    std::vector<Size> sizes = parseSizes("123x61,64x40");
+    std::vector<std::string> geometries(std::begin(allGeometries), std::end(allGeometries));
+    int steps = 600;  // past the 500-step inlet ramp
+    bool verbose = false;
+    std::string tmpDir = "/tmp";  // out-of-core lattice files
+
+    for (int a = 1; a < argc; a++) {
+        if (!strcmp(argv[a], "--sizes") && a + 1 < argc) {
+            sizes = parseSizes(argv[++a]);
+        } else if (!strcmp(argv[a], "--steps") && a + 1 < argc) {
+            steps = std::max(1, atoi(argv[++a]));
+        } else if (!strcmp(argv[a], "--geometry") && a + 1 < argc) {
+            geometries = splitList(argv[++a]);
+        } else if (!strcmp(argv[a], "--tmp") && a + 1 < argc) {
+            tmpDir = argv[++a];
+        } else if (!strcmp(argv[a], "--verbose")) {
+            verbose = true;
+        } else {
+            fprintf(stderr, "Usage: %s [--sizes WxH,...] [--steps N] [--geometry NAME,...] [--tmp DIR]\n"
+                            "       [--verbose]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<Variant> variants = buildVariants();
+    printf("Verifying %zu step() configurations against the reference solver, %d steps\n",
+           variants.size(), steps);
+
+    int failures = 0;
+    int checks = 0;
+    for (const Size& size : sizes) {
+        for (const std::string& geometry : geometries) {
+            LBMReferenceSolver ref(size.width, size.height);
+            ref.setGeometry(geometry);
+            for (int s = 0; s < steps; s++) ref.step();
+
+            for (const Variant& v : variants) {
+                LBMSolver solver(size.width, size.height);
+                solver.setGeometry(geometry);
+                solver.setStepConfig(v.config);
+                for (int s = 0; s < steps; s++) solver.step();
+
+                Comparison c = compare(ref, solver);
+                bool ok = withinTolerance(c, v.precision);
+                checks++;
+                if (!ok) failures++;
+                if (!ok || verbose) {
+                    printf("%-4s %dx%d %-10s %-40s [%s] f %.3g fields %.3g mass %.3g momentum %.3g\n",
+                           ok ? "ok" : "FAIL", size.width, size.height, geometry.c_str(), v.name.c_str(),
+                           v.precision.name, c.fError, c.fieldError, c.massError, c.momentumError);
+                }
+            }
+
+            // Thread-count independence: bitwise against the single-threaded run
+            for (SimdLevel simd : {SimdLevel::Scalar, LBMSolver::getBestSimdLevel()}) {
+                StepConfig base;
+                base.simd = simd;
+                LBMSolver single(size.width, size.height);
+                single.setGeometry(geometry);
+                single.setStepConfig(base);
+                for (int s = 0; s < steps; s++) single.step();
+                Diagnostics expected = single.computeDiagnostics();
+
+                for (int threads : {2, 3, 5, 8, 4}) {
+                    StepConfig c = base;
+                    c.threads = threads;
+                    c.tileWidth = threads == 4 ? 5 : 0;
+                    LBMSolver solver(size.width, size.height);
+                    solver.setGeometry(geometry);
+                    solver.setStepConfig(c);
+                    for (int s = 0; s < steps; s++) solver.step();
+
+                    bool ok = sameDistributions(single, solver) &&
+                              sameDiagnostics(expected, solver.computeDiagnostics());
+                    checks++;
+                    if (!ok) failures++;
+                    if (!ok || verbose) {
+                        printf("%-4s %dx%d %-10s %-40s [reproducible]\n", ok ? "ok" : "FAIL", size.width,
+                               size.height, geometry.c_str(), describe(solver.getStepConfig()).c_str());
+                    }
+                }
+
+                // Out-of-core slabs and temporal blocking against the same kernels in memory;
+                // slab widths cover the merged 1-column remainder and a single slab
+                struct Blocking {
+                    int slab, temporal, threads;
+                };
+                for (Blocking b : {Blocking{5, 3, 1}, Blocking{16, 1, 1}, Blocking{7, 8, 3}, Blocking{1000, 4, 1}}) {
+                    OutOfCoreConfig oc;
+                    oc.slabWidth = b.slab;
+                    oc.temporalSteps = b.temporal;
+                    oc.threads = b.threads;
+                    oc.simd = simd;
+                    LBMOutOfCore ooc(size.width, size.height, tmpDir, oc);
+                    ooc.setGeometry(geometry);
+                    ooc.step(steps);
+
+                    bool ok = sameDistributions(single, ooc);
+                    checks++;
+                    if (!ok) failures++;
+                    if (!ok || verbose) {
+                        printf("%-4s %dx%d %-10s out-of-core %s slab=%d temporal=%d threads=%d [exact]\n",
+                               ok ? "ok" : "FAIL", size.width, size.height, geometry.c_str(),
+                               lbm_kernels::simdLevelName(ooc.getConfig().simd), ooc.getConfig().slabWidth,
+                               b.temporal, b.threads);
+                    }
+                }
+            }
+
+            checkFixed<int16_t>(size, geometry, steps, verbose, checks, failures);
+            checkFixed<int32_t>(size, geometry, steps, verbose, checks, failures);
+            checkStrain(size, geometry, steps, verbose, checks, failures);
+        }
+
+        // Planned against allocated memory, per layout
+        MemoryRequest request;
+        request.width = size.width;
+        request.height = size.height;
+        for (const MemoryOption& o : lbm_planner::planMemory(request).options) {
+            size_t bytes = allocatedBytes(size.width, size.height, o);
+            bool ok = static_cast<double>(bytes) == o.bytes;
+            checks++;
+            if (!ok) failures++;
+            if (!ok || verbose) {
+                printf("%-4s %dx%d memory layout=%d bits=%d watchdog=%d planned %.0f allocated %zu\n",
+                       ok ? "ok" : "FAIL", size.width, size.height, static_cast<int>(o.layout), o.bits,
+                       o.watchdog ? 1 : 0, o.bytes, bytes);
+            }
+        }
+    }
+
+    checkActivity(verbose, checks, failures);
+    checkPlanner(verbose, checks, failures);
+
+    // Cross-machine baseline
+    struct Baseline {
+        int bits;
+        uint64_t expected, sum;
+    };
+    for (Baseline b : {Baseline{16, fixedBaseline16, fixedChecksum<int16_t>(123, 61, "circle", 600, SimdLevel::Auto, 1)},
+                       Baseline{32, fixedBaseline32, fixedChecksum<int32_t>(123, 61, "circle", 600, SimdLevel::Auto, 1)}}) {
+        bool ok = b.sum == b.expected;
+        checks++;
+        if (!ok) failures++;
+        if (!ok || verbose) {
+            printf("%-4s 123x61 circle     fixed%d baseline %016llx (expected %016llx)\n", ok ? "ok" : "FAIL", b.bits,
+                   static_cast<unsigned long long>(b.sum), static_cast<unsigned long long>(b.expected));
+        }
+    }
+
+    printf("%d of %d checks passed\n", checks - failures, checks);
+    return failures == 0 ? 0 : 1;
+}
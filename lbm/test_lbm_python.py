@@ -0,0 +1,80 @@
+# Smoke test for the Python bindings (lbm-python.cpp)
+# Builds the module with build-python.sh and checks the NumPy views and the
+# calls that keep the solver's caches consistent. Skipped when pybind11 or
+# NumPy is not installed.
+#
+# Usage: python3 -m pytest test_lbm_python.py
+
+import importlib
+import os
+import subprocess
+import sys
+
+import pytest
+
+np = pytest.importorskip('numpy')
+pytest.importorskip('pybind11')
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+
+
+@pytest.fixture(scope='module')
+def lbm():
+    build = subprocess.run(['bash', 'build-python.sh'], cwd=HERE, capture_output=True, text=True,
+                           env=dict(os.environ, PYTHON=sys.executable))
+    assert build.returncode == 0, build.stdout + build.stderr
+    sys.path.insert(0, HERE)
+    try:
+        yield importlib.import_module('lbm')
+    finally:
+        sys.path.remove(HERE)
+
+
+def test_views_follow_the_solver(lbm):
+    s = lbm.LBMSolver(64, 32)
+    s.step_n(50)
+    assert s.rho.shape == (32, 64)
+    assert np.isfinite(s.ux).all()
+    assert s.populations().shape == (9, 32, 64)
+
+
+def test_obstacle_view_is_read_only(lbm):
+    s = lbm.LBMSolver(64, 32)
+    with pytest.raises(ValueError):
+        s.obstacle[10, 10] = 1
+
+
+def test_set_solid_updates_the_mask(lbm):
+    s = lbm.LBMSolver(64, 32)
+    mask = s.obstacle.copy()
+    mask[12:20, 40:44] = 1
+    s.set_solid(mask)
+    assert (s.obstacle == mask).all()
+    s.step_n(10)
+    assert np.isfinite(s.rho).all()
+    with pytest.raises(ValueError):
+        s.set_solid(mask[:, :10])
+
+
+def test_cell_setters_check_indices(lbm):
+    s = lbm.LBMSolver(64, 32)
+    for i, j in ((-1, 10), (10, 10**6), (64, 0), (0, 32)):
+        with pytest.raises(IndexError):
+            s.setSolid(i, j, True)
+        with pytest.raises(IndexError):
+            s.setCellState(i, j, 1.0, 0.0, 0.0)
+    s.setSolid(63, 31, True)
+    s.setCellState(0, 0, 1.0, 0.05, 0.0)
+    assert s.obstacle[31, 63] == 1
+
+
+def test_strain_rate_view_outlives_disabling(lbm):
+    s = lbm.LBMSolver(64, 32)
+    s.setStrainRateOutput(True)
+    s.step_n(20)
+    view = s.strain_rate
+    before = view.copy()
+    s.setStrainRateOutput(False)
+    assert s.strain_rate is None
+    s.step_n(20)
+    assert (view == before).all()
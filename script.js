@@ -244,15 +244,48 @@ async function initLBM() {
   const width = 700;  // LBM lattice resolution (balanced Re & performance)
   const height = 350;
 
+  // A native lbm-server can step the lattice instead and stream frames
+  // (open the page with ?lbm-server=ws://localhost:8765)
+  const serverUrl = new URLSearchParams(window.location.search).get('lbm-server');
+  if (serverUrl && typeof LBMRemoteSolver !== 'undefined' && LBMRemoteSolver.isSupported()) {
+    console.log('Using LBM server at ' + serverUrl);
+    lbmSolver = new LBMRemoteSolver(canvas, serverUrl);
+    try {
+      await lbmSolver.initPromise;
+    } catch (e) {
+      console.warn('LBM server unavailable, solving in the browser', e);
+      lbmSolver = null;
+    }
+  }
+
   // Try to use WASM version if available, otherwise fall back to JavaScript
-  const useWASM = typeof LBMSolverWASM !== 'undefined';
+  const useWASM = !lbmSolver && typeof LBMSolverWASM !== 'undefined' && LBMSolverWASM.isSupported();
 
   if (useWASM) {
     console.log('Using WebAssembly LBM solver');
-    lbmSolver = new LBMSolverWASM(canvas, width, height);
-    // Wait for WASM to initialize
-    await lbmSolver.initPromise;
-  } else {
+    // ?lbm-compressed=16 keeps the lattice block-compressed (bits per value)
+    // ?lbm-fixed=16 (or 32) steps a bit-reproducible fixed-point lattice
+    const params = new URLSearchParams(window.location.search);
+    const compressedRate = parseInt(params.get('lbm-compressed'), 10) || 0;
+    const fixedPoint = parseInt(params.get('lbm-fixed'), 10) || 0;
+    lbmSolver = new LBMSolverWASM(canvas, width, height, { compressedRate, fixedPoint });
+    try {
+      // Wait for WASM to initialize
+      await lbmSolver.initPromise;
+      // ?lbm-record logs the session; lbmSolver.saveRecording() in the
+      // console downloads it for lbm-replay-node.js
+      if (params.has('lbm-record')) {
+        await lbmSolver.startRecording();
+        window.lbmSolver = lbmSolver;
+        console.log('Recording LBM session; call lbmSolver.saveRecording() to download it');
+      }
+    } catch (e) {
+      console.warn('WebAssembly solver failed to load, using JavaScript', e);
+      lbmSolver = null;
+    }
+  }
+
+  if (!lbmSolver) {
     console.log('Using JavaScript LBM solver');
     lbmSolver = new LBMSolver(canvas, width, height);
   }
@@ -314,7 +347,10 @@ async function initLBM() {
 
       // Update performance display every 0.5 seconds
       if (now - lastPerfUpdate > 500) {
-        const timestepsPerSec = (timestepCount / (now - lastPerfUpdate)) * 1000;
+        // The server reports its own rate; step() does nothing locally
+        const timestepsPerSec = lbmSolver.stepsPerSecond !== undefined
+          ? lbmSolver.stepsPerSecond
+          : (timestepCount / (now - lastPerfUpdate)) * 1000;
         timestepsPerSecDisplay.textContent = Math.round(timestepsPerSec);
         timestepCount = 0;
         lastPerfUpdate = now;
@@ -400,6 +436,15 @@ async function initLBM() {
     updatePhysicalValues();
   });
 
+  // Show the values the WASM solver's watchdog backed off to
+  lbmSolver.onWatchdog = (event) => {
+    velocitySlider.value = event.velocity;
+    velValue.textContent = event.velocity.toFixed(2);
+    viscositySlider.value = event.viscosity;
+    viscValue.textContent = event.viscosity.toFixed(3);
+    updatePhysicalValues();
+  };
+
   // Visualization mode
   visualSelect.addEventListener('change', (e) => {
     lbmSolver.setVisualization(e.target.value);